@@ -20,6 +20,7 @@ void ExtenderProtocol::ProcessExtenderMessage(net::MessageContext& context, net:
 	case net::MessageWrapper::kC2SExtenderHello:
 	{
 		auto const& hello = msg.c2s_extender_hello();
+		ResetUserVarKeys(context.UserID.GetPeerId());
 		gExtender->GetClient().GetNetworkManager().OnExtenderHello(hello);
 		break;
 	}
@@ -46,6 +47,18 @@ void ExtenderProtocol::ProcessExtenderMessage(net::MessageContext& context, net:
 		break;
 	}
 
+	case net::MessageWrapper::kS2CSyncStats:
+	{
+		stats::StatSyncQueue::Apply(msg.s2c_sync_stats());
+		break;
+	}
+
+	case net::MessageWrapper::kS2CUserVarSnapshot:
+	{
+		SyncUserVarSnapshot(msg.s2c_user_var_snapshot());
+		break;
+	}
+
 	case net::MessageWrapper::kS2CKick:
 	{
 		gExtender->GetLibraryManager().ShowStartupError(msg.s2c_kick().message().c_str(), true);
@@ -54,7 +67,7 @@ void ExtenderProtocol::ProcessExtenderMessage(net::MessageContext& context, net:
 
 	case net::MessageWrapper::kUserVars:
 	{
-		SyncUserVars(msg.user_vars());
+		SyncUserVars(context.UserID.GetPeerId(), msg.user_vars());
 		break;
 	}
 
@@ -66,6 +79,7 @@ void ExtenderProtocol::ProcessExtenderMessage(net::MessageContext& context, net:
 void NetworkManager::Reset()
 {
 	extenderSupport_ = false;
+	hostVersion_ = 0;
 }
 
 bool NetworkManager::CanSendExtenderMessages() const
@@ -118,6 +132,8 @@ void NetworkManager::OnExtenderHello(net::MsgC2SExtenderHello const& hello)
 {
 	DEBUG("Got extender support notification from host (version %d)", hello.version());
 	AllowExtenderMessages();
+	hostVersion_ = hello.version();
+	connectionGeneration_++;
 
 	auto helloMsg = GetFreeMessage();
 	if (helloMsg != nullptr) {
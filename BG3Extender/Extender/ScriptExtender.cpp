@@ -6,6 +6,7 @@
 #include <iomanip>
 
 #include <Extender/Shared/StatLoadOrderHelper.inl>
+#include <Extender/Shared/StatSync.inl>
 #include <Extender/Shared/UserVariables.inl>
 #include <Extender/Shared/VirtualTextures.inl>
 
@@ -207,6 +208,7 @@ void ScriptExtender::OnStatsLoad(stats::RPGStats::LoadProc* wrapped, stats::RPGS
 	}
 
 	statLoadOrderHelper_.OnLoadStarted();
+	stats::RPGStats::sLookupIndexes.Clear();
 	client_.LoadExtensionState(ExtensionStateContext::Load);
 	virtualTextures_.Load();
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Extender/Shared/ExtensionState.h>
+#include <Extender/Shared/StatSync.h>
 #include <Lua/Server/LuaBindingServer.h>
 
 namespace Json { class Value; }
@@ -40,6 +41,11 @@ namespace bg3se::esv
 		void UnmarkPersistentStat(FixedString const& statId);
 		void MarkDynamicStat(FixedString const& statId);
 
+		inline stats::StatSyncQueue& GetStatSyncQueue()
+		{
+			return statSyncQueue_;
+		}
+
 		std::optional<STDString> GetModPersistentVars(FixedString const& mod);
 		void RestoreModPersistentVars(FixedString const& mod, STDString const& vars);
 		std::unordered_set<FixedString> GetPersistentVarMods();
@@ -57,6 +63,7 @@ namespace bg3se::esv
 		std::unordered_set<FixedString> dynamicStats_;
 		std::unordered_set<FixedString> persistentStats_;
 		std::unordered_map<FixedString, STDString> cachedPersistentVars_;
+		stats::StatSyncQueue statSyncQueue_;
 		uint32_t nextGenerationId_{ 1 };
 
 		void DoLuaReset() override;
@@ -184,6 +184,7 @@ void ScriptExtender::OnUpdate(void* self, GameTime* time)
 	RunPendingTasks();
 	if (extensionState_) {
 		extensionState_->OnUpdate(*time);
+		extensionState_->GetStatSyncQueue().Flush();
 		if (gExtender->GetLuaDebugger()) {
 			gExtender->GetLuaDebugger()->ServerTick();
 		}
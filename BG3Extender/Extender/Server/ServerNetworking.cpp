@@ -31,13 +31,14 @@ void ExtenderProtocol::ProcessExtenderMessage(net::MessageContext& context, net:
 	{
 		auto const& hello = msg.c2s_extender_hello();
 		DEBUG("Got extender support notification from user %d (version %d)", context.UserID.Id, hello.version());
+		ResetUserVarKeys(context.UserID.GetPeerId());
 		gExtender->GetServer().GetNetworkManager().AllowExtenderMessages(context.UserID.GetPeerId(), hello.version());
 		break;
 	}
 
 	case net::MessageWrapper::kUserVars:
 	{
-		SyncUserVars(msg.user_vars());
+		SyncUserVars(context.UserID.GetPeerId(), msg.user_vars());
 		break;
 	}
 
@@ -69,6 +70,23 @@ std::optional<uint32_t> NetworkManager::GetPeerVersion(PeerId peerId) const
 void NetworkManager::AllowExtenderMessages(PeerId peerId, uint32_t version)
 {
 	peerVersions_.insert_or_assign(peerId, version);
+	connectionGeneration_++;
+}
+
+std::optional<uint32_t> NetworkManager::GetMinConnectedPeerVersion() const
+{
+	auto server = GetServer();
+	if (server == nullptr) return {};
+
+	std::optional<uint32_t> minVersion;
+	for (auto peerId : server->ConnectedPeerIds) {
+		auto version = GetPeerVersion(peerId);
+		if (version && (!minVersion || *version < *minVersion)) {
+			minVersion = *version;
+		}
+	}
+
+	return minVersion;
 }
 
 
@@ -168,17 +186,20 @@ void NetworkManager::Broadcast(net::ExtenderMessage * msg, UserId excludeUserId,
 	server->SendMessageMultiPeerMoveIds(peerIds, msg, (TPeerId)excludeUserId.GetPeerId());
 }
 
-void NetworkManager::BroadcastToConnectedPeers(net::ExtenderMessage* msg, UserId excludeUserId, bool excludeLocalPeer)
+void NetworkManager::BroadcastToConnectedPeers(net::ExtenderMessage* msg, UserId excludeUserId, bool excludeLocalPeer, uint32_t minVersion)
 {
 	auto server = GetServer();
 	if (server == nullptr) return;
 
 	Array<PeerId> peerIds;
 	for (auto peerId : server->ConnectedPeerIds) {
-		if (CanSendExtenderMessages(peerId)) {
+		auto version = GetPeerVersion(peerId);
+		if (version && *version >= minVersion) {
 			if (peerId != TPeerId(1) || !excludeLocalPeer) {
 				peerIds.push_back(peerId);
 			}
+		} else if (version) {
+			WARN("Not sending extender message to peer %d as it uses protocol version %d (need %d)", peerId, *version, minVersion);
 		} else {
 			WARN("Not sending extender message to peer %d as it does not understand extender protocol!", peerId);
 		}
@@ -23,6 +23,14 @@ public:
 	bool CanSendExtenderMessages(PeerId peerId) const;
 	std::optional<uint32_t> GetPeerVersion(PeerId peerId) const;
 	void AllowExtenderMessages(PeerId peerId, uint32_t version);
+	// Lowest protocol version of the connected peers that support extender messages
+	std::optional<uint32_t> GetMinConnectedPeerVersion() const;
+
+	// Incremented each time a peer acknowledges extender support
+	inline uint32_t GetConnectionGeneration() const
+	{
+		return connectionGeneration_;
+	}
 	void OnClientConnectMessage(net::MessageContext* context, net::ClientConnectMessage* msg);
 
 	void ExtendNetworking();
@@ -33,12 +41,15 @@ public:
 
 	void Send(net::ExtenderMessage * msg, UserId userId);
 	void Broadcast(net::ExtenderMessage * msg, UserId excludeUserId, bool excludeLocalPeer = false);
-	void BroadcastToConnectedPeers(net::ExtenderMessage* msg, UserId excludeUserId, bool excludeLocalPeer = false);
+	// Peers with a protocol version lower than minVersion are skipped
+	void BroadcastToConnectedPeers(net::ExtenderMessage* msg, UserId excludeUserId, bool excludeLocalPeer = false,
+		uint32_t minVersion = net::ExtenderMessage::VerInitial);
 
 private:
 	ExtenderProtocol * protocol_{ nullptr };
 	// List of clients that support the extender protocol
 	std::unordered_map<PeerId, uint32_t> peerVersions_;
+	uint32_t connectionGeneration_{ 0 };
 };
 
 END_NS()
\ No newline at end of file
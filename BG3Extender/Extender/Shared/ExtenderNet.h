@@ -12,8 +12,14 @@ public:
 	static constexpr uint32_t MaxPayloadLength = 0xfffff;
 
 	static constexpr uint32_t VerInitial = 1;
+	// Added batched stats sync (MsgS2CSyncStats)
+	static constexpr uint32_t VerBatchedStatSync = 2;
+	// Added interned user variable keys (UserVar.key_id, MsgUserVars.keys)
+	static constexpr uint32_t VerInternedUserVarKeys = 3;
+	// Added user variable snapshots (MsgS2CUserVarSnapshot)
+	static constexpr uint32_t VerUserVarSnapshot = 4;
 	// Version of protocol, increment each time the protobuf changes
-	static constexpr uint32_t ProtoVersion = VerInitial;
+	static constexpr uint32_t ProtoVersion = VerUserVarSnapshot;
 
 	ExtenderMessage();
 	~ExtenderMessage() override;
@@ -59,10 +65,27 @@ public:
 	void OnRemovedFromHost() override;
 	void Reset() override;
 
-	void SyncUserVars(MsgUserVars const& msg);
+	void SyncUserVars(PeerId peerId, MsgUserVars const& msg);
+	// Discards user variable keys interned by the peer
+	void ResetUserVarKeys(PeerId peerId);
+	void SyncUserVarSnapshot(MsgS2CUserVarSnapshot const& msg);
 
 protected:
 	virtual void ProcessExtenderMessage(net::MessageContext& context, MessageWrapper & msg) = 0;
+
+private:
+	// User variable keys interned by each peer, indexed by key id; separate for each UserVarType
+	std::unordered_map<PeerId, Vector<FixedString>> userVarKeys_[2];
+
+	struct UserVarSnapshotBuffer
+	{
+		uint32_t SnapshotId{ 0 };
+		uint32_t TotalSize{ 0 };
+		Vector<uint8_t> Data;
+	};
+
+	// Partially received user variable snapshots; separate for each UserVarType
+	UserVarSnapshotBuffer userVarSnapshots_[2];
 };
 
 END_NS()
@@ -7,9 +7,61 @@
 
 BEGIN_SE()
 
+// Stores module hashes between launches.
+// Entries are keyed by module UUID and are only reused if the size and modification time of
+// the module pak are unchanged, and a sample of the file contents still matches.
+// Loose (unpackaged) mods consist of many files that can change independently, so they're never cached.
+class PersistentModuleHashCache
+{
+public:
+	struct SourceFileInfo
+	{
+		STDWString Path;
+		uint64_t Size{ 0 };
+		uint64_t ModifiedTime{ 0 };
+		uint64_t ContentDigest{ 0 };
+	};
+
+	struct Entry
+	{
+		STDString Path;
+		uint64_t Size{ 0 };
+		uint64_t ModifiedTime{ 0 };
+		uint64_t ContentDigest{ 0 };
+		STDString Hash;
+	};
+
+	void Load();
+	void Save();
+
+	std::optional<STDString> Find(Module const& mod);
+	std::optional<STDString> Find(Module const& mod, std::optional<SourceFileInfo> const& source);
+	void Update(Module const& mod);
+	void Update(Module const& mod, std::optional<SourceFileInfo> const& source);
+
+	// The game doesn't expose the pak file a module was loaded from; packaged mods are assumed to be
+	// at /Mods/<Directory>.pak, and modules that aren't there aren't cached or prefetched.
+	static std::optional<STDWString> GetSourcePath(Module const& mod);
+	// Reads the metadata and content digest of a module file.
+	// Doesn't touch the cache or game state, so it can be called from worker threads.
+	static std::optional<SourceFileInfo> ReadSourceFile(STDWString const& path);
+	// Reads the whole file, so the subsequent hash pass is served from the OS file cache
+	static void PrefetchFile(STDWString const& path);
+
+private:
+	std::unordered_map<FixedString, Entry> entries_;
+	bool loaded_{ false };
+	bool dirty_{ false };
+
+	static std::optional<uint64_t> GetContentDigest(STDWString const& path, uint64_t size);
+};
+
 class ModuleHasher
 {
 public:
+	// Maximum number of threads used for hashing dependencies of a module
+	static constexpr unsigned MaxHashWorkers = 8;
+
 	void PostStartup();
 	void ClearCaches();
 
@@ -19,13 +71,22 @@ public:
 	}
 
 private:
-	std::vector<Module*> hashStack_;
 	std::unordered_map<FixedString, STDString> hashCache_;
+	PersistentModuleHashCache persistentCache_;
+	// Protects the hash caches; held only briefly, workers take it too
 	std::recursive_mutex mutex_;
+	// Serializes calls to the game hash function for the whole top-level hash call, including nested calls
+	std::recursive_mutex hashMutex_;
 	static __declspec(thread) unsigned hashDepth_;
+	// Modules being hashed; only accessed with hashMutex_ held
+	std::vector<Module*> hashStack_;
 
 	bool FetchHashFromCache(Module& mod);
+	void ApplyHash(Module& mod, STDString const& hash);
+	void AddHashToCache(Module const& mod, std::optional<PersistentModuleHashCache::SourceFileInfo> const& source = {});
 	void UpdateDependencyHashes(Module& mod);
+	// Reads dependency files on worker threads, then hashes cache misses; must be called with hashMutex_ held
+	void PrefetchDependencyHashes(Module::HashProc* next, Module& mod);
 	bool OnModuleHash(Module::HashProc* next, Module* self);
 };
 
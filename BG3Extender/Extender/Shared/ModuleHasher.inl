@@ -1,9 +1,219 @@
 #include <Extender/Shared/ModuleHasher.h>
+#include <Extender/Shared/ScriptHelpers.h>
+#include "json/json.h"
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <unordered_set>
 
 BEGIN_SE()
 
 __declspec(thread) unsigned ModuleHasher::hashDepth_{ 0 };
 
+static constexpr char const* ModuleHashCacheFile = "ModuleHashCache.json";
+// Number of bytes read from the start and end of module files when checking whether
+// the contents of a file were replaced without changing its size and modification time
+static constexpr uint64_t ModuleHashSampleSize = 0x10000;
+
+void PersistentModuleHashCache::Load()
+{
+	loaded_ = true;
+	entries_.clear();
+
+	auto contents = script::LoadExternalFile(ModuleHashCacheFile, PathRootType::UserProfile);
+	if (!contents) {
+		return;
+	}
+
+	Json::CharReaderBuilder factory;
+	auto jsonReader = std::unique_ptr<Json::CharReader>(factory.newCharReader());
+
+	Json::Value root;
+	std::string errs;
+	if (!jsonReader->parse(contents->c_str(), contents->c_str() + contents->size(), &root, &errs)) {
+		WARN("Unable to parse module hash cache: %s", errs.c_str());
+		return;
+	}
+
+	auto modules = root["Modules"];
+	if (!modules.isObject()) {
+		return;
+	}
+
+	for (auto it = modules.begin(); it != modules.end(); ++it) {
+		auto const& mod = *it;
+		if (!mod.isObject() || !mod["Path"].isString() || !mod["Hash"].isString()) {
+			continue;
+		}
+
+		Entry entry;
+		entry.Path = mod["Path"].asString().c_str();
+		entry.Size = mod["Size"].asUInt64();
+		entry.ModifiedTime = mod["ModifiedTime"].asUInt64();
+		entry.ContentDigest = mod["ContentDigest"].asUInt64();
+		entry.Hash = mod["Hash"].asString().c_str();
+		entries_.insert(std::make_pair(FixedString(it.name()), entry));
+	}
+}
+
+void PersistentModuleHashCache::Save()
+{
+	if (!dirty_) {
+		return;
+	}
+
+	Json::Value modules(Json::objectValue);
+	for (auto const& it : entries_) {
+		Json::Value mod(Json::objectValue);
+		mod["Path"] = it.second.Path.c_str();
+		mod["Size"] = Json::UInt64(it.second.Size);
+		mod["ModifiedTime"] = Json::UInt64(it.second.ModifiedTime);
+		mod["ContentDigest"] = Json::UInt64(it.second.ContentDigest);
+		mod["Hash"] = it.second.Hash.c_str();
+		modules[it.first.GetString()] = mod;
+	}
+
+	Json::Value root(Json::objectValue);
+	root["Modules"] = modules;
+
+	Json::StreamWriterBuilder builder;
+	builder["indentation"] = "";
+	auto json = Json::writeString(builder, root);
+	if (script::SaveExternalFile(ModuleHashCacheFile, PathRootType::UserProfile, json)) {
+		dirty_ = false;
+	}
+}
+
+std::optional<STDWString> PersistentModuleHashCache::GetSourcePath(Module const& mod)
+{
+	if (mod.Info.Directory.empty()) {
+		return {};
+	}
+
+	// Packaged mods are expected to be named after their module directory
+	auto path = GetStaticSymbols().ToPath("/Mods/" + mod.Info.Directory + ".pak", PathRootType::UserProfile);
+	if (path.empty()) {
+		return {};
+	}
+
+	return FromUTF8(path);
+}
+
+std::optional<PersistentModuleHashCache::SourceFileInfo> PersistentModuleHashCache::ReadSourceFile(STDWString const& path)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes)
+		|| (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		return {};
+	}
+
+	SourceFileInfo info;
+	info.Path = path;
+	info.Size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	info.ModifiedTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+	auto digest = GetContentDigest(path, info.Size);
+	if (!digest) {
+		return {};
+	}
+
+	info.ContentDigest = *digest;
+	return info;
+}
+
+void PersistentModuleHashCache::PrefetchFile(STDWString const& path)
+{
+	std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+	std::vector<char> buf(0x100000);
+	while (f.read(buf.data(), buf.size())) {}
+}
+
+std::optional<uint64_t> PersistentModuleHashCache::GetContentDigest(STDWString const& path, uint64_t size)
+{
+	std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+	if (!f.good()) {
+		return {};
+	}
+
+	std::vector<char> sample;
+	if (size <= ModuleHashSampleSize * 2) {
+		sample.resize(size);
+		f.read(sample.data(), size);
+	} else {
+		sample.resize(ModuleHashSampleSize * 2);
+		f.read(sample.data(), ModuleHashSampleSize);
+		f.seekg(size - ModuleHashSampleSize, std::ios::beg);
+		f.read(sample.data() + ModuleHashSampleSize, ModuleHashSampleSize);
+	}
+
+	if (!f.good()) {
+		return {};
+	}
+
+	uint64_t hash[2];
+	MurmurHash3_x64_128(sample.data(), (int)sample.size(), 0, hash);
+	return hash[0] ^ hash[1] ^ size;
+}
+
+std::optional<STDString> PersistentModuleHashCache::Find(Module const& mod)
+{
+	auto path = GetSourcePath(mod);
+	if (!path) {
+		return {};
+	}
+
+	return Find(mod, ReadSourceFile(*path));
+}
+
+std::optional<STDString> PersistentModuleHashCache::Find(Module const& mod, std::optional<SourceFileInfo> const& source)
+{
+	if (!loaded_) {
+		Load();
+	}
+
+	auto it = entries_.find(mod.Info.ModuleUUIDString);
+	if (it == entries_.end() || !source) {
+		return {};
+	}
+
+	// The content digest catches files that were replaced in place without changing their metadata
+	auto const& entry = it->second;
+	if (ToUTF8(source->Path) != entry.Path
+		|| source->Size != entry.Size
+		|| source->ModifiedTime != entry.ModifiedTime
+		|| source->ContentDigest != entry.ContentDigest) {
+		return {};
+	}
+
+	return entry.Hash;
+}
+
+void PersistentModuleHashCache::Update(Module const& mod)
+{
+	auto path = GetSourcePath(mod);
+	if (!path) {
+		return;
+	}
+
+	Update(mod, ReadSourceFile(*path));
+}
+
+void PersistentModuleHashCache::Update(Module const& mod, std::optional<SourceFileInfo> const& source)
+{
+	if (mod.Info.Hash.empty() || !source) {
+		return;
+	}
+
+	Entry entry;
+	entry.Path = ToUTF8(source->Path);
+	entry.Size = source->Size;
+	entry.ModifiedTime = source->ModifiedTime;
+	entry.ContentDigest = source->ContentDigest;
+	entry.Hash = mod.Info.Hash;
+	entries_[mod.Info.ModuleUUIDString] = entry;
+	dirty_ = true;
+}
+
 void ModuleHasher::PostStartup()
 {
 	using namespace std::placeholders;
@@ -20,15 +230,50 @@ void ModuleHasher::ClearCaches()
 
 bool ModuleHasher::FetchHashFromCache(Module& mod)
 {
+	std::unique_lock lock(mutex_);
+	STDString hash;
 	auto it = hashCache_.find(mod.Info.ModuleUUIDString);
 	if (it != hashCache_.end()) {
-		mod.Info.Hash = it->second;
-		mod.HasValidHash = true;
-		UpdateDependencyHashes(mod);
-		return true;
+		hash = it->second;
+	} else {
+		auto cached = persistentCache_.Find(mod);
+		if (!cached) {
+			return false;
+		}
+
+		hash = *cached;
 	}
-	else {
-		return false;
+
+	lock.unlock();
+	ApplyHash(mod, hash);
+	return true;
+}
+
+void ModuleHasher::ApplyHash(Module& mod, STDString const& hash)
+{
+	{
+		std::lock_guard _(mutex_);
+		hashCache_.insert(std::make_pair(mod.Info.ModuleUUIDString, hash));
+	}
+
+	mod.Info.Hash = hash;
+	mod.HasValidHash = true;
+	UpdateDependencyHashes(mod);
+}
+
+void ModuleHasher::AddHashToCache(Module const& mod, std::optional<PersistentModuleHashCache::SourceFileInfo> const& source)
+{
+	if (mod.Info.Hash.empty()) {
+		return;
+	}
+
+	std::lock_guard _(mutex_);
+	if (hashCache_.insert(std::make_pair(mod.Info.ModuleUUIDString, mod.Info.Hash)).second) {
+		if (source) {
+			persistentCache_.Update(mod, source);
+		} else {
+			persistentCache_.Update(mod);
+		}
 	}
 }
 
@@ -47,19 +292,112 @@ void ModuleHasher::UpdateDependencyHashes(Module& mod)
 	}*/
 }
 
+void ModuleHasher::PrefetchDependencyHashes(Module::HashProc* next, Module& mod)
+{
+	struct PendingModule
+	{
+		Module* Mod;
+		STDWString Path;
+		std::optional<PersistentModuleHashCache::SourceFileInfo> Source;
+		std::optional<STDString> CachedHash;
+	};
+
+	std::vector<PendingModule> pending;
+	std::unordered_set<FixedString> seen;
+	for (auto modules : { &mod.DependentModules, &mod.AddonModules }) {
+		for (auto& dependency : *modules) {
+			if (!seen.insert(dependency.Info.ModuleUUIDString).second) continue;
+
+			{
+				std::unique_lock lock(mutex_);
+				auto it = hashCache_.find(dependency.Info.ModuleUUIDString);
+				if (it != hashCache_.end()) {
+					auto hash = it->second;
+					lock.unlock();
+					ApplyHash(dependency, hash);
+					continue;
+				}
+			}
+
+			auto path = PersistentModuleHashCache::GetSourcePath(dependency);
+			if (path) {
+				pending.push_back(PendingModule{ &dependency, *path });
+			}
+		}
+	}
+
+	if (pending.size() < 2) {
+		return;
+	}
+
+	// Only file I/O is done on the workers: validating persistent cache entries
+	// and reading the files of modules that need to be rehashed
+	auto numWorkers = std::min<size_t>({ pending.size(), std::max(std::thread::hardware_concurrency(), 1u), MaxHashWorkers });
+	std::atomic<size_t> nextModule{ 0 };
+	auto worker = [this, &pending, &nextModule]() {
+		for (;;) {
+			auto index = nextModule++;
+			if (index >= pending.size()) break;
+
+			auto& dependency = pending[index];
+			dependency.Source = PersistentModuleHashCache::ReadSourceFile(dependency.Path);
+			{
+				std::lock_guard _(mutex_);
+				dependency.CachedHash = persistentCache_.Find(*dependency.Mod, dependency.Source);
+			}
+
+			if (!dependency.CachedHash) {
+				PersistentModuleHashCache::PrefetchFile(dependency.Path);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 1; i < numWorkers; i++) {
+		workers.emplace_back(worker);
+	}
+
+	worker();
+
+	for (auto& thread : workers) {
+		thread.join();
+	}
+
+	// The game's hash function isn't safe to call concurrently, so hashing stays on the calling thread
+	// (which holds hashMutex_)
+	for (auto& dependency : pending) {
+		if (dependency.CachedHash) {
+			ApplyHash(*dependency.Mod, *dependency.CachedHash);
+		} else if (!FetchHashFromCache(*dependency.Mod)) {
+			hashDepth_++;
+			next(dependency.Mod);
+			hashDepth_--;
+			AddHashToCache(*dependency.Mod, dependency.Source);
+		}
+	}
+}
+
 bool ModuleHasher::OnModuleHash(Module::HashProc* next, Module* self)
 {
-	std::lock_guard _(mutex_);
+	// Cache hits don't need to wait for hashes running on other threads
+	if (FetchHashFromCache(*self)) {
+		return true;
+	}
 
+	std::lock_guard hashLock(hashMutex_);
+	// Another thread may have hashed the module while we were waiting for the lock
 	if (FetchHashFromCache(*self)) {
 		return true;
 	}
 
+	auto isTopLevel = (hashDepth_ == 0);
+	if (isTopLevel) {
+		// Hash dependencies up front; the nested hash calls of the game will pick them up from the cache
+		PrefetchDependencyHashes(next, *self);
+	}
+
 	if (!hashStack_.empty()) {
-		auto mod = *hashStack_.rbegin();
-		if (!mod->Info.Hash.empty()) {
-			hashCache_.insert(std::make_pair(mod->Info.ModuleUUIDString, mod->Info.Hash));
-		}
+		AddHashToCache(**hashStack_.rbegin());
 	}
 
 	hashStack_.push_back(self);
@@ -67,11 +405,14 @@ bool ModuleHasher::OnModuleHash(Module::HashProc* next, Module* self)
 	hashDepth_++;
 	auto ok = next(self);
 	hashDepth_--;
-	if (!self->Info.Hash.empty()) {
-		hashCache_.insert(std::make_pair(self->Info.ModuleUUIDString, self->Info.Hash));
-	}
+	AddHashToCache(*self);
 
 	hashStack_.pop_back();
+	if (isTopLevel) {
+		std::lock_guard _(mutex_);
+		persistentCache_.Save();
+	}
+
 	return ok;
 }
 
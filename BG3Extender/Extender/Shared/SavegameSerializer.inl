@@ -34,8 +34,8 @@ void SavegameSerializer::Serialize(ObjectVisitor* visitor, uint32_t version)
 	// SerializeStatObjects(visitor, version);
 
 	if (version >= SavegameVerAddedUserVars) {
-		gExtender->GetServer().GetExtensionState().GetUserVariables().SavegameVisit(visitor);
-		gExtender->GetServer().GetExtensionState().GetModVariables().SavegameVisit(visitor);
+		gExtender->GetServer().GetExtensionState().GetUserVariables().SavegameVisit(visitor, version);
+		gExtender->GetServer().GetExtensionState().GetModVariables().SavegameVisit(visitor, version);
 	}
 }
 
@@ -6,6 +6,30 @@
 
 BEGIN_NS(stats)
 
+// Resolves stats .txt paths (".../Public/<ModDirectory>/Stats/Generated/*.txt") to the index of the mod
+// that owns them using a prefix trie of mod directories
+class StatPathModResolver
+{
+public:
+	static constexpr uint32_t NoMod = 0xffffffffu;
+
+	void Clear();
+	void AddMod(StringView directory, uint32_t modIndex);
+	uint32_t Resolve(StringView path) const;
+
+private:
+	struct Node
+	{
+		Vector<std::pair<char, uint32_t>> Children;
+		uint32_t ModIndex{ NoMod };
+	};
+
+	Vector<Node> nodes_;
+
+	uint32_t FindChild(uint32_t node, char ch) const;
+	uint32_t Match(StringView path) const;
+};
+
 class StatLoadOrderHelper
 {
 public:
@@ -21,15 +45,24 @@ public:
 private:
 	struct StatsEntryModMapping
 	{
-		FixedString Mod;
+		uint32_t ModIndex;
+		// Order in which the entry was (last) declared during stats load
+		uint32_t Sequence;
 		void* PreParseBuf;
 	};
 
 	std::shared_mutex modMapMutex_;
-	std::unordered_map<STDString, FixedString> modDirectoryToModMap_;
+	StatPathModResolver modResolver_;
+	// Mods in load order at the time stats were loaded
+	Array<FixedString> mods_;
 	std::unordered_map<FixedString, StatsEntryModMapping> statsEntryToModMap_;
-	FixedString statLastTxtMod_;
+	// Stats entries declared by each mod, in declaration order; indexed by mod load order
+	Vector<Array<FixedString>> modStats_;
+	uint32_t statLastTxtMod_{ StatPathModResolver::NoMod };
+	uint32_t nextSequence_{ 0 };
 	bool loadingStats_{ false };
+
+	void BuildModStatsIndex();
 };
 
 END_NS()
@@ -1,13 +1,100 @@
 #include <Extender/Shared/StatLoadOrderHelper.h>
-#include <regex>
 
 BEGIN_NS(stats)
 
+static constexpr StringView StatPathModPrefix = "/Public/";
+static constexpr StringView StatPathModSuffix = "/Stats/Generated/";
+static constexpr StringView StatPathExtension = ".txt";
+
+void StatPathModResolver::Clear()
+{
+	nodes_.clear();
+	nodes_.push_back(Node{});
+}
+
+uint32_t StatPathModResolver::FindChild(uint32_t node, char ch) const
+{
+	for (auto const& child : nodes_[node].Children) {
+		if (child.first == ch) {
+			return child.second;
+		}
+	}
+
+	return NoMod;
+}
+
+void StatPathModResolver::AddMod(StringView directory, uint32_t modIndex)
+{
+	if (nodes_.empty()) {
+		nodes_.push_back(Node{});
+	}
+
+	uint32_t node = 0;
+	auto insert = [&](StringView str) {
+		for (auto ch : str) {
+			auto next = FindChild(node, ch);
+			if (next == NoMod) {
+				next = (uint32_t)nodes_.size();
+				nodes_[node].Children.push_back(std::make_pair(ch, next));
+				nodes_.push_back(Node{});
+			}
+
+			node = next;
+		}
+	};
+
+	insert(directory);
+	insert(StatPathModSuffix);
+	nodes_[node].ModIndex = modIndex;
+}
+
+uint32_t StatPathModResolver::Match(StringView path) const
+{
+	uint32_t node = 0;
+	for (auto ch : path) {
+		node = FindChild(node, ch);
+		if (node == NoMod) {
+			return NoMod;
+		}
+
+		if (nodes_[node].ModIndex != NoMod) {
+			return nodes_[node].ModIndex;
+		}
+	}
+
+	return NoMod;
+}
+
+uint32_t StatPathModResolver::Resolve(StringView path) const
+{
+	if (nodes_.empty()
+		|| path.size() < StatPathExtension.size()
+		|| path.substr(path.size() - StatPathExtension.size()) != StatPathExtension) {
+		return NoMod;
+	}
+
+	// Mod directories may themselves contain a "Public" directory, so prefer the last match
+	auto pos = path.rfind(StatPathModPrefix);
+	while (pos != StringView::npos) {
+		auto modIndex = Match(path.substr(pos + StatPathModPrefix.size()));
+		if (modIndex != NoMod) {
+			return modIndex;
+		}
+
+		if (pos == 0) break;
+		pos = path.rfind(StatPathModPrefix, pos - 1);
+	}
+
+	return NoMod;
+}
+
 void StatLoadOrderHelper::OnLoadStarted()
 {
 	loadingStats_ = true;
-	statLastTxtMod_ = FixedString{};
+	statLastTxtMod_ = StatPathModResolver::NoMod;
+	nextSequence_ = 0;
 	statsEntryToModMap_.clear();
+	modStats_.clear();
 	UpdateModDirectoryMap();
 }
 
@@ -15,17 +102,20 @@ void StatLoadOrderHelper::OnLoadFinished()
 {
 	OnStatFileOpened();
 	loadingStats_ = false;
+	BuildModStatsIndex();
 }
 
 void StatLoadOrderHelper::UpdateModDirectoryMap()
 {
 	std::unique_lock _(modMapMutex_);
-	modDirectoryToModMap_.clear();
+	modResolver_.Clear();
+	mods_.clear();
 
 	auto modManager = gExtender->GetCurrentExtensionState()->GetModManager();
 	if (modManager) {
 		for (auto const& mod : modManager->BaseModule.LoadOrderedModules) {
-			modDirectoryToModMap_.insert(std::make_pair(mod.Info.Directory, mod.Info.ModuleUUIDString));
+			modResolver_.AddMod(mod.Info.Directory, (uint32_t)mods_.size());
+			mods_.push_back(mod.Info.ModuleUUIDString);
 		}
 	}
 }
@@ -39,32 +129,51 @@ void StatLoadOrderHelper::OnStatFileOpened()
 		auto entry = statsEntryToModMap_.find(kv.Key);
 		if (entry == statsEntryToModMap_.end()) {
 			StatsEntryModMapping mapping;
-			mapping.Mod = statLastTxtMod_;
+			mapping.ModIndex = statLastTxtMod_;
+			mapping.Sequence = nextSequence_++;
 			mapping.PreParseBuf = preParseBuf;
 			statsEntryToModMap_.insert(std::make_pair(kv.Key, mapping));
 		} else if (entry->second.PreParseBuf != preParseBuf) {
-			entry->second.Mod = statLastTxtMod_;
+			entry->second.ModIndex = statLastTxtMod_;
+			entry->second.Sequence = nextSequence_++;
 			entry->second.PreParseBuf = preParseBuf;
 		}
 	}
 }
 
-static std::regex sStatPathRegex(".*/Public/(.*)/Stats/Generated/.*.txt$");
-
 void StatLoadOrderHelper::OnStatFileOpened(Path const& path)
 {
 	if (!loadingStats_) return;
 
-	std::cmatch match;
-	if (std::regex_match(path.Name.c_str(), match, sStatPathRegex)) {
-		std::unique_lock lock(modMapMutex_);
+	std::unique_lock lock(modMapMutex_);
+	auto modIndex = modResolver_.Resolve(path.Name);
+	if (modIndex != StatPathModResolver::NoMod) {
+		statLastTxtMod_ = modIndex;
+		OnStatFileOpened();
+	} else if (path.Name.find(StatPathModSuffix) != STDString::npos) {
+		WARN("Unable to resolve mod while loading stats .txt: %s", path.Name.c_str());
+	}
+}
+
+void StatLoadOrderHelper::BuildModStatsIndex()
+{
+	std::unique_lock lock(modMapMutex_);
+	Vector<Vector<std::pair<uint32_t, FixedString>>> modEntries;
+	modEntries.resize(mods_.size());
+
+	for (auto const& entry : statsEntryToModMap_) {
+		if (entry.second.ModIndex < modEntries.size()) {
+			modEntries[entry.second.ModIndex].push_back(std::make_pair(entry.second.Sequence, entry.first));
+		}
+	}
 
-		auto modIt = modDirectoryToModMap_.find(match[1].str().c_str());
-		if (modIt != modDirectoryToModMap_.end()) {
-			statLastTxtMod_ = modIt->second;
-			OnStatFileOpened();
-		} else {
-			WARN("Unable to resolve mod while loading stats .txt: %s", path.Name.c_str());
+	modStats_.clear();
+	modStats_.resize(mods_.size());
+	for (uint32_t i = 0; i < modEntries.size(); i++) {
+		auto& entries = modEntries[i];
+		std::sort(entries.begin(), entries.end());
+		for (auto const& entry : entries) {
+			modStats_[i].push_back(entry.second);
 		}
 	}
 }
@@ -72,8 +181,8 @@ void StatLoadOrderHelper::OnStatFileOpened(Path const& path)
 FixedString StatLoadOrderHelper::GetStatsEntryMod(FixedString statId) const
 {
 	auto entryIt = statsEntryToModMap_.find(statId);
-	if (entryIt != statsEntryToModMap_.end()) {
-		return entryIt->second.Mod;
+	if (entryIt != statsEntryToModMap_.end() && entryIt->second.ModIndex < mods_.size()) {
+		return mods_[entryIt->second.ModIndex];
 	} else {
 		return {};
 	}
@@ -81,30 +190,27 @@ FixedString StatLoadOrderHelper::GetStatsEntryMod(FixedString statId) const
 
 std::vector<Object*> StatLoadOrderHelper::GetStatsLoadedBefore(FixedString modId) const
 {
-	std::unordered_set<FixedString> modsLoadedBefore;
-	auto state = gExtender->GetCurrentExtensionState();
-	if (!state) return {};
-
-	bool modIdFound{ false };
-	for (auto const& mod : state->GetModManager()->BaseModule.LoadOrderedModules) {
-		modsLoadedBefore.insert(mod.Info.ModuleUUIDString);
-		if (mod.Info.ModuleUUIDString == modId) {
-			modIdFound = true;
+	std::optional<uint32_t> lastMod;
+	for (uint32_t i = 0; i < mods_.size(); i++) {
+		if (mods_[i] == modId) {
+			lastMod = i;
 			break;
 		}
 	}
 
-	if (!modIdFound) {
+	if (!lastMod) {
 		OsiError("Couldn't fetch stat entry list - mod " << modId << " is not loaded.");
 		return {};
 	}
 
 	std::vector<Object*> statsLoadedBefore;
 	auto stats = GetStaticSymbols().GetStats();
-	for (auto const& object : stats->Objects.Primitives) {
-		auto statEntryMod = GetStatsEntryMod(object->Name);
-		if (statEntryMod && modsLoadedBefore.find(statEntryMod) != modsLoadedBefore.end()) {
-			statsLoadedBefore.push_back(object);
+	for (uint32_t i = 0; i <= *lastMod && i < modStats_.size(); i++) {
+		for (auto const& statId : modStats_[i]) {
+			auto object = stats->Objects.Find(statId);
+			if (object != nullptr) {
+				statsLoadedBefore.push_back(object);
+			}
 		}
 	}
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <GameDefinitions/Base/Base.h>
+#include <GameDefinitions/Stats/Stats.h>
+#include <Extender/Shared/ExtenderNet.h>
+
+BEGIN_NS(stats)
+
+// Collects stats entries that were synced during a tick and replicates them to clients
+// in a single batch at the end of the tick.
+// Only attributes whose value changed since the previous sync of the entry are sent;
+// when a peer (re)connects, all previously synced entries are resent in full.
+class StatSyncQueue
+{
+public:
+	void Enqueue(Object const& object);
+	void Flush();
+	void Clear();
+
+	// Applies a batch of stats updates received from the server
+	static void Apply(net::MsgS2CSyncStats const& msg);
+
+private:
+	// Max (approximate) size of sync message we're allowed to send
+	static constexpr size_t SyncMessageBudget = 300000;
+
+	// Serialized attribute values and roll conditions of an entry at the time of its last sync
+	struct SyncedState
+	{
+		Vector<std::string> Attributes;
+		std::unordered_map<FixedString, std::string> RollConditions;
+	};
+
+	Array<FixedString> pending_;
+	std::unordered_set<FixedString> pendingSet_;
+	std::unordered_map<FixedString, SyncedState> syncedState_;
+	// Network connection generation the synced state baseline belongs to
+	uint32_t connectionGeneration_{ 0 };
+
+	void Enqueue(FixedString const& name);
+	bool MakeUpdate(Object* object, net::StatObjectUpdate& update);
+};
+
+END_NS()
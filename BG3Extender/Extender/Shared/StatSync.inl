@@ -0,0 +1,269 @@
+#include <Extender/Shared/StatSync.h>
+
+BEGIN_NS(stats)
+
+void StatSyncQueue::Enqueue(Object const& object)
+{
+	Enqueue(object.Name);
+}
+
+void StatSyncQueue::Enqueue(FixedString const& name)
+{
+	if (pendingSet_.insert(name).second) {
+		pending_.push_back(name);
+	}
+}
+
+void StatSyncQueue::Clear()
+{
+	pending_.clear();
+	pendingSet_.clear();
+	syncedState_.clear();
+}
+
+bool StatSyncQueue::MakeUpdate(Object* object, net::StatObjectUpdate& update)
+{
+	auto stats = GetStaticSymbols().GetStats();
+	auto modifierList = stats->ModifierLists.Find(object->ModifierListIndex);
+	if (modifierList == nullptr) {
+		return false;
+	}
+
+	auto& state = syncedState_[object->Name];
+	auto const& attributes = modifierList->Attributes.Primitives;
+	auto firstSync = state.Attributes.empty();
+	state.Attributes.resize(attributes.size());
+
+	net::StatAttribute attr;
+	std::string encoded;
+	for (uint32_t i = 0; i < attributes.size(); i++) {
+		auto const& name = attributes[i]->Name;
+		auto typeInfo = stats->ModifierValueLists.Find(attributes[i]->EnumerationIndex);
+		if (typeInfo == nullptr
+			|| typeInfo->Name == GFS.strRollConditions
+			|| typeInfo->Name == GFS.strStatsFunctors) {
+			continue;
+		}
+
+		attr.Clear();
+		attr.set_index(i);
+
+		if (RPGEnumeration::IsFlagType(typeInfo->Name)) {
+			auto val = object->GetInt64(name);
+			if (val) attr.set_flagsval(*val); else attr.set_null(true);
+		} else if (typeInfo->Name == GFS.strConstantInt || typeInfo->Values.size() > 0) {
+			attr.set_intval(object->IndexedProperties[i]);
+		} else if (typeInfo->Name == GFS.strConstantFloat) {
+			auto val = object->GetFloat(name);
+			if (val) attr.set_floatval(*val); else attr.set_null(true);
+		} else if (typeInfo->Name == GFS.strGuid) {
+			auto val = object->GetGuid(name);
+			if (val) attr.set_stringval(val->ToString().c_str()); else attr.set_null(true);
+		} else if (typeInfo->Name == GFS.strTranslatedString) {
+			auto val = object->GetTranslatedString(name);
+			if (val) {
+				attr.set_stringval((STDString(val->Handle.Handle.GetStringView()) + ";" + std::to_string(val->Handle.Version).c_str()).c_str());
+			} else {
+				attr.set_null(true);
+			}
+		} else {
+			auto val = object->GetString(name);
+			if (val) attr.set_stringval(val->c_str()); else attr.set_null(true);
+		}
+
+		encoded.clear();
+		attr.SerializeToString(&encoded);
+		if (firstSync || state.Attributes[i] != encoded) {
+			*update.add_attributes() = attr;
+			state.Attributes[i] = std::move(encoded);
+		}
+	}
+
+	for (auto const& conditions : object->RollConditions) {
+		net::StatRollConditions rollConditions;
+		rollConditions.set_attribute(conditions.Key().GetString());
+		for (auto const& cond : conditions.Value()) {
+			auto condStr = stats->GetConditions(cond.ConditionsId);
+			auto rollCond = rollConditions.add_conditions();
+			rollCond->set_name(cond.Name.GetString());
+			if (condStr) {
+				rollCond->set_conditions((*condStr)->c_str());
+			}
+		}
+
+		encoded.clear();
+		rollConditions.SerializeToString(&encoded);
+		auto& lastSynced = state.RollConditions[conditions.Key()];
+		if (lastSynced != encoded) {
+			*update.add_roll_conditions() = std::move(rollConditions);
+			lastSynced = std::move(encoded);
+		}
+	}
+
+	if (update.attributes_size() == 0 && update.roll_conditions_size() == 0) {
+		return false;
+	}
+
+	update.set_name(object->Name.GetString());
+	update.set_modifier_list(modifierList->Name.GetString());
+	return true;
+}
+
+void StatSyncQueue::Flush()
+{
+	if (pending_.empty() && syncedState_.empty()) return;
+
+	auto state = GetStaticSymbols().GetServerState();
+	if (!state
+		|| *state == esv::GameState::LoadSession
+		|| *state == esv::GameState::LoadLevel
+		|| *state == esv::GameState::Sync) {
+		return;
+	}
+
+	auto& networkMgr = gExtender->GetServer().GetNetworkManager();
+	if (connectionGeneration_ != networkMgr.GetConnectionGeneration()) {
+		// A peer (re)connected since the last flush and has none of the changes we've diffed against;
+		// drop the baseline and resend every previously synced entry in full
+		connectionGeneration_ = networkMgr.GetConnectionGeneration();
+		for (auto const& synced : syncedState_) {
+			Enqueue(synced.first);
+		}
+		syncedState_.clear();
+	}
+
+	if (pending_.empty()) return;
+
+	auto stats = GetStaticSymbols().GetStats();
+	net::ExtenderMessage* msg{ nullptr };
+	size_t budget{ 0 };
+	uint32_t numObjects{ 0 };
+
+	auto send = [&]() {
+		if (msg != nullptr) {
+			// Host client shares stats with the server, no need to send it the update
+			networkMgr.BroadcastToConnectedPeers(msg, ReservedUserId, true, net::ExtenderMessage::VerBatchedStatSync);
+			msg = nullptr;
+			budget = 0;
+		}
+	};
+
+	for (auto const& statName : pending_) {
+		auto object = stats->Objects.Find(statName);
+		if (object == nullptr) continue;
+
+		net::StatObjectUpdate update;
+		if (!MakeUpdate(object, update)) continue;
+
+		if (msg != nullptr && budget > SyncMessageBudget) {
+			send();
+		}
+
+		if (msg == nullptr) {
+			msg = networkMgr.GetFreeMessage();
+			if (msg == nullptr) {
+				OsiErrorS("Failed to get free message");
+				break;
+			}
+		}
+
+		budget += update.ByteSizeLong();
+		*msg->GetMessage().mutable_s2c_sync_stats()->add_objects() = std::move(update);
+		numObjects++;
+	}
+
+	send();
+	DEBUG("Synced %d of %d dirty stats entries to clients", numObjects, pending_.size());
+	pending_.clear();
+	pendingSet_.clear();
+}
+
+void StatSyncQueue::Apply(net::MsgS2CSyncStats const& msg)
+{
+	auto stats = GetStaticSymbols().GetStats();
+	Array<Object*> updated;
+
+	for (auto const& update : msg.objects()) {
+		auto name = FixedString(update.name().c_str());
+		auto object = stats->Objects.Find(name);
+		if (object == nullptr) {
+			auto newObject = stats->CreateObject(name, FixedString(update.modifier_list().c_str()));
+			if (!newObject) {
+				OsiError("Could not construct stats object from server: " << update.name());
+				continue;
+			}
+
+			object = *newObject;
+		}
+
+		auto modifierList = stats->ModifierLists.Find(object->ModifierListIndex);
+		if (modifierList == nullptr) {
+			OsiError("Stats object '" << update.name() << "' has no modifier list on the client");
+			continue;
+		}
+
+		if (modifierList->Name != FixedString(update.modifier_list().c_str())) {
+			OsiError("Stats object '" << update.name() << "' is a " << modifierList->Name
+				<< " on the client, but the server sent a " << update.modifier_list());
+			continue;
+		}
+
+		auto const& attributes = modifierList->Attributes.Primitives;
+		for (auto const& attr : update.attributes()) {
+			if (attr.index() >= attributes.size() || attr.index() >= object->IndexedProperties.size()) {
+				OsiError("Server sent out of bounds attribute index " << attr.index() << " for stats object '" << update.name() << "'");
+				continue;
+			}
+
+			auto const& attrName = attributes[attr.index()]->Name;
+			if (attr.null()) {
+				object->IndexedProperties[attr.index()] = -1;
+				continue;
+			}
+
+			switch (attr.val_case()) {
+			case net::StatAttribute::kIntval:
+				object->SetInt(attrName, attr.intval());
+				break;
+
+			case net::StatAttribute::kStringval:
+				object->SetString(attrName, attr.stringval().c_str());
+				break;
+
+			case net::StatAttribute::kFloatval:
+				object->SetFloat(attrName, attr.floatval());
+				break;
+
+			case net::StatAttribute::kFlagsval:
+				object->SetInt64(attrName, attr.flagsval());
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		for (auto const& rollConditions : update.roll_conditions()) {
+			Array<Object::RollCondition> conditions;
+			for (auto const& cond : rollConditions.conditions()) {
+				Object::RollCondition rollCond;
+				rollCond.Name = FixedString(cond.name().c_str());
+				rollCond.ConditionsId = stats->GetOrCreateConditions(cond.conditions().c_str());
+				conditions.Add(rollCond);
+			}
+
+			object->SetRollConditions(FixedString(rollConditions.attribute().c_str()), conditions);
+		}
+
+		if (std::find(updated.begin(), updated.end(), object) == updated.end()) {
+			updated.push_back(object);
+		}
+	}
+
+	// Prototypes are only rebuilt once per entry, after all updates in the batch were applied
+	for (auto object : updated) {
+		stats->SyncWithPrototypeManager(object);
+	}
+}
+
+END_NS()
@@ -81,10 +81,14 @@ struct UserVariablePrototype
 	bool NeedsRebroadcast(bool server) const;
 };
 
+class PackedUserVariableWriter;
+
 class UserVariableInterface
 {
 public:
 	virtual UserVariable* Get(Guid const& entity, FixedString const& key) = 0;
+	// Adds all variables that are synced to the other side to a snapshot image
+	virtual void MakeSnapshot(PackedUserVariableWriter& writer) = 0;
 };
 
 enum class UserVarClass
@@ -93,6 +97,37 @@ enum class UserVarClass
 	ModuleVar
 };
 
+struct UserVariableSyncRequest
+{
+	Guid Entity;
+	FixedString Variable;
+
+	inline bool operator == (UserVariableSyncRequest const& o) const
+	{
+		return Entity == o.Entity && Variable == o.Variable;
+	}
+};
+
+template <>
+inline uint64_t MultiHashMapHash<UserVariableSyncRequest>(UserVariableSyncRequest const& v)
+{
+	return HashMulti(v.Entity, v.Variable);
+}
+
+// Maps user variable names to small integer ids, so each name is only sent once to every peer.
+// Ids are only valid until the dictionary is reset; a reset is requested whenever
+// the recipients of sync messages may have changed.
+class UserVariableKeyDictionary
+{
+public:
+	void Reset();
+	// Returns the id of the key; isNew is set if the key wasn't sent to the peers before
+	uint32_t GetOrAdd(FixedString const& key, bool& isNew);
+
+private:
+	MultiHashMap<FixedString, uint32_t> ids_;
+};
+
 class UserVariableSyncWriter
 {
 public:
@@ -104,29 +139,180 @@ public:
 	void Clear();
 	void Sync(Guid const& entity, FixedString const& key, UserVariablePrototype const& proto, UserVariable const* value);
 	void DeferredSync(Guid const& entity, FixedString const& key);
+	// Replicates all synced variables in a single snapshot on the next flush, instead of
+	// queueing a sync for each variable (eg. after a savegame was loaded)
+	void RequestSnapshot();
+
+	// SyncOnWrite variables written while a batch is active are sent when the outermost batch ends
+	void BeginBatch();
+	void EndBatch();
 
 private:
 	// Max (approximate) size of sync message we're allowed to send
 	static constexpr size_t SyncMessageBudget = 300000;
+	// Max size of snapshot data sent in a single message
+	static constexpr size_t SnapshotChunkSize = 0x40000;
 
-	struct SyncRequest
-	{
-		Guid Entity;
-		FixedString Variable;
-	};
+	using SyncRequest = UserVariableSyncRequest;
+	// Each (entity, variable) pair is only queued once; the current value of the variable is sent on flush
+	using SyncQueue = MultiHashSet<SyncRequest>;
 
 	UserVariableInterface* vars_;
-	Array<SyncRequest> deferredSyncs_;
-	Array<SyncRequest> nextTickSyncs_;
+	SyncQueue deferredSyncs_;
+	SyncQueue nextTickSyncs_;
+	SyncQueue batchedSyncs_;
+	uint32_t batchDepth_{ 0 };
 	net::ExtenderMessage* syncMsg_{ nullptr };
 	size_t syncMsgBudget_{ 0 };
 	bool isServer_;
 	UserVarClass varClass_;
 
+	UserVariableKeyDictionary keys_;
+	// Connection generation of the network manager when the key dictionary was last reset
+	std::optional<uint32_t> keysGeneration_;
+	bool internKeys_{ false };
+
+	bool snapshotRequested_{ false };
+	uint32_t nextSnapshotId_{ 1 };
+
 	void AppendToSyncMessage(Guid const& entity, FixedString const& key, UserVariable const& value);
-	void FlushSyncQueue(Array<SyncRequest>& queue);
+	void FlushSyncQueue(SyncQueue& queue);
 	bool MakeSyncMessage();
+	void PrepareKeyDictionary();
 	void SendSyncs();
+	void SendSnapshot();
+};
+
+// RAII helper for UserVariableSyncWriter batches
+class UserVariableSyncBatch : Noncopyable<UserVariableSyncBatch>
+{
+public:
+	inline UserVariableSyncBatch(UserVariableSyncWriter& writer)
+		: writer_(writer)
+	{
+		writer_.BeginBatch();
+	}
+
+	inline ~UserVariableSyncBatch()
+	{
+		writer_.EndBatch();
+	}
+
+private:
+	UserVariableSyncWriter& writer_;
+};
+
+// Packed savegame format of user and mod variables.
+// All variables are stored in a single blob; layout (little endian):
+//   uint32 magic, uint32 format version
+//   string table: uint32 count, (uint32 length, bytes)[]; contains variable names and string values
+//   composite table: uint32 count, (uint32 length, bytes)[]
+//   uint32 owner count, Guid owners[], uint32 variable counts[]
+//   uint32 variable count, uint32 names[], uint8 types[], uint64 values[]
+// Values hold the integer, the bits of the double, or a string/composite table index depending on the type.
+struct PackedUserVariablesFormat
+{
+	static constexpr uint32_t Magic = 0x52415655; // "UVAR"
+	static constexpr uint32_t Version = 1;
+};
+
+class PackedUserVariableWriter
+{
+public:
+	void BeginOwner(Guid const& owner);
+	void EndOwner();
+	void Add(FixedString const& name, UserVariable const& value);
+	void Write(Vector<uint8_t>& out);
+	void Write(ScratchBuffer& blob);
+
+private:
+	MultiHashMap<FixedString, uint32_t> stringIndices_;
+	Vector<FixedString> strings_;
+	Vector<STDString> composites_;
+	Vector<Guid> owners_;
+	Vector<uint32_t> counts_;
+	Vector<uint32_t> names_;
+	Vector<uint8_t> types_;
+	Vector<uint64_t> values_;
+
+	uint32_t AddString(FixedString const& str);
+};
+
+// Only the string table and the owner index are parsed when the blob is loaded;
+// variables of an owner are decoded when the owner is first accessed.
+class PackedUserVariableReader
+{
+public:
+	bool Load(void const* buf, std::size_t size);
+	void Clear();
+
+	inline bool IsEmpty() const
+	{
+		return owners_.empty();
+	}
+
+	inline bool IsPending(Guid const& owner) const
+	{
+		return !owners_.empty() && owners_.try_get(owner) != nullptr;
+	}
+
+	// Decodes the variables of an owner; each owner can only be decoded once
+	bool Decode(Guid const& owner, MultiHashMap<FixedString, UserVariable>& vars);
+	Array<Guid> GetPendingOwners() const;
+
+	// Calls the visitor with the owner and name of each variable that wasn't decoded yet
+	template <class Fun>
+	void ForEachVariable(Fun fun) const
+	{
+		for (auto const& owner : owners_) {
+			for (uint32_t i = owner.Value().FirstVariable; i < owner.Value().FirstVariable + owner.Value().NumVariables; i++) {
+				auto name = GetName(i);
+				if (name) {
+					fun(owner.Key(), name);
+				}
+			}
+		}
+	}
+
+	// Calls the visitor with the owner, name and value of each variable that wasn't decoded yet
+	template <class Fun>
+	void ForEachValue(Fun fun) const
+	{
+		for (auto const& owner : owners_) {
+			for (uint32_t i = owner.Value().FirstVariable; i < owner.Value().FirstVariable + owner.Value().NumVariables; i++) {
+				auto name = GetName(i);
+				auto value = GetValue(i);
+				if (name && value) {
+					fun(owner.Key(), name, *value);
+				}
+			}
+		}
+	}
+
+private:
+	struct OwnerRange
+	{
+		uint32_t FirstVariable;
+		uint32_t NumVariables;
+	};
+
+	struct BlobRange
+	{
+		uint32_t Offset;
+		uint32_t Length;
+	};
+
+	Vector<uint8_t> blob_;
+	Vector<FixedString> strings_;
+	Vector<BlobRange> composites_;
+	MultiHashMap<Guid, OwnerRange> owners_;
+	uint32_t numVariables_{ 0 };
+	std::size_t namesOffset_{ 0 };
+	std::size_t typesOffset_{ 0 };
+	std::size_t valuesOffset_{ 0 };
+
+	FixedString GetName(uint32_t index) const;
+	std::optional<UserVariable> GetValue(uint32_t index) const;
 };
 
 class UserVariableManager : public UserVariableInterface
@@ -151,6 +337,8 @@ public:
 	Guid EntityToGuid(EntityHandle const& entity) const;
 	EntityHandle GuidToEntity(Guid const& guid) const;
 	UserVariable* Get(Guid const& entity, FixedString const& key) override;
+	void MakeSnapshot(PackedUserVariableWriter& writer) override;
+	void ApplySnapshot(PackedUserVariableReader& reader);
 
 	MultiHashMap<FixedString, UserVariable>* GetAll(Guid const& entity);
 	MultiHashMap<Guid, EntityVariables>& GetAll();
@@ -162,16 +350,31 @@ public:
 	void BindCache(lua::CachedUserVariableManager* cache);
 	void Update();
 	void Flush(bool force);
-	void SavegameVisit(ObjectVisitor* visitor);
-	void NetworkSync(net::UserVar const& var);
+	void SavegameVisit(ObjectVisitor* visitor, uint32_t version);
+	// Adds all persistent variables to a packed blob
+	void Pack(PackedUserVariableWriter& writer);
+	// Replaces all variables with the contents of a packed blob
+	bool LoadPacked(void const* buf, std::size_t size);
+	void NetworkSync(net::UserVar const& var, FixedString const& key);
+
+	inline UserVariableSyncWriter& GetSyncWriter()
+	{
+		return sync_;
+	}
 
 private:
 	MultiHashMap<Guid, EntityVariables> vars_;
+	// Variables loaded from the savegame that weren't accessed yet
+	PackedUserVariableReader packed_;
 	MultiHashMap<FixedString, UserVariablePrototype> prototypes_;
 	UserVariableSyncWriter sync_;
 	bool isServer_;
 	lua::CachedUserVariableManager* cache_{ nullptr };
 	ecs::EntitySystemHelpersBase& entityHelpers_;
+
+	void Unpack(Guid const& entity);
+	void UnpackAll();
+	void LegacySavegameVisit(ObjectVisitor* visitor);
 };
 
 class ModVariableMap
@@ -199,6 +402,8 @@ public:
 	UserVariablePrototype const* GetPrototype(FixedString const& key) const;
 	void RegisterPrototype(FixedString const& key, UserVariablePrototype const& proto);
 	void SavegameVisit(ObjectVisitor* visitor);
+	void Pack(PackedUserVariableWriter& writer);
+	void Unpack(PackedUserVariableReader& reader);
 
 private:
 	Guid moduleUuid_;
@@ -217,6 +422,8 @@ public:
 
 	std::optional<int32_t> GuidToModId(Guid const& uuid) const;
 	UserVariable* Get(Guid const& modUuid, FixedString const& key) override;
+	void MakeSnapshot(PackedUserVariableWriter& writer) override;
+	void ApplySnapshot(PackedUserVariableReader& reader);
 
 	ModVariableMap::VariableMap* GetAll(Guid const& modUuid);
 	MultiHashMap<Guid, ModVariableMap>& GetAll();
@@ -232,8 +439,17 @@ public:
 	void BindCache(lua::CachedModVariableManager* cache);
 	void Update();
 	void Flush(bool force);
-	void SavegameVisit(ObjectVisitor* visitor);
-	void NetworkSync(net::UserVar const& var);
+	void SavegameVisit(ObjectVisitor* visitor, uint32_t version);
+	// Adds all persistent variables to a packed blob
+	void Pack(PackedUserVariableWriter& writer);
+	// Replaces all variables with the contents of a packed blob
+	bool LoadPacked(void const* buf, std::size_t size);
+	void NetworkSync(net::UserVar const& var, FixedString const& key);
+
+	inline UserVariableSyncWriter& GetSyncWriter()
+	{
+		return sync_;
+	}
 
 private:
 	MultiHashMap<Guid, uint32_t> modIndices_;
@@ -241,6 +457,8 @@ private:
 	UserVariableSyncWriter sync_;
 	bool isServer_;
 	lua::CachedModVariableManager* cache_{ nullptr };
+
+	void LegacySavegameVisit(ObjectVisitor* visitor);
 };
 
 END_SE()
@@ -282,6 +500,10 @@ struct CachedUserVariable
 	void ParseReference(lua_State* L, StringView json);
 };
 
+// Max. time spent on writing cached values to the global variable store per tick;
+// values that don't fit into the budget are written on the next tick
+static constexpr uint64_t CachedVariableFlushBudgetUs = 1000;
+
 class CachedUserVariableManager
 {
 public:
@@ -304,7 +526,11 @@ public:
 	void Set(lua_State* L, EntityHandle entity, FixedString const& key, UserVariablePrototype const& proto, CachedUserVariable && var);
 	void Invalidate();
 	void Invalidate(EntityHandle entity, FixedString const& key);
-	void Flush();
+	// Writes dirty cached values to the global variable store.
+	// Unforced flushes only write synced variables and stop when the time budget is used up;
+	// other variables are only written by forced flushes (sync, savegame, snapshot and Lua reset).
+	void Flush(bool force);
+	void Flush(lua_State* L, bool force);
 
 private:
 	struct FlushRequest
@@ -323,13 +549,17 @@ private:
 	UserVariableManager& global_;
 	bool isServer_;
 	MultiHashMap<EntityHandle, EntityVariables> vars_;
+	// Dirty variables that are synced to the other side
 	Array<FlushRequest> flushQueue_;
+	// Dirty variables that are only flushed on request
+	Array<FlushRequest> deferredFlushQueue_;
 
 	CachedUserVariable* GetFromCache(EntityHandle entity, FixedString const& key, Guid& entityGuid);
 	CachedUserVariable* GetFromCache(EntityHandle entity, FixedString const& key);
 	CachedUserVariable* PutCache(lua_State* L, EntityHandle entity, FixedString const& key, Guid const& entityGuid, UserVariablePrototype const& proto, UserVariable const& value);
 	CachedUserVariable* PutCache(EntityHandle entity, FixedString const& key, Guid const& entityGuid, UserVariablePrototype const& proto, CachedUserVariable && value, bool isWrite);
 	void MoveToGlobal(lua_State* L, EntityHandle entity, FixedString const& key, UserVariablePrototype const& proto, CachedUserVariable& var);
+	void FlushQueue(lua_State* L, Array<FlushRequest>& queue, uint64_t budgetUs);
 };
 
 class CachedModVariableManager
@@ -355,7 +585,9 @@ public:
 	void Set(lua_State* L, uint32_t modIndex, FixedString const& key, UserVariablePrototype const& proto, CachedUserVariable && var);
 	void Invalidate();
 	void Invalidate(uint32_t modIndex, FixedString const& key);
-	void Flush();
+	// Writes dirty cached values to the global variable store; see CachedUserVariableManager::Flush()
+	void Flush(bool force);
+	void Flush(lua_State* L, bool force);
 
 private:
 	struct FlushRequest
@@ -374,12 +606,16 @@ private:
 	ModVariableManager& global_;
 	bool isServer_;
 	MultiHashMap<uint32_t, ModVariables> vars_;
+	// Dirty variables that are synced to the other side
 	Array<FlushRequest> flushQueue_;
+	// Dirty variables that are only flushed on request
+	Array<FlushRequest> deferredFlushQueue_;
 
 	CachedUserVariable* GetFromCache(uint32_t modIndex, FixedString const& key, Guid& modUuid);
 	CachedUserVariable* GetFromCache(uint32_t modIndex, FixedString const& key);
 	CachedUserVariable* PutCache(lua_State* L, uint32_t modIndex, FixedString const& key, Guid const& modUuid, UserVariablePrototype const& proto, UserVariable const& value);
 	CachedUserVariable* PutCache(uint32_t modIndex, FixedString const& key, Guid const& modUuid, UserVariablePrototype const& proto, CachedUserVariable && value, bool isWrite);
+	void FlushQueue(lua_State* L, Array<FlushRequest>& queue, uint64_t budgetUs);
 };
 
 END_NS()
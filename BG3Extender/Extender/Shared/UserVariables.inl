@@ -1,4 +1,5 @@
 #include <Extender/Shared/UserVariables.h>
+#include <Extender/Version.h>
 #include <GameDefinitions/Components/Components.h>
 #include <Lua/Libs/Json.h>
 
@@ -7,19 +8,92 @@
 
 BEGIN_NS(net)
 
-void ExtenderProtocolBase::SyncUserVars(MsgUserVars const& msg)
+void ExtenderProtocolBase::SyncUserVars(PeerId peerId, MsgUserVars const& msg)
 {
 	USER_VAR_DBG("Received sync message from peer");
+	auto& keys = userVarKeys_[msg.type() == UserVarType::MODULE_VAR ? 1 : 0][peerId];
+	if (msg.reset_keys()) {
+		keys.clear();
+	}
+
+	for (auto const& key : msg.keys()) {
+		if (key.id() >= keys.size()) {
+			keys.resize(key.id() + 1);
+		}
+
+		keys[key.id()] = FixedString(key.name());
+	}
+
 	auto state = gExtender->GetCurrentExtensionState();
 	for (auto const& var : msg.vars()) {
+		FixedString key;
+		if (var.key_id() != 0) {
+			if (var.key_id() < keys.size()) {
+				key = keys[var.key_id()];
+			}
+
+			if (!key) {
+				ERR("Received sync for user variable with unknown key id %d!", var.key_id());
+				continue;
+			}
+		} else {
+			key = FixedString(var.key());
+		}
+
 		if (var.type() == UserVarType::MODULE_VAR) {
-			state->GetModVariables().NetworkSync(var);
+			state->GetModVariables().NetworkSync(var, key);
 		} else {
-			state->GetUserVariables().NetworkSync(var);
+			state->GetUserVariables().NetworkSync(var, key);
 		}
 	}
 }
 
+void ExtenderProtocolBase::ResetUserVarKeys(PeerId peerId)
+{
+	for (auto& keys : userVarKeys_) {
+		keys.erase(peerId);
+	}
+}
+
+void ExtenderProtocolBase::SyncUserVarSnapshot(MsgS2CUserVarSnapshot const& msg)
+{
+	auto& snapshot = userVarSnapshots_[msg.type() == UserVarType::MODULE_VAR ? 1 : 0];
+	if (msg.offset() == 0) {
+		snapshot.SnapshotId = msg.snapshot_id();
+		snapshot.TotalSize = msg.total_size();
+		snapshot.Data.clear();
+		snapshot.Data.reserve(msg.total_size());
+	} else if (msg.snapshot_id() != snapshot.SnapshotId || msg.offset() != snapshot.Data.size()) {
+		ERR("Received out of order chunk of user variable snapshot %d!", msg.snapshot_id());
+		return;
+	}
+
+	if (snapshot.Data.size() + msg.data().size() > snapshot.TotalSize) {
+		ERR("Chunk of user variable snapshot %d exceeds snapshot size!", msg.snapshot_id());
+		snapshot = UserVarSnapshotBuffer{};
+		return;
+	}
+
+	snapshot.Data.insert(snapshot.Data.end(), msg.data().begin(), msg.data().end());
+	if (snapshot.Data.size() < snapshot.TotalSize) return;
+
+	USER_VAR_DBG("Received user variable snapshot %d", snapshot.SnapshotId);
+	PackedUserVariableReader reader;
+	auto loaded = reader.Load(snapshot.Data.data(), snapshot.Data.size());
+	snapshot = UserVarSnapshotBuffer{};
+	if (!loaded) {
+		ERR("Failed to load user variable snapshot %d!", msg.snapshot_id());
+		return;
+	}
+
+	auto state = gExtender->GetCurrentExtensionState();
+	if (msg.type() == UserVarType::MODULE_VAR) {
+		state->GetModVariables().ApplySnapshot(reader);
+	} else {
+		state->GetUserVariables().ApplySnapshot(reader);
+	}
+}
+
 END_NS()
 
 BEGIN_SE()
@@ -157,6 +231,27 @@ bool UserVariablePrototype::NeedsRebroadcast(bool server) const
 }
 
 
+void UserVariableKeyDictionary::Reset()
+{
+	ids_.clear();
+}
+
+uint32_t UserVariableKeyDictionary::GetOrAdd(FixedString const& key, bool& isNew)
+{
+	auto id = ids_.try_get(key);
+	if (id) {
+		isNew = false;
+		return *id;
+	}
+
+	// Id 0 is reserved for keys that are sent as strings
+	auto newId = ids_.size() + 1;
+	ids_.set(key, newId);
+	isNew = true;
+	return newId;
+}
+
+
 void UserVariableSyncWriter::Flush(bool force)
 {
 	if (isServer_) {
@@ -177,6 +272,14 @@ void UserVariableSyncWriter::Flush(bool force)
 		}
 	}
 
+	if (snapshotRequested_) {
+		SendSnapshot();
+	}
+
+	if (!batchedSyncs_.empty() && batchDepth_ == 0) {
+		USER_VAR_DBG("Flushing batched syncs");
+		FlushSyncQueue(batchedSyncs_);
+	}
 
 	if (!deferredSyncs_.empty()) {
 		USER_VAR_DBG("Flushing deferred syncs");
@@ -196,28 +299,39 @@ void UserVariableSyncWriter::Clear()
 {
 	deferredSyncs_.clear();
 	nextTickSyncs_.clear();
+	batchedSyncs_.clear();
+	snapshotRequested_ = false;
 	syncMsg_ = nullptr;
 	syncMsgBudget_ = 0;
+	keysGeneration_.reset();
 }
 
 void UserVariableSyncWriter::Sync(Guid const& entity, FixedString const& key, UserVariablePrototype const& proto, UserVariable const* value)
 {
 	if (proto.NeedsSyncFor(isServer_)) {
 		if (value && proto.Has(UserVariableFlags::SyncOnWrite)) {
-			USER_VAR_DBG("Immediate sync var %s/%s", entity.ToString().c_str(), key.GetString());
-			if (MakeSyncMessage()) {
-				AppendToSyncMessage(entity, key, *value);
-				SendSyncs();
+			if (batchDepth_ > 0) {
+				USER_VAR_DBG("Request batched sync for var %s/%s", entity.ToString().c_str(), key.GetString());
+				batchedSyncs_.insert(SyncRequest{
+					.Entity = entity,
+					.Variable = key
+				});
+			} else {
+				USER_VAR_DBG("Immediate sync var %s/%s", entity.ToString().c_str(), key.GetString());
+				if (MakeSyncMessage()) {
+					AppendToSyncMessage(entity, key, *value);
+					SendSyncs();
+				}
 			}
 		} else if (proto.Has(UserVariableFlags::SyncOnTick)) {
 			USER_VAR_DBG("Request next tick sync for var %s/%s", entity.ToString().c_str(), key.GetString());
-			nextTickSyncs_.push_back(SyncRequest{
+			nextTickSyncs_.insert(SyncRequest{
 				.Entity = entity,
 				.Variable = key
 			});
 		} else {
 			USER_VAR_DBG("Request deferred sync for var %s/%s", entity.ToString().c_str(), key.GetString());
-			deferredSyncs_.push_back(SyncRequest{
+			deferredSyncs_.insert(SyncRequest{
 				.Entity = entity,
 				.Variable = key
 			});
@@ -227,12 +341,32 @@ void UserVariableSyncWriter::Sync(Guid const& entity, FixedString const& key, Us
 
 void UserVariableSyncWriter::DeferredSync(Guid const& entity, FixedString const& key)
 {
-	deferredSyncs_.push_back(SyncRequest{
+	deferredSyncs_.insert(SyncRequest{
 		.Entity = entity,
 		.Variable = key
 	});
 }
 
+void UserVariableSyncWriter::RequestSnapshot()
+{
+	snapshotRequested_ = true;
+}
+
+void UserVariableSyncWriter::BeginBatch()
+{
+	batchDepth_++;
+}
+
+void UserVariableSyncWriter::EndBatch()
+{
+	assert(batchDepth_ > 0);
+	if (--batchDepth_ == 0 && !batchedSyncs_.empty()) {
+		USER_VAR_DBG("Flushing batched syncs");
+		FlushSyncQueue(batchedSyncs_);
+		SendSyncs();
+	}
+}
+
 void UserVariableSyncWriter::AppendToSyncMessage(Guid const& entity, FixedString const& key, UserVariable const& value)
 {
 	if (syncMsgBudget_ > SyncMessageBudget) {
@@ -240,7 +374,8 @@ void UserVariableSyncWriter::AppendToSyncMessage(Guid const& entity, FixedString
 		MakeSyncMessage();
 	}
 
-	auto var = syncMsg_->GetMessage().mutable_user_vars()->add_vars();
+	auto userVars = syncMsg_->GetMessage().mutable_user_vars();
+	auto var = userVars->add_vars();
 	switch (varClass_) {
 	case UserVarClass::EntityVar: var->set_type(net::UserVarType::ENTITY_VAR); break;
 	case UserVarClass::ModuleVar: var->set_type(net::UserVarType::MODULE_VAR); break;
@@ -248,16 +383,32 @@ void UserVariableSyncWriter::AppendToSyncMessage(Guid const& entity, FixedString
 	
 	var->set_uuid1(entity.Val[0]);
 	var->set_uuid2(entity.Val[1]);
-	var->set_key(key.GetString());
+
+	if (internKeys_) {
+		bool isNew;
+		auto keyId = keys_.GetOrAdd(key, isNew);
+		if (isNew) {
+			auto keyDef = userVars->add_keys();
+			keyDef->set_id(keyId);
+			keyDef->set_name(key.GetString());
+			syncMsgBudget_ += key.GetLength();
+		}
+
+		var->set_key_id(keyId);
+		syncMsgBudget_ += value.Budget();
+	} else {
+		var->set_key(key.GetString());
+		syncMsgBudget_ += value.Budget() + key.GetLength();
+	}
+
 	value.ToNetMessage(*var);
-	syncMsgBudget_ += value.Budget() + key.GetLength();
 }
 
-void UserVariableSyncWriter::FlushSyncQueue(Array<SyncRequest>& queue)
+void UserVariableSyncWriter::FlushSyncQueue(SyncQueue& queue)
 {
 	if (!MakeSyncMessage()) return;
 
-	for (auto const& req : queue) {
+	for (auto const& req : queue.keys()) {
 		auto value = vars_->Get(req.Entity, req.Variable);
 		if (value && value->Dirty) {
 			USER_VAR_DBG("Flush sync var %s/%s", req.Entity.ToString().c_str(), req.Variable.GetString());
@@ -280,12 +431,42 @@ bool UserVariableSyncWriter::MakeSyncMessage()
 
 		if (syncMsg_) {
 			syncMsg_->GetMessage().mutable_user_vars();
+			PrepareKeyDictionary();
 		}
+	} else if (syncMsg_->GetMessage().user_vars().vars_size() == 0) {
+		// Empty messages aren't sent and are kept for the next flush; a peer may have connected since
+		// the message was prepared, so the key dictionary must be checked again before it's filled
+		PrepareKeyDictionary();
 	}
 
 	return syncMsg_ != nullptr;
 }
 
+void UserVariableSyncWriter::PrepareKeyDictionary()
+{
+	uint32_t generation;
+	if (isServer_) {
+		auto& networkMgr = gExtender->GetServer().GetNetworkManager();
+		auto minVersion = networkMgr.GetMinConnectedPeerVersion();
+		internKeys_ = minVersion && *minVersion >= net::ExtenderMessage::VerInternedUserVarKeys;
+		generation = networkMgr.GetConnectionGeneration();
+	} else {
+		auto& networkMgr = gExtender->GetClient().GetNetworkManager();
+		internKeys_ = networkMgr.GetHostVersion() >= net::ExtenderMessage::VerInternedUserVarKeys;
+		generation = networkMgr.GetConnectionGeneration();
+	}
+
+	auto userVars = syncMsg_->GetMessage().mutable_user_vars();
+	userVars->set_type(varClass_ == UserVarClass::ModuleVar ? net::UserVarType::MODULE_VAR : net::UserVarType::ENTITY_VAR);
+
+	// A peer may have (re)connected since the dictionary was built, resend all keys
+	if (internKeys_ && keysGeneration_ != generation) {
+		keys_.Reset();
+		keysGeneration_ = generation;
+		userVars->set_reset_keys(true);
+	}
+}
+
 void UserVariableSyncWriter::SendSyncs()
 {
 	if (syncMsg_ && syncMsg_->GetMessage().user_vars().vars_size() > 0) {
@@ -302,9 +483,410 @@ void UserVariableSyncWriter::SendSyncs()
 	}
 }
 
+void UserVariableSyncWriter::SendSnapshot()
+{
+	snapshotRequested_ = false;
+
+	auto& networkMgr = gExtender->GetServer().GetNetworkManager();
+	auto minVersion = networkMgr.GetMinConnectedPeerVersion();
+	if (!minVersion) return;
+
+	PackedUserVariableWriter writer;
+	vars_->MakeSnapshot(writer);
+	Vector<uint8_t> image;
+	writer.Write(image);
+
+	if (*minVersion < net::ExtenderMessage::VerUserVarSnapshot) {
+		// Some peers don't understand snapshots; sync each variable separately
+		PackedUserVariableReader reader;
+		if (reader.Load(image.data(), image.size())) {
+			reader.ForEachVariable([this](Guid const& entity, FixedString const& key) {
+				DeferredSync(entity, key);
+			});
+		}
+		return;
+	}
+
+	// The snapshot contains the current value of all queued variables
+	deferredSyncs_.clear();
+	nextTickSyncs_.clear();
+
+	auto snapshotId = nextSnapshotId_++;
+	uint32_t numChunks{ 0 };
+	for (std::size_t offset = 0; offset < image.size(); offset += SnapshotChunkSize) {
+		auto msg = networkMgr.GetFreeMessage();
+		if (msg == nullptr) {
+			OsiErrorS("Failed to get free message");
+			// Clients discard partial snapshots when the next one starts, so it's safe to resend
+			snapshotRequested_ = true;
+			return;
+		}
+
+		auto chunk = msg->GetMessage().mutable_s2c_user_var_snapshot();
+		chunk->set_type(varClass_ == UserVarClass::ModuleVar ? net::UserVarType::MODULE_VAR : net::UserVarType::ENTITY_VAR);
+		chunk->set_snapshot_id(snapshotId);
+		chunk->set_total_size((uint32_t)image.size());
+		chunk->set_offset((uint32_t)offset);
+		chunk->set_data(image.data() + offset, std::min(SnapshotChunkSize, image.size() - offset));
+		networkMgr.BroadcastToConnectedPeers(msg, ReservedUserId, false);
+		numChunks++;
+	}
+
+	DEBUG("Sent user variable snapshot %d to clients (%d bytes in %d chunks)", snapshotId, (uint32_t)image.size(), numChunks);
+}
+
+
+void PackedUserVariableWriter::BeginOwner(Guid const& owner)
+{
+	owners_.push_back(owner);
+	counts_.push_back(0);
+}
+
+void PackedUserVariableWriter::EndOwner()
+{
+	// Don't store owners that have no persistent variables
+	if (!counts_.empty() && *counts_.rbegin() == 0) {
+		owners_.pop_back();
+		counts_.pop_back();
+	}
+}
+
+uint32_t PackedUserVariableWriter::AddString(FixedString const& str)
+{
+	auto index = stringIndices_.try_get(str);
+	if (index) {
+		return *index;
+	}
+
+	auto newIndex = (uint32_t)strings_.size();
+	strings_.push_back(str);
+	stringIndices_.set(str, newIndex);
+	return newIndex;
+}
+
+void PackedUserVariableWriter::Add(FixedString const& name, UserVariable const& value)
+{
+	assert(!counts_.empty());
+	(*counts_.rbegin())++;
+	names_.push_back(AddString(name));
+	types_.push_back((uint8_t)value.Type);
+
+	uint64_t packed{ 0 };
+	switch (value.Type) {
+	case UserVariableType::Int64:
+		packed = (uint64_t)value.Int;
+		break;
+
+	case UserVariableType::Double:
+		memcpy(&packed, &value.Dbl, sizeof(packed));
+		break;
+
+	case UserVariableType::String:
+		packed = AddString(value.Str);
+		break;
+
+	case UserVariableType::Composite:
+		packed = composites_.size();
+		composites_.push_back(value.CompositeStr);
+		break;
+
+	default:
+		break;
+	}
+
+	values_.push_back(packed);
+}
+
+void PackedUserVariableWriter::Write(Vector<uint8_t>& out)
+{
+	out.clear();
+	auto write = [&out](void const* data, std::size_t size) {
+		auto offset = out.size();
+		out.resize(offset + size);
+		if (size > 0) {
+			memcpy(out.data() + offset, data, size);
+		}
+	};
+
+	auto writeU32 = [&write](uint32_t value) {
+		write(&value, sizeof(value));
+	};
+
+	writeU32(PackedUserVariablesFormat::Magic);
+	writeU32(PackedUserVariablesFormat::Version);
+
+	writeU32((uint32_t)strings_.size());
+	for (auto const& str : strings_) {
+		auto sv = str.GetStringView();
+		writeU32((uint32_t)sv.size());
+		write(sv.data(), sv.size());
+	}
+
+	writeU32((uint32_t)composites_.size());
+	for (auto const& str : composites_) {
+		writeU32((uint32_t)str.size());
+		write(str.data(), str.size());
+	}
+
+	writeU32((uint32_t)owners_.size());
+	write(owners_.data(), owners_.size() * sizeof(Guid));
+	write(counts_.data(), counts_.size() * sizeof(uint32_t));
+
+	writeU32((uint32_t)names_.size());
+	write(names_.data(), names_.size() * sizeof(uint32_t));
+	write(types_.data(), types_.size() * sizeof(uint8_t));
+	write(values_.data(), values_.size() * sizeof(uint64_t));
+}
+
+void PackedUserVariableWriter::Write(ScratchBuffer& blob)
+{
+	Vector<uint8_t> out;
+	Write(out);
+
+	blob.Size = out.size();
+	blob.Buffer = GameAllocRaw(out.size());
+	memcpy(blob.Buffer, out.data(), out.size());
+}
+
+// Releases a blob allocated by PackedUserVariableWriter::Write or ObjectVisitor::VisitBuffer
+void FreePackedBlob(ScratchBuffer& blob)
+{
+	if (blob.Buffer != nullptr) {
+		GameFree(blob.Buffer);
+		blob.Buffer = nullptr;
+		blob.Size = 0;
+	}
+}
+
+
+void PackedUserVariableReader::Clear()
+{
+	blob_.clear();
+	strings_.clear();
+	composites_.clear();
+	owners_.clear();
+	numVariables_ = 0;
+	namesOffset_ = typesOffset_ = valuesOffset_ = 0;
+}
+
+bool PackedUserVariableReader::Load(void const* buf, std::size_t size)
+{
+	Clear();
+	blob_.resize(size);
+	if (size > 0) {
+		memcpy(blob_.data(), buf, size);
+	}
+
+	std::size_t pos{ 0 };
+	auto fits = [&](std::size_t bytes) {
+		return bytes <= blob_.size() && pos <= blob_.size() - bytes;
+	};
+
+	auto readU32 = [&](uint32_t& value) {
+		if (!fits(sizeof(value))) return false;
+		memcpy(&value, blob_.data() + pos, sizeof(value));
+		pos += sizeof(value);
+		return true;
+	};
+
+	uint32_t magic, version;
+	if (!readU32(magic) || !readU32(version)
+		|| magic != PackedUserVariablesFormat::Magic
+		|| version > PackedUserVariablesFormat::Version) {
+		ERR("Packed user variable blob has unsupported format");
+		Clear();
+		return false;
+	}
+
+	uint32_t numStrings;
+	if (!readU32(numStrings)) {
+		Clear();
+		return false;
+	}
+
+	strings_.reserve(numStrings);
+	for (uint32_t i = 0; i < numStrings; i++) {
+		uint32_t length;
+		if (!readU32(length) || !fits(length)) {
+			Clear();
+			return false;
+		}
+
+		strings_.push_back(FixedString(StringView((char const*)blob_.data() + pos, length)));
+		pos += length;
+	}
+
+	uint32_t numComposites;
+	if (!readU32(numComposites)) {
+		Clear();
+		return false;
+	}
+
+	composites_.reserve(numComposites);
+	for (uint32_t i = 0; i < numComposites; i++) {
+		uint32_t length;
+		if (!readU32(length) || !fits(length)) {
+			Clear();
+			return false;
+		}
+
+		composites_.push_back(BlobRange{ (uint32_t)pos, length });
+		pos += length;
+	}
+
+	uint32_t numOwners;
+	if (!readU32(numOwners) || !fits((std::size_t)numOwners * (sizeof(Guid) + sizeof(uint32_t)))) {
+		Clear();
+		return false;
+	}
+
+	auto ownersOffset = pos;
+	auto countsOffset = pos + (std::size_t)numOwners * sizeof(Guid);
+	pos = countsOffset + (std::size_t)numOwners * sizeof(uint32_t);
+
+	if (!readU32(numVariables_)
+		|| !fits((std::size_t)numVariables_ * (sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t)))) {
+		Clear();
+		return false;
+	}
+
+	namesOffset_ = pos;
+	typesOffset_ = namesOffset_ + (std::size_t)numVariables_ * sizeof(uint32_t);
+	valuesOffset_ = typesOffset_ + (std::size_t)numVariables_ * sizeof(uint8_t);
+
+	uint32_t firstVariable{ 0 };
+	for (uint32_t i = 0; i < numOwners; i++) {
+		Guid owner;
+		uint32_t count;
+		memcpy(&owner, blob_.data() + ownersOffset + i * sizeof(Guid), sizeof(Guid));
+		memcpy(&count, blob_.data() + countsOffset + i * sizeof(uint32_t), sizeof(uint32_t));
+		if (count > numVariables_ - firstVariable) {
+			ERR("Packed user variable blob is truncated");
+			Clear();
+			return false;
+		}
+
+		owners_.set(owner, OwnerRange{ firstVariable, count });
+		firstVariable += count;
+	}
+
+	return true;
+}
+
+FixedString PackedUserVariableReader::GetName(uint32_t index) const
+{
+	uint32_t nameIndex;
+	memcpy(&nameIndex, blob_.data() + namesOffset_ + index * sizeof(uint32_t), sizeof(nameIndex));
+	return nameIndex < strings_.size() ? strings_[nameIndex] : FixedString{};
+}
+
+std::optional<UserVariable> PackedUserVariableReader::GetValue(uint32_t index) const
+{
+	auto type = (UserVariableType)blob_[typesOffset_ + index];
+	uint64_t packed;
+	memcpy(&packed, blob_.data() + valuesOffset_ + index * sizeof(uint64_t), sizeof(packed));
+
+	UserVariable value;
+	value.Type = type;
+	switch (type) {
+	case UserVariableType::Null:
+		break;
+
+	case UserVariableType::Int64:
+		value.Int = (int64_t)packed;
+		break;
+
+	case UserVariableType::Double:
+		memcpy(&value.Dbl, &packed, sizeof(packed));
+		break;
+
+	case UserVariableType::String:
+		if (packed >= strings_.size()) return {};
+		value.Str = strings_[packed];
+		break;
+
+	case UserVariableType::Composite:
+	{
+		if (packed >= composites_.size()) return {};
+		auto const& range = composites_[packed];
+		value.CompositeStr = STDString((char const*)blob_.data() + range.Offset, range.Length);
+		break;
+	}
+
+	default:
+		return {};
+	}
+
+	return value;
+}
+
+bool PackedUserVariableReader::Decode(Guid const& owner, MultiHashMap<FixedString, UserVariable>& vars)
+{
+	auto range = owners_.try_get(owner);
+	if (range == nullptr) {
+		return false;
+	}
+
+	for (uint32_t i = range->FirstVariable; i < range->FirstVariable + range->NumVariables; i++) {
+		auto name = GetName(i);
+		auto value = GetValue(i);
+		if (!name || !value) {
+			ERR("Failed to decode packed user variable %d of %s", i, owner.ToString().c_str());
+			continue;
+		}
+
+		*vars.add_key(name) = std::move(*value);
+	}
+
+	owners_.remove(owner);
+	if (owners_.empty()) {
+		// All owners were decoded, release the blob
+		Clear();
+	}
+
+	return true;
+}
+
+Array<Guid> PackedUserVariableReader::GetPendingOwners() const
+{
+	Array<Guid> owners;
+	for (auto const& owner : owners_) {
+		owners.push_back(owner.Key());
+	}
+
+	return owners;
+}
+
+void UserVariableManager::Unpack(Guid const& entity)
+{
+	if (!packed_.IsPending(entity)) return;
+
+	auto vars = vars_.try_get(entity);
+	if (!vars) {
+		vars = vars_.set(entity, EntityVariables{});
+	}
+
+	packed_.Decode(entity, vars->Vars);
+	for (auto& kv : vars->Vars) {
+		auto proto = GetPrototype(kv.Key());
+		if (proto && proto->NeedsSyncFor(isServer_)) {
+			kv.Value().Dirty = true;
+		}
+	}
+}
+
+void UserVariableManager::UnpackAll()
+{
+	if (packed_.IsEmpty()) return;
+
+	for (auto const& entity : packed_.GetPendingOwners()) {
+		Unpack(entity);
+	}
+}
 
 UserVariable* UserVariableManager::Get(Guid const& entity, FixedString const& key)
 {
+	Unpack(entity);
 	auto vars = vars_.try_get(entity);
 	if (vars) {
 		return vars->Vars.try_get(key);
@@ -315,6 +897,7 @@ UserVariable* UserVariableManager::Get(Guid const& entity, FixedString const& ke
 
 MultiHashMap<FixedString, UserVariable>* UserVariableManager::GetAll(Guid const& entity)
 {
+	Unpack(entity);
 	auto vars = vars_.try_get(entity);
 	if (vars) {
 		return &vars->Vars;
@@ -325,9 +908,97 @@ MultiHashMap<FixedString, UserVariable>* UserVariableManager::GetAll(Guid const&
 
 MultiHashMap<Guid, UserVariableManager::EntityVariables>& UserVariableManager::GetAll()
 {
+	UnpackAll();
 	return vars_;
 }
 
+void UserVariableManager::MakeSnapshot(PackedUserVariableWriter& writer)
+{
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	for (auto& entity : vars_) {
+		writer.BeginOwner(entity.Key());
+		for (auto& kv : entity.Value().Vars) {
+			auto proto = GetPrototype(kv.Key());
+			if (proto && proto->NeedsSyncFor(isServer_)) {
+				writer.Add(kv.Key(), kv.Value());
+			}
+		}
+		writer.EndOwner();
+	}
+
+	// Variables from the savegame are copied without decoding the entity
+	std::optional<Guid> owner;
+	packed_.ForEachValue([&](Guid const& entity, FixedString const& name, UserVariable const& value) {
+		auto proto = GetPrototype(name);
+		if (!proto || !proto->NeedsSyncFor(isServer_)) return;
+
+		if (owner != entity) {
+			if (owner) writer.EndOwner();
+			writer.BeginOwner(entity);
+			owner = entity;
+		}
+
+		writer.Add(name, value);
+	});
+
+	if (owner) {
+		writer.EndOwner();
+	}
+}
+
+void UserVariableManager::ApplySnapshot(PackedUserVariableReader& reader)
+{
+	// Pending cached writes are flushed first, as the cache is discarded after applying the snapshot
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	MultiHashMap<FixedString, UserVariable> snapshotVars;
+	uint32_t numVars{ 0 };
+	for (auto const& entityGuid : reader.GetPendingOwners()) {
+		snapshotVars.clear();
+		reader.Decode(entityGuid, snapshotVars);
+		if (!GuidToEntity(entityGuid)) continue;
+
+		auto entityVars = vars_.try_get(entityGuid);
+		if (!entityVars) {
+			entityVars = vars_.set(entityGuid, EntityVariables{});
+		}
+
+		for (auto& kv : snapshotVars) {
+			auto proto = GetPrototype(kv.Key());
+			if (!proto) {
+				ERR("Tried to sync variable '%s' that has no prototype!", kv.Key().GetString());
+				continue;
+			}
+
+			if (!proto->NeedsSyncFor(!isServer_)) {
+				ERR("Tried to sync variable '%s' in illegal direction!", kv.Key().GetString());
+				continue;
+			}
+
+			kv.Value().Dirty = proto->NeedsRebroadcast(isServer_);
+			auto var = entityVars->Vars.try_get(kv.Key());
+			if (var) {
+				*var = std::move(kv.Value());
+			} else {
+				entityVars->Vars.set(kv.Key(), std::move(kv.Value()));
+			}
+			numVars++;
+		}
+	}
+
+	// Invalidate the whole cache once instead of each variable separately
+	if (cache_) {
+		cache_->Invalidate();
+	}
+
+	DEBUG("Applied %d user variables from server snapshot", numVars);
+}
+
 void UserVariableManager::MarkDirty(Guid const& entity, FixedString const& key, UserVariable& value)
 {
 	auto proto = GetPrototype(key);
@@ -339,6 +1010,9 @@ void UserVariableManager::MarkDirty(Guid const& entity, FixedString const& key,
 
 UserVariableManager::EntityVariables* UserVariableManager::Set(Guid const& entity, FixedString const& key, UserVariablePrototype const& proto, UserVariable&& value)
 {
+	// Variables from the savegame must be decoded first, otherwise they'd overwrite the new value later
+	Unpack(entity);
+
 	if (value.Dirty) {
 		sync_.Sync(entity, key, proto, &value);
 	}
@@ -384,7 +1058,89 @@ void UserVariableManager::RegisterPrototype(FixedString const& key, UserVariable
 	prototypes_.set(key, proto);
 }
 
-void UserVariableManager::SavegameVisit(ObjectVisitor* visitor)
+void UserVariableManager::SavegameVisit(ObjectVisitor* visitor, uint32_t version)
+{
+	if (visitor->IsReading()) {
+		vars_.clear();
+		packed_.Clear();
+
+		if (version < SavegameVerPackedUserVars) {
+			LegacySavegameVisit(visitor);
+			return;
+		}
+	}
+
+	if (visitor->EnterNode(GFS.strUserVariables, GFS.strEmpty)) {
+		ScratchBuffer blob;
+		if (visitor->IsReading()) {
+			visitor->VisitBuffer(GFS.strBlob, blob);
+			if (!LoadPacked(blob.Buffer, blob.Size)) {
+				ERR("Failed to load user variables from savegame!");
+			}
+		} else {
+			PackedUserVariableWriter writer;
+			Pack(writer);
+			writer.Write(blob);
+			visitor->VisitBuffer(GFS.strBlob, blob);
+		}
+
+		FreePackedBlob(blob);
+		visitor->ExitNode(GFS.strUserVariables);
+	}
+}
+
+void UserVariableManager::Pack(PackedUserVariableWriter& writer)
+{
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	for (auto& entity : vars_) {
+		writer.BeginOwner(entity.Key());
+		for (auto& kv : entity.Value().Vars) {
+			auto proto = GetPrototype(kv.Key());
+			if (proto && proto->Has(UserVariableFlags::Persistent)) {
+				USER_VAR_DBG("Savegame persist var %s/%s", entity.Key().ToString().c_str(), kv.Key().GetString());
+				writer.Add(kv.Key(), kv.Value());
+			}
+		}
+		writer.EndOwner();
+	}
+
+	// Variables that weren't accessed since the savegame was loaded are copied without decoding the entity
+	std::optional<Guid> owner;
+	packed_.ForEachValue([&](Guid const& entity, FixedString const& name, UserVariable const& value) {
+		auto proto = GetPrototype(name);
+		if (!proto || !proto->Has(UserVariableFlags::Persistent)) return;
+
+		if (owner != entity) {
+			if (owner) writer.EndOwner();
+			writer.BeginOwner(entity);
+			owner = entity;
+		}
+
+		writer.Add(name, value);
+	});
+
+	if (owner) {
+		writer.EndOwner();
+	}
+}
+
+bool UserVariableManager::LoadPacked(void const* buf, std::size_t size)
+{
+	vars_.clear();
+	if (!packed_.Load(buf, size)) {
+		return false;
+	}
+
+	// Values are decoded when the entity is first accessed
+	sync_.RequestSnapshot();
+	return true;
+}
+
+// Reads user variables from savegames that predate the packed format
+void UserVariableManager::LegacySavegameVisit(ObjectVisitor* visitor)
 {
 	if (visitor->IsReading()) {
 		vars_.clear();
@@ -417,9 +1173,7 @@ void UserVariableManager::SavegameVisit(ObjectVisitor* visitor)
 
 							auto proto = GetPrototype(name);
 							if (proto && proto->NeedsSyncFor(isServer_)) {
-								USER_VAR_DBG("Request deferred sync for var %s/%s", entity.ToString().c_str(), name.GetString());
 								var->Dirty = true;
-								sync_.DeferredSync(entity, name);
 							}
 						}
 					}
@@ -427,9 +1181,11 @@ void UserVariableManager::SavegameVisit(ObjectVisitor* visitor)
 					visitor->ExitNode(GFS.strEntityVariables);
 				}
 			}
+
+			sync_.RequestSnapshot();
 		} else {
 			if (cache_) {
-				cache_->Flush();
+				cache_->Flush(true);
 			}
 
 			for (auto& entity : vars_) {
@@ -457,25 +1213,24 @@ void UserVariableManager::SavegameVisit(ObjectVisitor* visitor)
 	}
 }
 
-void UserVariableManager::NetworkSync(net::UserVar const& var)
+void UserVariableManager::NetworkSync(net::UserVar const& var, FixedString const& key)
 {
 	Guid entityGuid;
 	entityGuid.Val[0] = var.uuid1();
 	entityGuid.Val[1] = var.uuid2();
 
-	USER_VAR_DBG("Received sync for %d/%s/%s", var.type(), entityGuid.ToString().c_str(), var.key().c_str());
+	USER_VAR_DBG("Received sync for %d/%s/%s", var.type(), entityGuid.ToString().c_str(), key.GetString());
 	auto entity = GuidToEntity(entityGuid);
 	if (!entity) return;
 
-	FixedString key(var.key());
 	auto proto = GetPrototype(key);
 	if (!proto) {
-		ERR("Tried to sync variable '%s' that has no prototype!", var.key().c_str());
+		ERR("Tried to sync variable '%s' that has no prototype!", key.GetString());
 		return;
 	}
 	
 	if (!proto->NeedsSyncFor(!isServer_)) {
-		ERR("Tried to sync variable '%s' in illegal direction!", var.key().c_str());
+		ERR("Tried to sync variable '%s' in illegal direction!", key.GetString());
 		return;
 	}
 
@@ -542,6 +1297,30 @@ UserVariable* ModVariableMap::Set(FixedString const& key, UserVariablePrototype
 	return var;
 }
 
+void ModVariableMap::Pack(PackedUserVariableWriter& writer)
+{
+	writer.BeginOwner(moduleUuid_);
+	for (auto& kv : vars_) {
+		auto proto = GetPrototype(kv.Key());
+		if (proto && proto->Has(UserVariableFlags::Persistent)) {
+			USER_VAR_DBG("Savegame persist var %s/%s", moduleUuid_.ToString().c_str(), kv.Key().GetString());
+			writer.Add(kv.Key(), kv.Value());
+		}
+	}
+	writer.EndOwner();
+}
+
+void ModVariableMap::Unpack(PackedUserVariableReader& reader)
+{
+	reader.Decode(moduleUuid_, vars_);
+	for (auto& kv : vars_) {
+		auto proto = GetPrototype(kv.Key());
+		if (proto && proto->NeedsSyncFor(isServer_)) {
+			kv.Value().Dirty = true;
+		}
+	}
+}
+
 UserVariablePrototype const* ModVariableMap::GetPrototype(FixedString const& key) const
 {
 	return prototypes_.try_get(key);
@@ -571,7 +1350,6 @@ void ModVariableMap::SavegameVisit(ObjectVisitor* visitor)
 
 				auto proto = GetPrototype(name);
 				if (proto && proto->NeedsSyncFor(isServer_)) {
-					USER_VAR_DBG("Request deferred sync for var %s/%s", moduleUuid_.ToString().c_str(), name.GetString());
 					var->Dirty = true;
 				}
 			}
@@ -631,6 +1409,68 @@ MultiHashMap<Guid, ModVariableMap>& ModVariableManager::GetAll()
 	return vars_;
 }
 
+void ModVariableManager::MakeSnapshot(PackedUserVariableWriter& writer)
+{
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	for (auto& mod : vars_) {
+		writer.BeginOwner(mod.Key());
+		for (auto& kv : mod.Value().GetAll()) {
+			auto proto = mod.Value().GetPrototype(kv.Key());
+			if (proto && proto->NeedsSyncFor(isServer_)) {
+				writer.Add(kv.Key(), kv.Value());
+			}
+		}
+		writer.EndOwner();
+	}
+}
+
+void ModVariableManager::ApplySnapshot(PackedUserVariableReader& reader)
+{
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	ModVariableMap::VariableMap snapshotVars;
+	uint32_t numVars{ 0 };
+	for (auto const& modUuid : reader.GetPendingOwners()) {
+		snapshotVars.clear();
+		reader.Decode(modUuid, snapshotVars);
+
+		auto map = GetMod(modUuid);
+		if (!map) {
+			ERR("Tried to sync variable for nonexistent mod '%s'!", modUuid.ToString().c_str());
+			continue;
+		}
+
+		for (auto& kv : snapshotVars) {
+			auto proto = map->GetPrototype(kv.Key());
+			if (!proto) {
+				ERR("Tried to sync variable %s/%s that has no prototype!", modUuid.ToString().c_str(), kv.Key().GetString());
+				continue;
+			}
+
+			if (!proto->NeedsSyncFor(!isServer_)) {
+				ERR("Tried to sync variable %s/%s in illegal direction!", modUuid.ToString().c_str(), kv.Key().GetString());
+				continue;
+			}
+
+			kv.Value().Dirty = proto->NeedsRebroadcast(isServer_);
+			map->Set(kv.Key(), *proto, std::move(kv.Value()));
+			numVars++;
+		}
+	}
+
+	// Invalidate the whole cache once instead of each variable separately
+	if (cache_) {
+		cache_->Invalidate();
+	}
+
+	DEBUG("Applied %d mod variables from server snapshot", numVars);
+}
+
 ModVariableMap* ModVariableManager::GetMod(Guid const& modUuid)
 {
 	return vars_.try_get(modUuid);
@@ -716,7 +1556,70 @@ void ModVariableManager::RegisterPrototype(Guid const& modUuid, FixedString cons
 	GetOrCreateMod(modUuid)->RegisterPrototype(key, proto);
 }
 
-void ModVariableManager::SavegameVisit(ObjectVisitor* visitor)
+void ModVariableManager::SavegameVisit(ObjectVisitor* visitor, uint32_t version)
+{
+	if (visitor->IsReading() && version < SavegameVerPackedUserVars) {
+		LegacySavegameVisit(visitor);
+		return;
+	}
+
+	if (visitor->IsReading()) {
+		for (auto& mod : vars_) {
+			mod.Value().ClearVars();
+		}
+	}
+
+	if (visitor->EnterNode(GFS.strModVariables, GFS.strEmpty)) {
+		ScratchBuffer blob;
+		if (visitor->IsReading()) {
+			visitor->VisitBuffer(GFS.strBlob, blob);
+			if (!LoadPacked(blob.Buffer, blob.Size)) {
+				ERR("Failed to load mod variables from savegame!");
+			}
+		} else {
+			PackedUserVariableWriter writer;
+			Pack(writer);
+			writer.Write(blob);
+			visitor->VisitBuffer(GFS.strBlob, blob);
+		}
+
+		FreePackedBlob(blob);
+		visitor->ExitNode(GFS.strModVariables);
+	}
+}
+
+void ModVariableManager::Pack(PackedUserVariableWriter& writer)
+{
+	if (cache_) {
+		cache_->Flush(true);
+	}
+
+	for (auto& mod : vars_) {
+		mod.Value().Pack(writer);
+	}
+}
+
+bool ModVariableManager::LoadPacked(void const* buf, std::size_t size)
+{
+	for (auto& mod : vars_) {
+		mod.Value().ClearVars();
+	}
+
+	PackedUserVariableReader reader;
+	if (!reader.Load(buf, size)) {
+		return false;
+	}
+
+	for (auto const& modUuid : reader.GetPendingOwners()) {
+		GetOrCreateMod(modUuid)->Unpack(reader);
+	}
+
+	sync_.RequestSnapshot();
+	return true;
+}
+
+// Reads mod variables from savegames that predate the packed format
+void ModVariableManager::LegacySavegameVisit(ObjectVisitor* visitor)
 {
 	if (visitor->IsReading()) {
 		for (auto& mod : vars_) {
@@ -734,19 +1637,15 @@ void ModVariableManager::SavegameVisit(ObjectVisitor* visitor)
 				if (visitor->EnterNode(GFS.strModVariables, GFS.strModule)) {
 					Guid modUuid;
 					visitor->VisitGuid(GFS.strModule, modUuid, Guid::Null);
-					auto mod = GetOrCreateMod(modUuid);
-					mod->SavegameVisit(visitor);
-					for (auto const& kv : mod->GetAll()) {
-						if (kv.Value().Dirty) {
-							sync_.DeferredSync(modUuid, kv.Key());
-						}
-					}
+					GetOrCreateMod(modUuid)->SavegameVisit(visitor);
 					visitor->ExitNode(GFS.strModVariables);
 				}
 			}
+
+			sync_.RequestSnapshot();
 		} else {
 			if (cache_) {
-				cache_->Flush();
+				cache_->Flush(true);
 			}
 
 			for (auto& mod : vars_) {
@@ -762,13 +1661,13 @@ void ModVariableManager::SavegameVisit(ObjectVisitor* visitor)
 	}
 }
 
-void ModVariableManager::NetworkSync(net::UserVar const& var)
+void ModVariableManager::NetworkSync(net::UserVar const& var, FixedString const& key)
 {
 	Guid modUuid;
 	modUuid.Val[0] = var.uuid1();
 	modUuid.Val[1] = var.uuid2();
 
-	USER_VAR_DBG("Received sync for %s/%s", modUuid.ToString().c_str(), var.key().c_str());
+	USER_VAR_DBG("Received sync for %s/%s", modUuid.ToString().c_str(), key.GetString());
 
 	auto map = GetMod(modUuid);
 	if (!map) {
@@ -776,15 +1675,14 @@ void ModVariableManager::NetworkSync(net::UserVar const& var)
 		return;
 	}
 
-	FixedString key(var.key());
 	auto proto = map->GetPrototype(key);
 	if (!proto) {
-		ERR("Tried to sync variable %s/%s that has no prototype!", modUuid.ToString().c_str(), var.key().c_str());
+		ERR("Tried to sync variable %s/%s that has no prototype!", modUuid.ToString().c_str(), key.GetString());
 		return;
 	}
 
 	if (!proto->NeedsSyncFor(!isServer_)) {
-		ERR("Tried to sync variable %s/%s in illegal direction!", modUuid.ToString().c_str(), var.key().c_str());
+		ERR("Tried to sync variable %s/%s in illegal direction!", modUuid.ToString().c_str(), key.GetString());
 		return;
 	}
 
@@ -1093,7 +1991,8 @@ CachedUserVariable* CachedUserVariableManager::PutCache(EntityHandle entity, Fix
 
 	if (!wasDirty && var->Dirty) {
 		USER_VAR_DBG("Mark cached var for flush %s/%s", vars->CachedGuid.ToString().c_str(), key.GetString());
-		flushQueue_.push_back(FlushRequest{
+		auto& queue = proto.NeedsSyncFor(isServer_) ? flushQueue_ : deferredFlushQueue_;
+		queue.push_back(FlushRequest{
 			.Entity = entity,
 			.Variable = key,
 			.Proto = &proto
@@ -1200,6 +2099,7 @@ void CachedUserVariableManager::Invalidate()
 {
 	vars_.clear();
 	flushQueue_.clear();
+	deferredFlushQueue_.clear();
 }
 
 void CachedUserVariableManager::Invalidate(EntityHandle entity, FixedString const& key)
@@ -1212,25 +2112,53 @@ void CachedUserVariableManager::Invalidate(EntityHandle entity, FixedString cons
 	}
 }
 
-void CachedUserVariableManager::Flush()
+void CachedUserVariableManager::Flush(bool force)
 {
 	LuaVirtualPin lua;
 
 	if (lua) {
-		for (auto const& req : flushQueue_) {
-			Guid entityGuid;
-			auto var = GetFromCache(req.Entity, req.Variable, entityGuid);
-			if (var && var->Dirty) {
-				USER_VAR_DBG("Flush cached var %016llx/%s", req.Entity.Handle, req.Variable.GetString());
-				auto userVar = var->ToUserVariable(lua->GetState());
-				userVar.Dirty = true;
-				global_.Set(entityGuid, req.Variable, *req.Proto, std::move(userVar));
-				var->Dirty = false;
+		Flush(lua->GetState(), force);
+	}
+}
+
+void CachedUserVariableManager::Flush(lua_State* L, bool force)
+{
+	if (force) {
+		FlushQueue(L, flushQueue_, 0);
+		FlushQueue(L, deferredFlushQueue_, 0);
+	} else {
+		FlushQueue(L, flushQueue_, CachedVariableFlushBudgetUs);
+	}
+}
+
+void CachedUserVariableManager::FlushQueue(lua_State* L, Array<FlushRequest>& queue, uint64_t budgetUs)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	uint32_t flushed{ 0 };
+	while (flushed < queue.size()) {
+		auto const& req = queue[flushed++];
+		Guid entityGuid;
+		auto var = GetFromCache(req.Entity, req.Variable, entityGuid);
+		if (var && var->Dirty) {
+			USER_VAR_DBG("Flush cached var %016llx/%s", req.Entity.Handle, req.Variable.GetString());
+			auto userVar = var->ToUserVariable(L);
+			userVar.Dirty = true;
+			global_.Set(entityGuid, req.Variable, *req.Proto, std::move(userVar));
+			var->Dirty = false;
+
+			if (budgetUs != 0
+				&& (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() >= budgetUs) {
+				break;
 			}
 		}
+	}
 
-		flushQueue_.clear();
+	// Carry the remaining requests over to the next flush; they're still marked as dirty, so they won't be queued again
+	for (uint32_t i = flushed; i < queue.size(); i++) {
+		queue[i - flushed] = queue[i];
 	}
+
+	queue.resize(queue.size() - flushed);
 }
 
 
@@ -1311,7 +2239,8 @@ CachedUserVariable* CachedModVariableManager::PutCache(uint32_t modIndex, FixedS
 
 	if (!wasDirty && var->Dirty) {
 		USER_VAR_DBG("Mark cached mod var for flush %s/%s", vars->CachedGuid.ToString().c_str(), key.GetString());
-		flushQueue_.push_back(FlushRequest{
+		auto& queue = proto.NeedsSyncFor(isServer_) ? flushQueue_ : deferredFlushQueue_;
+		queue.push_back(FlushRequest{
 			.ModIndex = modIndex,
 			.Variable = key,
 			.Proto = &proto
@@ -1409,6 +2338,7 @@ void CachedModVariableManager::Invalidate()
 {
 	vars_.clear();
 	flushQueue_.clear();
+	deferredFlushQueue_.clear();
 }
 
 void CachedModVariableManager::Invalidate(uint32_t modIndex, FixedString const& key)
@@ -1421,25 +2351,53 @@ void CachedModVariableManager::Invalidate(uint32_t modIndex, FixedString const&
 	}
 }
 
-void CachedModVariableManager::Flush()
+void CachedModVariableManager::Flush(bool force)
 {
 	LuaVirtualPin lua;
 
 	if (lua) {
-		for (auto const& req : flushQueue_) {
-			Guid modUuid;
-			auto var = GetFromCache(req.ModIndex, req.Variable, modUuid);
-			if (var && var->Dirty) {
-				USER_VAR_DBG("Flush cached mod var %d/%s", req.ModIndex, req.Variable.GetString());
-				auto userVar = var->ToUserVariable(lua->GetState());
-				userVar.Dirty = true;
-				global_.Set(modUuid, req.Variable, *req.Proto, std::move(userVar));
-				var->Dirty = false;
+		Flush(lua->GetState(), force);
+	}
+}
+
+void CachedModVariableManager::Flush(lua_State* L, bool force)
+{
+	if (force) {
+		FlushQueue(L, flushQueue_, 0);
+		FlushQueue(L, deferredFlushQueue_, 0);
+	} else {
+		FlushQueue(L, flushQueue_, CachedVariableFlushBudgetUs);
+	}
+}
+
+void CachedModVariableManager::FlushQueue(lua_State* L, Array<FlushRequest>& queue, uint64_t budgetUs)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	uint32_t flushed{ 0 };
+	while (flushed < queue.size()) {
+		auto const& req = queue[flushed++];
+		Guid modUuid;
+		auto var = GetFromCache(req.ModIndex, req.Variable, modUuid);
+		if (var && var->Dirty) {
+			USER_VAR_DBG("Flush cached mod var %d/%s", req.ModIndex, req.Variable.GetString());
+			auto userVar = var->ToUserVariable(L);
+			userVar.Dirty = true;
+			global_.Set(modUuid, req.Variable, *req.Proto, std::move(userVar));
+			var->Dirty = false;
+
+			if (budgetUs != 0
+				&& (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() >= budgetUs) {
+				break;
 			}
 		}
+	}
 
-		flushQueue_.clear();
+	// Carry the remaining requests over to the next flush
+	for (uint32_t i = flushed; i < queue.size(); i++) {
+		queue[i - flushed] = queue[i];
 	}
+
+	queue.resize(queue.size() - flushed);
 }
 
 END_NS()
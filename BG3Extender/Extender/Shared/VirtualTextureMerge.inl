@@ -100,7 +100,9 @@ STDWString FourCCNode::ReadString(uint32_t tag)
 struct GTSFile
 {
 	FixedString Path;
-	Array<uint8_t> Buf;
+	// Keeps the file contents alive; the tile set is parsed in place from the reader buffer
+	std::optional<FileReaderPin> Reader;
+	std::span<uint8_t> Buf;
 
 	GTSHeader* Header;
 	std::span<GTSTileSetLayer> Layers;
@@ -120,7 +122,12 @@ struct GTSFile
 
 	bool ReadHeader(char const*& reason)
 	{
-		auto buf = Buf.raw_buf();
+		if (Buf.size() < sizeof(GTSHeader)) {
+			reason = "File too small";
+			return false;
+		}
+
+		auto buf = Buf.data();
 		Header = reinterpret_cast<GTSHeader*>(buf);
 		if (Header->Magic != GTSHeader::GRPGMagic || Header->CurrentVersion != GTSHeader::CurrentVersion) {
 			reason = "Incorrect GTS magic number or version";
@@ -162,7 +169,7 @@ struct GTSFile
 
 	bool ReadMetadata(char const*& reason)
 	{
-		auto buf = Buf.raw_buf();
+		auto buf = Buf.data();
 		Layers = std::span<GTSTileSetLayer>(reinterpret_cast<GTSTileSetLayer*>(buf + Header->LayersOffset), Header->NumLayers);
 		Levels = std::span<GTSTileSetLevel>(reinterpret_cast<GTSTileSetLevel*>(buf + Header->LevelsOffset), Header->NumLevels);
 		PerLevelFlatTileIndices.resize(Header->NumLevels);
@@ -209,7 +216,7 @@ struct GTSFile
 
 	bool ReadTiles(char const*& reason)
 	{
-		auto buf = Buf.raw_buf();
+		auto buf = Buf.data();
 		PageFiles = std::span<GTSPageFileInfo>(reinterpret_cast<GTSPageFileInfo*>(buf + Header->PageFileMetadataOffset), Header->NumPageFiles);
 		PackedTileIDs = std::span<GTSPackedTileID>(reinterpret_cast<GTSPackedTileID*>(buf + Header->PackedTileIDsOffset), Header->NumPackedTileIDs);
 		FlatTileInfos = std::span<GTSFlatTileInfo>(reinterpret_cast<GTSFlatTileInfo*>(buf + Header->FlatTileInfoOffset), Header->NumFlatTileInfos);
@@ -241,7 +248,7 @@ struct GTSFile
 
 	bool ReadFourCC(char const*& reason)
 	{
-		auto buf = Buf.raw_buf();
+		auto buf = Buf.data();
 		FourCC = FourCCNode(reinterpret_cast<GTSFourCCMetadata*>(buf + Header->FourCCListOffset), Header->FourCCListSize);
 
 		auto meta = FourCC.Enter('META');
@@ -283,131 +290,174 @@ struct GTSFile
 };
 
 
+// Packs tile sets into the merged tile set using a skyline bottom-left packer.
+// Tile sets are placed in a fixed order (largest first, ties broken by path), and the
+// smallest bin among the candidate widths is chosen, so the layout is deterministic for a given input set.
 class MergedTileSetGeometryCalculator
 {
 public:
-    Array<GTSFile*> TileSets;
+	// Maximum size of the merged tile set, in tiles
+	static constexpr uint32_t MaxMergedSize = 0x1000;
 
-    uint32_t PlacementTileWidth = 0x1000;
-    uint32_t PlacementTileHeight = 0x1000;
-	uint32_t PlacementGridWidth{ 0 };
-	uint32_t PlacementGridHeight{ 0 };
-    Array<GTSFile*> PlacementGrid;
+	Array<GTSFile*> TileSets;
 
 	uint32_t TotalWidth{ 0 };
 	uint32_t TotalHeight{ 0 };
-	uint32_t NextPageFileOffset{ 0 };
-
-    void ResizePlacementGrid(uint32_t w, uint32_t h)
-    {
-        PlacementGridWidth = w;
-        PlacementGridHeight = h;
-        PlacementGrid.resize(w * h);
-		std::fill(PlacementGrid.begin(), PlacementGrid.end(), nullptr);
-		NextPageFileOffset = 0;
-    }
-
-    bool GrowPlacementGrid()
-    {
-		auto w = PlacementGridWidth * PlacementTileWidth;
-		auto h = PlacementGridHeight * PlacementTileHeight;
-
-		if (w >= 0x1000 || h >= 0x1000) {
+	// Number of tiles covered by tile sets
+	uint64_t UsedArea{ 0 };
+
+	// Percentage of the merged tile set that is covered by tile sets
+	float Occupancy() const
+	{
+		auto total = (uint64_t)TotalWidth * TotalHeight;
+		return total ? (float)(UsedArea * 100.0 / total) : 0.0f;
+	}
+
+	bool DoAutoPlacement()
+	{
+		if (TileSets.empty()) {
 			return false;
 		}
 
-        if (w <= h) {
-            ResizePlacementGrid(PlacementGridWidth * 2, PlacementGridHeight);
-        } else {
-            ResizePlacementGrid(PlacementGridWidth, PlacementGridHeight * 2);
-        }
+		Array<Item> items;
+		uint32_t maxWidth{ 0 };
+		UsedArea = 0;
+		for (auto tileSet : TileSets) {
+			Item item;
+			item.TileSet = tileSet;
+			item.Width = tileSet->Levels[0].Width;
+			item.Height = tileSet->Levels[0].Height;
+			// Mip level N of the tile set is placed at (X >> N, Y >> N), so the position
+			// must be aligned to the size of the smallest mip
+			item.Alignment = 1u << (tileSet->Levels.size() - 1);
+			item.Width = AlignUp(item.Width, item.Alignment);
+			item.Height = AlignUp(item.Height, item.Alignment);
+			maxWidth = std::max(maxWidth, item.Width);
+			UsedArea += (uint64_t)tileSet->Levels[0].Width * tileSet->Levels[0].Height;
+			items.push_back(item);
+		}
+
+		std::sort(items.begin(), items.end(), [](Item const& a, Item const& b) {
+			if (a.Height != b.Height) return a.Height > b.Height;
+			if (a.Width != b.Width) return a.Width > b.Width;
+			return a.TileSet->Path.GetStringView() < b.TileSet->Path.GetStringView();
+		});
+
+		std::optional<Layout> best;
+		for (auto width = maxWidth; width <= MaxMergedSize; width = NextCandidateWidth(width)) {
+			auto layout = Pack(items, width);
+			if (layout && (!best || IsBetterLayout(*layout, *best))) {
+				best = std::move(layout);
+			}
+		}
+
+		if (!best) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < items.size(); i++) {
+			items[i].TileSet->MergedX = best->Positions[i].first;
+			items[i].TileSet->MergedY = best->Positions[i].second;
+		}
+
+		// Page files are appended in tile set order when stitching
+		uint32_t nextPageFileOffset{ 0 };
+		for (auto tileSet : TileSets) {
+			tileSet->PageFileOffset = nextPageFileOffset;
+			nextPageFileOffset += (uint32_t)tileSet->PageFiles.size();
+		}
 
+		TotalWidth = best->Width;
+		TotalHeight = best->Height;
 		return true;
-    }
-
-    bool TryToPlaceTileSet(GTSFile* tileSet, uint32_t tileSetX, uint32_t tileSetY)
-    {
-        auto width = tileSet->Levels[0].Width / PlacementTileWidth;
-        auto height = tileSet->Levels[0].Height / PlacementTileHeight;
-
-        for (auto y = tileSetY; y < tileSetY + height; y++) {
-            for (auto x = tileSetX; x < tileSetX + width; x++) {
-                if (PlacementGrid[x + y * PlacementGridWidth] != nullptr) {
-                    return false;
-                }
-            }
-        }
-
-        tileSet->MergedX = tileSetX * PlacementTileWidth;
-        tileSet->MergedY = tileSetY * PlacementTileHeight;
-
-		tileSet->PageFileOffset = NextPageFileOffset;
-		NextPageFileOffset += (uint32_t)tileSet->PageFiles.size();
-
-        for (auto y = tileSetY; y < tileSetY + height; y++) {
-            for (auto x = tileSetX; x < tileSetX + width; x++) {
-                PlacementGrid[x + y * PlacementGridWidth] = tileSet;
-            }
-        }
-
-        return true;
-    }
-
-    bool TryToPlaceTileSet(GTSFile* tileSet)
-    {
-        auto width = tileSet->Levels[0].Width / PlacementTileWidth;
-        auto height = tileSet->Levels[0].Height / PlacementTileHeight;
-
-        for (uint32_t y = 0; y < PlacementGridHeight - height + 1; y++) {
-            for (uint32_t x = 0; x < PlacementGridWidth - width + 1; x++) {
-                if (TryToPlaceTileSet(tileSet, x, y)) {
-                    return true;
-                }
-            }
-        }
-
-        return false;
-    }
-
-    bool PlaceAllTileSets()
-    {
-        for (auto tileSet : TileSets) {
-            if (!TryToPlaceTileSet(tileSet)) {
-                return false;
-            }
-        }
-
-        return true;
-    }
-
-    bool DoAutoPlacement()
-    {
-        uint32_t startingX = 0;
-        uint32_t startingY = 0;
-
-        for (auto tileSet : TileSets) {
-            PlacementTileWidth = std::min(PlacementTileWidth, tileSet->Levels[0].Width);
-            PlacementTileHeight = std::min(PlacementTileHeight, tileSet->Levels[0].Height);
-            startingX = std::max(startingX, tileSet->Levels[0].Width);
-            startingY = std::max(startingY, tileSet->Levels[0].Height);
-        }
-
-        ResizePlacementGrid(
-			std::max(1u, startingX / PlacementTileWidth), 
-			std::max(1u, startingY / PlacementTileHeight)
-		);
-
-        while (!PlaceAllTileSets())
-        {
-			if (!GrowPlacementGrid()) {
-				return false;
+	}
+
+private:
+	struct Item
+	{
+		GTSFile* TileSet;
+		uint32_t Width;
+		uint32_t Height;
+		uint32_t Alignment;
+	};
+
+	struct Layout
+	{
+		uint32_t Width;
+		uint32_t Height;
+		Array<std::pair<uint32_t, uint32_t>> Positions;
+	};
+
+	static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	static uint32_t NextCandidateWidth(uint32_t width)
+	{
+		// Try the widest tile set first, then every power of two above it
+		uint32_t pow2 = 1;
+		while (pow2 <= width) pow2 <<= 1;
+		return pow2;
+	}
+
+	static bool IsBetterLayout(Layout const& a, Layout const& b)
+	{
+		auto areaA = (uint64_t)a.Width * a.Height;
+		auto areaB = (uint64_t)b.Width * b.Height;
+		if (areaA != areaB) return areaA < areaB;
+
+		auto maxA = std::max(a.Width, a.Height);
+		auto maxB = std::max(b.Width, b.Height);
+		if (maxA != maxB) return maxA < maxB;
+
+		return a.Width < b.Width;
+	}
+
+	static std::optional<Layout> Pack(Array<Item> const& items, uint32_t width)
+	{
+		Layout layout;
+		layout.Width = width;
+		layout.Height = 0;
+
+		// Height of the skyline in each tile column
+		Array<uint32_t> skyline;
+		skyline.resize(width);
+		std::fill(skyline.begin(), skyline.end(), 0);
+
+		for (auto const& item : items) {
+			if (item.Width > width) {
+				return {};
 			}
-        }
 
-        TotalWidth = PlacementTileWidth * PlacementGridWidth;
-        TotalHeight = PlacementTileHeight * PlacementGridHeight;
-		return true;
-    }
+			uint32_t bestX{ 0 }, bestY{ 0xffffffffu };
+			for (uint32_t x = 0; x + item.Width <= width; x += item.Alignment) {
+				uint32_t y{ 0 };
+				for (uint32_t col = x; col < x + item.Width; col++) {
+					y = std::max(y, skyline[col]);
+				}
+
+				y = AlignUp(y, item.Alignment);
+				if (y < bestY) {
+					bestX = x;
+					bestY = y;
+				}
+			}
+
+			if (bestY == 0xffffffffu || bestY + item.Height > MaxMergedSize) {
+				return {};
+			}
+
+			for (uint32_t col = bestX; col < bestX + item.Width; col++) {
+				skyline[col] = bestY + item.Height;
+			}
+
+			layout.Positions.push_back(std::make_pair(bestX, bestY));
+			layout.Height = std::max(layout.Height, bestY + item.Height);
+		}
+
+		return layout;
+	}
 };
 
 struct FourCCWriter
@@ -487,6 +537,74 @@ struct FourCCWriter
 	}
 };
 
+// Identifies the inputs of a merged tile set; the merged file is only rebuilt if the key changes
+class MergedTileSetCache
+{
+public:
+	// Bump when the stitching logic changes to invalidate previously merged tile sets
+	static constexpr uint32_t Version = 2;
+	static constexpr char const* OutputPath = "SEMergedTileSet.gts";
+	static constexpr char const* KeyPath = "SEMergedTileSet.gts.key";
+
+	static STDString ComputeKey(Array<GTSFile*> const& tileSets)
+	{
+		Array<uint64_t> hashes;
+		hashes.push_back(Version);
+		for (auto tileSet : tileSets) {
+			uint64_t hash[2];
+			auto path = tileSet->Path.GetStringView();
+			MurmurHash3_x64_128(path.data(), (int)path.size(), 0, hash);
+			hashes.push_back(hash[0]);
+			hashes.push_back(hash[1]);
+
+			MurmurHash3_x64_128(tileSet->Buf.data(), (int)tileSet->Buf.size(), 0, hash);
+			hashes.push_back(hash[0]);
+			hashes.push_back(hash[1]);
+			hashes.push_back(tileSet->Buf.size());
+		}
+
+		uint64_t key[2];
+		MurmurHash3_x64_128(hashes.raw_buf(), (int)(hashes.size() * sizeof(uint64_t)), 0, key);
+
+		char keyStr[33];
+		sprintf_s(keyStr, "%016llx%016llx", key[0], key[1]);
+		return keyStr;
+	}
+
+	static bool IsUpToDate(STDString const& key)
+	{
+		auto keyPath = GetStaticSymbols().ToPath(KeyPath, PathRootType::Data, true);
+		std::ifstream f(keyPath.c_str(), std::ios::in | std::ios::binary);
+		if (!f.good()) {
+			return false;
+		}
+
+		std::string cachedKey;
+		std::getline(f, cachedKey);
+		if (cachedKey != key.c_str()) {
+			return false;
+		}
+
+		auto gtsPath = GetStaticSymbols().ToPath(OutputPath, PathRootType::Data, true);
+		return GetFileAttributesW(FromUTF8(gtsPath).c_str()) != INVALID_FILE_ATTRIBUTES;
+	}
+
+	static void Save(STDString const& key)
+	{
+		auto keyPath = GetStaticSymbols().ToPath(KeyPath, PathRootType::Data, true);
+		std::ofstream f(keyPath.c_str(), std::ios::out | std::ios::binary);
+		if (f.good()) {
+			f.write(key.data(), key.size());
+		}
+	}
+
+	static void Invalidate()
+	{
+		auto keyPath = GetStaticSymbols().ToPath(KeyPath, PathRootType::Data, true);
+		DeleteFileW(FromUTF8(keyPath).c_str());
+	}
+};
+
 struct GTSStitchedFile
 {
 	Array<GTSFile*> TileSets;
@@ -498,6 +616,7 @@ struct GTSStitchedFile
 	Array<Array<uint32_t>> PerLevelFlatTileIndices;
 	Array<GTSParameterBlockHeader> ParameterBlocks;
 	Array<GTSBCParameterBlock> ParameterBlockBlobs;
+	std::unordered_set<uint32_t> ParameterBlockIds;
 	Array<GTSPageFileInfo> PageFiles;
 	Array<GTSPackedTileID> PackedTileIDs;
 	Array<GTSFlatTileInfo> FlatTileInfos;
@@ -596,15 +715,7 @@ struct GTSStitchedFile
 		}
 
 		for (uint32_t i = 0; i < tileSet->ParameterBlocks.size(); i++) {
-			bool found{ false };
-			for (uint32_t j = 0; i < ParameterBlocks.size(); j++) {
-				if (ParameterBlocks[j].ParameterBlockID == tileSet->ParameterBlocks[i].ParameterBlockID) {
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) {
+			if (ParameterBlockIds.insert(tileSet->ParameterBlocks[i].ParameterBlockID).second) {
 				ParameterBlocks.push_back(tileSet->ParameterBlocks[i]);
 				ParameterBlockBlobs.push_back(*tileSet->ParameterBlockBlobs[i]);
 			}
@@ -749,7 +860,7 @@ struct GTSStitchedFile
 		Header.ParameterBlockHeadersCount = ParameterBlocks.size();
 		Header.ThumbnailsOffset = 0;
 
-		OutputPath = "SEMergedTileSet.gts";
+		OutputPath = MergedTileSetCache::OutputPath;
 		auto gtsPath = GetStaticSymbols().ToPath(OutputPath, PathRootType::Data, true);
 		std::ofstream f(gtsPath.c_str(), std::ios::out | std::ios::binary);
 
@@ -4,6 +4,10 @@
 #include <GameDefinitions/Resources.h>
 #include <mutex>
 
+BEGIN_NS(vt)
+struct GTSFile;
+END_NS()
+
 BEGIN_SE()
 
 #if defined(VT_DEBUG_TRANSCODE)
@@ -73,6 +77,7 @@ private:
 	void DecRefGTS(VirtualTextureManager* vt, unsigned int textureLayerConfig, std::optional<char> gtsSuffix, bool a4, FixedString const& gTexId);
 	STDString GetVirtualTexturePath(unsigned int textureLayerConfig, std::optional<char> gtsSuffix, bool a4, FixedString const& gTexId, bool isLoad);
 	void Stitch();
+	bool BuildStitchedTileSet(Array<vt::GTSFile*> const& tileSets);
 };
 
 END_SE()
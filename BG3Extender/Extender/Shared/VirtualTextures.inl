@@ -125,32 +125,66 @@ void VirtualTextureHelpers::Load()
 
 void VirtualTextureHelpers::Stitch()
 {
-	std::unordered_set<FixedString> gtsFiles;
+	std::unordered_set<FixedString> gtsFileSet;
 	for (auto const& path : gtsPaths_) {
-		gtsFiles.insert(path.Value());
+		gtsFileSet.insert(path.Value());
 	}
 
-	if (gtsFiles.size() < 2) {
+	if (gtsFileSet.size() < 2) {
 		// No need to stitch if we only have 1 tile set
 		return;
 	}
 
-	DEBUG("Creating merged virtual texture tile set");
+	// Stitch in a stable order so the merged output only depends on the set of input files
+	Array<FixedString> gtsFiles;
+	for (auto const& path : gtsFileSet) {
+		gtsFiles.push_back(path);
+	}
+	std::sort(gtsFiles.begin(), gtsFiles.end(), [](FixedString const& a, FixedString const& b) {
+		return a.GetStringView() < b.GetStringView();
+	});
 
-	vt::GTSStitchedFile stitched;
+	Array<vt::GTSFile*> tileSets;
 	for (auto const& path : gtsFiles) {
 		auto reader = GetStaticSymbols().MakeFileReader(path, PathRootType::Data);
 		if (reader.IsLoaded()) {
 			auto gts = GameAlloc<vt::GTSFile>();
 			gts->Path = path;
-			gts->Buf.resize((uint32_t)reader.Size());
-			std::copy(reinterpret_cast<uint8_t*>(reader.Buf()), reinterpret_cast<uint8_t*>(reader.Buf()) + reader.Size(), gts->Buf.begin());
-			char const* reason{ nullptr };
-			if (!gts->Read(reason)) {
-				ERR("Failed to load '%s': %s", path.GetString(), reason ? reason : "");
-			} else {
-				stitched.TileSets.push_back(gts);
-			}
+			gts->Buf = std::span<uint8_t>(reinterpret_cast<uint8_t*>(reader.Buf()), reader.Size());
+			gts->Reader.emplace(std::move(reader));
+			tileSets.push_back(gts);
+		}
+	}
+
+	auto cacheKey = vt::MergedTileSetCache::ComputeKey(tileSets);
+	if (vt::MergedTileSetCache::IsUpToDate(cacheKey)) {
+		DEBUG("Merged virtual texture tile set is up to date");
+		FixedString outputPath{ vt::MergedTileSetCache::OutputPath };
+		for (auto& path : gtsPaths_) {
+			path.Value() = outputPath;
+		}
+	} else {
+		DEBUG("Creating merged virtual texture tile set");
+		vt::MergedTileSetCache::Invalidate();
+		if (BuildStitchedTileSet(tileSets)) {
+			vt::MergedTileSetCache::Save(cacheKey);
+		}
+	}
+
+	for (auto gts : tileSets) {
+		GameDelete(gts);
+	}
+}
+
+bool VirtualTextureHelpers::BuildStitchedTileSet(Array<vt::GTSFile*> const& tileSets)
+{
+	vt::GTSStitchedFile stitched;
+	for (auto gts : tileSets) {
+		char const* reason{ nullptr };
+		if (!gts->Read(reason)) {
+			ERR("Failed to load '%s': %s", gts->Path.GetString(), reason ? reason : "");
+		} else {
+			stitched.TileSets.push_back(gts);
 		}
 	}
 
@@ -159,12 +193,13 @@ void VirtualTextureHelpers::Stitch()
 	if (!geom.DoAutoPlacement()) {
 		ERR("Failed to calculate merged tileset geometry, virtual textures will not be available!");
 		gtsPaths_.clear();
-		return;
+		return false;
 	}
 
-	DEBUG("Merged geometry: %d x %d tiles (%d x %d px)",
+	DEBUG("Merged geometry: %d x %d tiles (%d x %d px), %.1f%% occupied",
 		geom.TotalWidth, geom.TotalHeight,
-		geom.TotalWidth * 128, geom.TotalHeight * 128
+		geom.TotalWidth * 128, geom.TotalHeight * 128,
+		geom.Occupancy()
 	);
 
 	stitched.Init(geom.TotalWidth, geom.TotalHeight);
@@ -175,9 +210,13 @@ void VirtualTextureHelpers::Stitch()
 		for (auto& path : gtsPaths_) {
 			path.Value() = outputPath;
 		}
+
+		// Tile sets written to a fallback path can't be reused
+		return stitched.OutputPath == vt::MergedTileSetCache::OutputPath;
 	} else {
 		ERR("Merged tile set build failed, virtual textures will not be available!");
 		gtsPaths_.clear();
+		return false;
 	}
 }
 
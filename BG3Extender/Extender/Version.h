@@ -10,6 +10,8 @@ namespace bg3se {
 
 	// Version with user variables
 	static constexpr uint32_t SavegameVerAddedUserVars = 9;
+	// Version with user and mod variables stored in a packed blob
+	static constexpr uint32_t SavegameVerPackedUserVars = 10;
 	// Last version with savegame changes
-	static constexpr uint32_t SavegameVersion = 9;
+	static constexpr uint32_t SavegameVersion = 10;
 }
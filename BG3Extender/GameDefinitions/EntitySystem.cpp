@@ -307,6 +307,8 @@ RuntimeCheckLevel EntitySystemHelpersBase::CheckLevel{ RuntimeCheckLevel::Once }
 #else
 RuntimeCheckLevel EntitySystemHelpersBase::CheckLevel{ RuntimeCheckLevel::Always };
 #endif
+uint32_t EntitySystemHelpersBase::IntegrityCheckBudgetUs{ 1000 };
+uint32_t EntitySystemHelpersBase::IntegrityCheckPoolsPerTick{ 32 };
 
 EntitySystemHelpersBase::EntitySystemHelpersBase()
 	: queryIndices_{ UndefinedIndex },
@@ -653,9 +655,56 @@ void EntitySystemHelpersBase::Update()
 	if (CheckLevel != RuntimeCheckLevel::FullECS) return;
 
 	auto world = GetEntityWorld();
-	auto& pool1 = world->Components->Components;
-	for (auto i = 0; i < components_.size(); i++) {
-		auto const& componentInfo = components_[i];
+	if (world) {
+		RunIntegrityCheck(*world, IntegrityCheckBudgetUs, IntegrityCheckPoolsPerTick);
+	}
+}
+
+void EntitySystemHelpersBase::RunFullIntegrityCheck()
+{
+	auto world = GetEntityWorld();
+	if (!world) return;
+
+	integrityCheck_ = IntegrityCheckState{ .CompletedPasses = integrityCheck_.CompletedPasses };
+	while (!RunIntegrityCheck(*world, 0, 0)) {}
+}
+
+float EntitySystemHelpersBase::GetIntegrityCheckCoverage() const
+{
+	if (integrityCheck_.PoolsInPass == 0) {
+		return 0.0f;
+	}
+
+	return std::min(100.0f, integrityCheck_.PoolsChecked * 100.0f / integrityCheck_.PoolsInPass);
+}
+
+// Validates components until the time or pool budget runs out.
+// Returns true if the current pass was completed.
+bool EntitySystemHelpersBase::RunIntegrityCheck(EntityWorld& world, uint64_t budgetUs, uint32_t maxPools)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	auto budgetExceeded = [=]() {
+		return budgetUs != 0
+			&& (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() >= budgetUs;
+	};
+
+	auto& state = integrityCheck_;
+	auto& pool1 = world.Components->Components;
+	auto& pool2 = world.Components->Components2;
+
+	if (state.NextSizeCheck == 0 && state.NextPool == 0 && state.NextObject == 0) {
+		state.PoolsChecked = 0;
+		state.PoolsInPass = 0;
+		for (uint32_t componentId = 0; componentId < pool2.AvailableComponentTypes.size(); componentId++) {
+			if (pool2.AvailableComponentTypes[componentId]) {
+				state.PoolsInPass++;
+			}
+		}
+	}
+
+	// Size checks are cheap, so they're done in one go
+	for (; state.NextSizeCheck < components_.size(); state.NextSizeCheck++) {
+		auto const& componentInfo = components_[state.NextSizeCheck];
 		if (componentInfo.ComponentIndex != UndefinedComponent) {
 			if (pool1.AvailableComponentTypes[componentInfo.ComponentIndex.Value()]) {
 				auto const& pool = pool1.ComponentsByType[componentInfo.ComponentIndex.Value()];
@@ -668,24 +717,42 @@ void EntitySystemHelpersBase::Update()
 		}
 	}
 
-	auto& pool2 = world->Components->Components2;
-	for (uint32_t componentId = 0; componentId < pool2.AvailableComponentTypes.size(); componentId++) {
-		if (pool2.AvailableComponentTypes[componentId]) {
-			auto const& components = pool2.ComponentsByType[componentId].Components;
-			auto componentType = GetComponentType(ComponentTypeIndex(componentId));
-			if (componentType) {
-				auto pm = GetPropertyMap(*componentType);
-				if (pm != nullptr && components.Values.Used > 0) {
-					for (uint32_t j = 0; j < components.Values.Used; j++) {
-						auto const& component = components.Values[j];
-						if (component.Ptr != nullptr) {
-							pm->ValidateObject(component.Ptr);
-						}
-					}
+	// Number of objects validated between two budget checks
+	static constexpr uint32_t ObjectsPerBudgetCheck = 64;
+	uint32_t poolsVisited = 0;
+	for (; state.NextPool < pool2.AvailableComponentTypes.size(); state.NextPool++, state.NextObject = 0) {
+		auto componentId = state.NextPool;
+		if (!pool2.AvailableComponentTypes[componentId]) continue;
+
+		if ((maxPools != 0 && poolsVisited >= maxPools) || budgetExceeded()) {
+			return false;
+		}
+
+		poolsVisited++;
+		auto const& components = pool2.ComponentsByType[componentId].Components;
+		auto componentType = GetComponentType(ComponentTypeIndex(componentId));
+		auto pm = componentType ? GetPropertyMap(*componentType) : nullptr;
+		if (pm != nullptr) {
+			while (state.NextObject < components.Values.Used) {
+				auto const& component = components.Values[state.NextObject++];
+				if (component.Ptr != nullptr) {
+					pm->ValidateObject(component.Ptr);
+				}
+
+				if ((state.NextObject % ObjectsPerBudgetCheck) == 0 && budgetExceeded()) {
+					return false;
 				}
 			}
 		}
+
+		state.PoolsChecked++;
 	}
+
+	state.CompletedPasses++;
+	state.NextSizeCheck = 0;
+	state.NextPool = 0;
+	state.NextObject = 0;
+	return true;
 }
 
 void EntitySystemHelpersBase::PostUpdate()
@@ -695,12 +762,22 @@ void EntitySystemHelpersBase::PostUpdate()
 	auto world = GetEntityWorld();
 	if (!world->Replication || !world->Replication->Dirty) return;
 
+	// Replicated components are only known to be dirty during this tick, so they can't be carried over;
+	// whatever doesn't fit in the time budget is skipped
+	auto start = std::chrono::high_resolution_clock::now();
+	uint32_t skipped = 0;
 	for (unsigned i = 0; i < world->Replication->ComponentPools.size(); i++) {
 		auto const& pool = world->Replication->ComponentPools[i];
 		auto componentType = GetComponentType(ReplicationTypeIndex(i));
 		if (componentType && pool.size() > 0) {
 			auto pm = GetPropertyMap(*componentType);
 			if (pm != nullptr) {
+				if (IntegrityCheckBudgetUs != 0
+					&& (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count() >= IntegrityCheckBudgetUs) {
+					skipped += pool.size();
+					continue;
+				}
+
 				for (auto const& entity : pool) {
 					auto component = GetRawComponent(entity.Key(), *componentType);
 					if (component) {
@@ -710,6 +787,10 @@ void EntitySystemHelpersBase::PostUpdate()
 			}
 		}
 	}
+
+	if (skipped > 0) {
+		DEBUG("[ECS INTEGRITY CHECK] Replication check budget exceeded; skipped %d components", skipped);
+	}
 }
 
 EntityHandle EntitySystemHelpersBase::GetEntityHandle(FixedString const& guidString)
@@ -36,6 +36,10 @@ class EntitySystemHelpersBase : public Noncopyable<EntitySystemHelpersBase>
 {
 public:
 	static RuntimeCheckLevel CheckLevel;
+	// Maximum time spent on FullECS integrity checks per tick, in microseconds (0 = unlimited)
+	static uint32_t IntegrityCheckBudgetUs;
+	// Maximum number of component pools validated per tick (0 = unlimited)
+	static uint32_t IntegrityCheckPoolsPerTick;
 
 	struct PerComponentData
 	{
@@ -193,6 +197,16 @@ public:
 	void Update();
 	void PostUpdate();
 
+	// Percentage of component pools validated during the current integrity check pass
+	float GetIntegrityCheckCoverage() const;
+	uint32_t GetIntegrityCheckCompletedPasses() const
+	{
+		return integrityCheck_.CompletedPasses;
+	}
+
+	// Runs a complete integrity check pass, ignoring the per-tick budget
+	void RunFullIntegrityCheck();
+
 protected:
 	static constexpr int32_t UndefinedIndex{ -1 };
 
@@ -225,8 +239,25 @@ private:
 	std::unordered_map<STDString, int32_t> staticDataMappings_;
 	std::vector<STDString const*> staticDataIdToName_;
 
+	// Cursor of the incremental (time-sliced) FullECS integrity check
+	struct IntegrityCheckState
+	{
+		// Next component type whose size is checked
+		uint32_t NextSizeCheck{ 0 };
+		// Next component pool and object whose contents are validated
+		uint32_t NextPool{ 0 };
+		uint32_t NextObject{ 0 };
+		// Number of pools fully validated in the current pass
+		uint32_t PoolsChecked{ 0 };
+		uint32_t CompletedPasses{ 0 };
+		// Number of pools available when the current pass started
+		uint32_t PoolsInPass{ 0 };
+	};
+
 	bool initialized_{ false };
+	IntegrityCheckState integrityCheck_;
 
+	bool RunIntegrityCheck(EntityWorld& world, uint64_t budgetUs, uint32_t maxPools);
 	void BindSystem(std::string_view name, int32_t id);
 	void BindQuery(std::string_view name, int32_t id);
 	void BindStaticData(std::string_view name, int32_t id);
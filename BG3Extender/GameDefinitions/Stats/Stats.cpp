@@ -342,19 +342,9 @@ void Object::FromProtobuf(MsgS2CSyncStat const& msg)
 
 void Object::BroadcastSyncMessage(bool syncDuringLoading) const
 {
-	/*auto msg = gExtender->GetNetworkManager().GetFreeServerMessage(ReservedUserId);
-	if (!msg) {
-		OsiErrorS("Failed to get free message");
-		return;
-	}
-
-	auto& wrap = msg->GetMessage();
-	ToProtobuf(wrap.mutable_s2c_sync_stat());
-	if (syncDuringLoading) {
-		gExtender->GetNetworkManager().ServerBroadcastToConnectedPeers(msg, ReservedUserId, true);
-	} else {
-		gExtender->GetNetworkManager().ServerBroadcast(msg, ReservedUserId, true);
-	}*/
+	// Updates are batched and sent at the end of the server tick; syncs requested
+	// while the game is loading are kept in the queue until loading finishes
+	gExtender->GetServer().GetExtensionState().GetStatSyncQueue().Enqueue(*this);
 }
 	
 
@@ -585,13 +575,7 @@ FixedString RPGStats::EnumIndexToLabel(FixedString const& enumName, int index)
 		return FixedString{};
 	}
 
-	auto value = rpgEnum->Values.find_by_value(index);
-	if (value != rpgEnum->Values.end()) {
-		return value.Key();
-	}
-	else {
-		return FixedString{};
-	}
+	return sLookupIndexes.EnumIndexToLabel(*rpgEnum, index);
 }
 
 std::optional<FixedString*> RPGStats::GetFixedString(int stringId)
@@ -706,14 +690,7 @@ int RPGStats::GetOrCreateConditions(STDString const& conditions)
 		return -1;
 	}
 
-	for (unsigned i = 0; i < Conditions.Size(); i++) {
-		if (Conditions[i] == conditions) {
-			return (int)i;
-		}
-	}
-
-	Conditions.Add(conditions);
-	return (int)Conditions.Size() - 1;
+	return sLookupIndexes.GetOrAddConditions(Conditions, conditions);
 }
 
 Modifier * RPGStats::GetModifierInfo(FixedString const& modifierListName, FixedString const& modifierName)
@@ -732,6 +709,123 @@ ModifierList * RPGStats::GetTypeInfo(Object * object)
 }
 
 RPGStats::VMTMappings RPGStats::sVMTMappings;
+RPGStats::LookupIndexes RPGStats::sLookupIndexes;
+
+void RPGStats::LookupIndexes::IndexConditions(Array<STDString> const& conditions)
+{
+	if (conditions.Size() < NumIndexedConditions) {
+		ConditionIds.clear();
+		NumIndexedConditions = 0;
+	}
+
+	for (uint32_t i = NumIndexedConditions; i < conditions.Size(); i++) {
+		// Keep the first occurrence of duplicate expressions, like the linear search did
+		ConditionIds.insert(std::make_pair(conditions[i], (int)i));
+	}
+
+	NumIndexedConditions = conditions.Size();
+}
+
+int RPGStats::LookupIndexes::GetOrAddConditions(Array<STDString>& conditions, STDString const& expr)
+{
+	std::lock_guard _(Mutex);
+	IndexConditions(conditions);
+
+	auto it = ConditionIds.find(expr);
+	if (it != ConditionIds.end()
+		&& ((uint32_t)it->second >= conditions.Size() || conditions[it->second] != expr)) {
+		// Conditions array was replaced without a reload notification
+		ConditionIds.clear();
+		NumIndexedConditions = 0;
+		IndexConditions(conditions);
+		it = ConditionIds.find(expr);
+	}
+
+	if (it != ConditionIds.end()) {
+		return it->second;
+	}
+
+	auto conditionsId = (int)conditions.Size();
+	conditions.Add(expr);
+	ConditionIds.insert(std::make_pair(expr, conditionsId));
+	NumIndexedConditions = conditions.Size();
+	return conditionsId;
+}
+
+void RPGStats::LookupIndexes::Clear()
+{
+	std::lock_guard _(Mutex);
+	ConditionIds.clear();
+	NumIndexedConditions = 0;
+}
+
+RPGStats::LookupIndexes::EnumLabels const& RPGStats::LookupIndexes::GetEnumLabels(RPGEnumeration const& rpgEnum)
+{
+	auto& labels = Enums[&rpgEnum];
+	if (labels.NumValues != rpgEnum.Values.size()) {
+		labels.Labels.clear();
+		for (auto const& kv : rpgEnum.Values) {
+			if (kv.Value >= 0) {
+				if ((uint32_t)kv.Value >= labels.Labels.size()) {
+					labels.Labels.resize(kv.Value + 1);
+				}
+
+				// Keep the first label for values that have aliases, like find_by_value did
+				if (!labels.Labels[kv.Value]) {
+					labels.Labels[kv.Value] = kv.Key;
+				}
+			}
+		}
+
+		labels.NumValues = rpgEnum.Values.size();
+	}
+
+	return labels;
+}
+
+std::optional<FixedString> RPGStats::LookupIndexes::TryGetEnumLabel(EnumLabels const& labels, RPGEnumeration const& rpgEnum, int index)
+{
+	if (labels.NumValues != rpgEnum.Values.size()) {
+		return {};
+	}
+
+	if (index < 0 || (uint32_t)index >= labels.Labels.size() || !labels.Labels[index]) {
+		return FixedString{};
+	}
+
+	// Make sure the enumeration wasn't replaced by a different one at the same address
+	auto label = labels.Labels[index];
+	auto it = rpgEnum.Values.find(label);
+	if (it != rpgEnum.Values.end() && it.Value() == index) {
+		return label;
+	}
+
+	return {};
+}
+
+FixedString RPGStats::LookupIndexes::EnumIndexToLabel(RPGEnumeration const& rpgEnum, int index)
+{
+	{
+		std::shared_lock _(EnumMutex);
+		auto it = Enums.find(&rpgEnum);
+		if (it != Enums.end()) {
+			auto label = TryGetEnumLabel(it->second, rpgEnum, index);
+			if (label) {
+				return *label;
+			}
+		}
+	}
+
+	std::unique_lock _(EnumMutex);
+	// Another thread may have rebuilt the labels while we were waiting for the lock
+	auto label = TryGetEnumLabel(GetEnumLabels(rpgEnum), rpgEnum, index);
+	if (label) {
+		return *label;
+	}
+
+	Enums.erase(&rpgEnum);
+	return TryGetEnumLabel(GetEnumLabels(rpgEnum), rpgEnum, index).value_or(FixedString{});
+}
 
 void RPGStats::VMTMappings::Update()
 {
@@ -281,6 +281,42 @@ struct RPGStats : public ProtectedGameObject<RPGStats>
 
 	static VMTMappings sVMTMappings;
 
+	// Extender-side lookup indexes over stats data owned by the game.
+	// New entries added by the game or by us are indexed incrementally on the next lookup;
+	// indexes are rebuilt if the underlying data no longer matches (eg. after a stats reload).
+	// Stats are shared by the client and server threads, so both indexes are locked.
+	struct LookupIndexes
+	{
+		struct EnumLabels
+		{
+			uint32_t NumValues{ 0 };
+			Vector<FixedString> Labels;
+		};
+
+		// Protects the conditions index; stats can be loaded on a worker thread
+		std::mutex Mutex;
+		std::unordered_map<STDString, int> ConditionIds;
+		uint32_t NumIndexedConditions{ 0 };
+		// Protects the enum label tables; lookups only need a shared lock unless the table has to be (re)built
+		std::shared_mutex EnumMutex;
+		std::unordered_map<RPGEnumeration const*, EnumLabels> Enums;
+
+		// Returns the index of the expression, appending it to the conditions array if it's not there yet
+		int GetOrAddConditions(Array<STDString>& conditions, STDString const& expr);
+		FixedString EnumIndexToLabel(RPGEnumeration const& rpgEnum, int index);
+		// Drops the conditions index; called when the game reloads stats
+		void Clear();
+
+	private:
+		void IndexConditions(Array<STDString> const& conditions);
+		// Must be called with EnumMutex held exclusively
+		EnumLabels const& GetEnumLabels(RPGEnumeration const& rpgEnum);
+		// Returns null if the label table is out of date and must be rebuilt
+		static std::optional<FixedString> TryGetEnumLabel(EnumLabels const& labels, RPGEnumeration const& rpgEnum, int index);
+	};
+
+	static LookupIndexes sLookupIndexes;
+
 	CNamedElementManager<RPGEnumeration> ModifierValueLists;
 	CNamedElementManager<ModifierList> ModifierLists;
 	CNamedElementManager<Object> Objects;
@@ -55,9 +55,9 @@ std::optional<STDString> Object::GetString(FixedString const& attributeName)
 			}
 		}
 	} else if (typeInfo->Values.size() > 0) {
-		auto enumLabel = typeInfo->Values.find_by_value(index);
-		if (enumLabel != typeInfo->Values.end()) {
-			return enumLabel.Key().GetString();
+		auto enumLabel = RPGStats::sLookupIndexes.EnumIndexToLabel(*typeInfo, index);
+		if (enumLabel) {
+			return enumLabel.GetString();
 		}
 	}
 
@@ -139,6 +139,36 @@ struct TranslatedStringRepository : public ProtectedGameObject<TranslatedStringR
 
 	std::optional<StringView> GetTranslatedString(RuntimeStringHandle const& handle);
 	void UpdateTranslatedString(RuntimeStringHandle const& handle, StringView translated);
+	void UpdateTranslatedStrings(std::span<std::pair<FixedString, StringView> const> translated);
+
+private:
+	void DoUpdateTranslatedString(RuntimeStringHandle const& handle, StringView translated);
+};
+
+// Storage for texts of translated strings that were updated at runtime.
+// Texts are kept in an arena owned by the extender and identical texts are only stored once.
+// The game and UI may keep views of a text after its handle was updated, so stored texts are
+// never modified or freed; memory use is bounded by the number of distinct texts set.
+class TranslatedStringStore
+{
+public:
+	std::mutex Lock;
+
+	// Returns a stored (null-terminated) copy of the text; callers must hold the lock.
+	StringView Set(StringView text);
+
+private:
+	static constexpr std::size_t ArenaChunkSize = 0x10000;
+
+	std::vector<std::unique_ptr<char[]>> chunks_;
+	std::size_t chunkUsed_{ ArenaChunkSize };
+	// Texts that are too large to be allocated from arena chunks
+	std::vector<std::unique_ptr<char[]>> largeTexts_;
+	std::unordered_set<StringView> texts_;
+
+	char* Allocate(std::size_t size);
 };
 
+extern TranslatedStringStore gTranslatedStringStore;
+
 END_SE()
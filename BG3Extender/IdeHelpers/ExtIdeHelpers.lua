@@ -31,6 +31,24 @@ function OsiDatabase:Get(...) end
 --- If the parameter is nil, the column is not filtered (equivalent to passing _ in Osiris). If the parameter is not nil, only rows with matching values will be deleted. 
 --- @vararg OsirisValue|nil
 function OsiDatabase:Delete(...) end
+--- Returns every row of the database in columnar form, i.e. one array per column (`rows[column][row]`).  
+--- Columns may contain nil values; the number of rows is stored in the `n` field of each column.  
+--- If the database name exists with multiple column counts, the number of columns must be passed in `arity`.
+--- @param arity integer|nil
+--- @return table<integer,table<integer,OsirisValue>>
+function OsiDatabase:GetAll(arity) end
+--- Inserts every row of `rows` into the database. Each row is an array with one value per column.  
+--- All rows are type checked before any of them is inserted. Returns the number of rows inserted.
+--- @param rows table<integer,table<integer,OsirisValue>>
+--- @param arity integer|nil
+--- @return integer
+function OsiDatabase:InsertMany(rows, arity) end
+--- Deletes every row of `rows` from the database. Each row is an array with one value per column;  
+--- nil values are not filtered, just like in Delete. Returns the number of rows processed.
+--- @param rows table<integer,table<integer,OsirisValue|nil>>
+--- @param arity integer|nil
+--- @return integer
+function OsiDatabase:DeleteMany(rows, arity) end
 
 --- @alias OsiFunction fun(...:OsirisValue):OsirisValue|nil
 --- @alias OsiDynamic table<string, OsiFunction|OsiDatabase>
@@ -8464,7 +8482,10 @@ local Ext_ClientNet = {}
 --- @field DebugDumpLifetimes fun()
 --- @field DumpStack fun()
 --- @field GenerateIdeHelpers fun()
+--- @field GetEntityIntegrityCheckCoverage fun():number, uint32
 --- @field IsDeveloperMode fun():boolean
+--- @field RunEntityIntegrityCheck fun()
+--- @field SetEntityIntegrityCheckBudget fun(a1:uint32, a2:uint32|nil)
 --- @field SetEntityRuntimeCheckLevel fun(a1:int32)
 local Ext_Debug = {}
 
@@ -8647,11 +8668,16 @@ local Ext_StatsTreasureTable = {}
 
 --- @class Ext_Types
 --- @field Construct fun(a1:FixedString)
+--- @field CreatePropertySelector fun(typeName:FixedString, properties:FixedString[]):userdata
 --- @field GetAllTypes fun():FixedString[]
 --- @field GetObjectType fun()
+--- @field GetProperties fun(object:any, properties:FixedString[]|userdata, output:table?):table
 --- @field GetTypeInfo fun(a1:FixedString):TypeInformation
 --- @field Serialize fun()
+--- @field SerializeBinary fun(object:any):string
+--- @field SetProperties fun(object:any, values:table, selector:userdata?)
 --- @field Unserialize fun()
+--- @field UnserializeBinary fun(object:any, data:string)
 --- @field Validate fun():boolean
 local Ext_Types = {}
 --- @class GenerateIdeHelpersOptions
@@ -62,6 +62,19 @@ namespace bg3se::lua::dbg
 		return proto->lineinfo ? proto->lineinfo[pc] : -1;
 	}
 
+	// Calls the function with the main thread and every coroutine of the Lua state
+	template <class Fun>
+	void LuaForEachThread(lua_State* L, Fun fun)
+	{
+		auto g = G(L);
+		fun(g->mainthread);
+		for (auto o = g->allgc; o != nullptr; o = o->next) {
+			if (o->tt == LUA_TTHREAD) {
+				fun(gco2th(o));
+			}
+		}
+	}
+
 	int LuaGetStackDepth(lua_State* L)
 	{
 		int depth = 0;
@@ -562,6 +575,114 @@ namespace bg3se::lua::dbg
 		ContextDebugger& dbg_;
 	};
 
+	ContextDebugger::LineBitmap const* ContextDebugger::GetChunkBreakpoints(char const* chunkName)
+	{
+		auto chunkIt = breakpoints_->chunkLines.find(chunkName);
+		if (chunkIt != breakpoints_->chunkLines.end()) {
+			return chunkIt->second ? &*chunkIt->second : nullptr;
+		}
+
+		std::optional<LineBitmap> lines;
+		auto const& paths = GetExtensionState().GetLoadedFileFullPaths();
+		auto pathIt = paths.find(chunkName);
+		if (pathIt != paths.end()) {
+			auto fileIt = breakpoints_->breakpoints.find(pathIt->second);
+			if (fileIt != breakpoints_->breakpoints.end()) {
+				lines = LineBitmap();
+				for (auto line : fileIt->second) {
+					if (line < 0) continue;
+
+					if ((unsigned)(line >> 6) >= lines->size()) {
+						lines->resize((line >> 6) + 1, 0);
+					}
+
+					(*lines)[line >> 6] |= (1ull << (line & 63));
+				}
+			}
+		}
+
+		auto& entry = breakpoints_->chunkLines.insert(std::make_pair(STDString(chunkName), std::move(lines))).first->second;
+		return entry ? &*entry : nullptr;
+	}
+
+	ContextDebugger::ProtoBreakpoints const& ContextDebugger::GetProtoBreakpoints(Proto const* proto)
+	{
+		auto& bps = breakpoints_->protos[proto];
+		if (bps.Source == proto->source
+			&& bps.LineDefined == proto->linedefined
+			&& bps.LastLineDefined == proto->lastlinedefined) {
+			return bps;
+		}
+
+		bps.Source = proto->source;
+		bps.LineDefined = proto->linedefined;
+		bps.LastLineDefined = proto->lastlinedefined;
+		bps.Lines = proto->source ? GetChunkBreakpoints(getstr(proto->source)) : nullptr;
+		bps.Armed = false;
+
+		if (bps.Lines) {
+			// Main chunks are defined on line 0 and span the whole file
+			int firstLine = proto->linedefined;
+			int lastLine = proto->linedefined == 0 ? (int)bps.Lines->size() * 64 - 1 : proto->lastlinedefined;
+			for (int line = firstLine; line <= lastLine && (unsigned)(line >> 6) < bps.Lines->size(); line++) {
+				if ((*bps.Lines)[line >> 6] & (1ull << (line & 63))) {
+					bps.Armed = true;
+					break;
+				}
+			}
+		}
+
+		return bps;
+	}
+
+	void ContextDebugger::UpdateHookMask(lua_State* L)
+	{
+		int mask = 0;
+		if (requestPause_) {
+			// Pausing and stepping need to check every executed line
+			mask = LUA_MASKLINE;
+		} else if (breakpoints_) {
+			// Line hooks are only enabled while executing a function that contains a breakpoint;
+			// call/return hooks arm and disarm the line hook when entering/leaving functions
+			mask = LUA_MASKCALL | LUA_MASKRET;
+			if (LuaIsUserFunction(L) && GetProtoBreakpoints(clLvalue(L->ci->func)->p).Armed) {
+				mask |= LUA_MASKLINE;
+			}
+		}
+
+		if (lua_gethookmask(L) != mask) {
+			lua_sethook(L, mask ? LuaHook : nullptr, mask, 0);
+		}
+	}
+
+	void ContextDebugger::UpdateAllHookMasks(lua_State* L)
+	{
+		// Hooks are per-thread; new coroutines inherit the hooks of the thread that created them,
+		// but existing ones must be updated so they have the correct hooks when they're resumed
+		LuaForEachThread(L, [this](lua_State* thread) {
+			UpdateHookMask(thread);
+		});
+	}
+
+	void ContextDebugger::ClearBreakpointCaches()
+	{
+		if (breakpoints_) {
+			breakpoints_->chunkLines.clear();
+			breakpoints_->protos.clear();
+		}
+	}
+
+	void ContextDebugger::SetBreakpoints(BreakpointSet* breakpoints)
+	{
+		breakpoints_.reset(breakpoints);
+		ClearBreakpointCaches();
+
+		LuaVirtualPin lua(GetExtensionState());
+		if (lua && evalContextRef_ != -1) {
+			UpdateAllHookMasks(lua->GetState());
+		}
+	}
+
 	bool ContextDebugger::IsBreakpoint(lua_State* L, lua_Debug* ar, BkBreakpointTriggered::Reason& reason)
 	{
 		// Fast-path to avoid expensive lookups if we can't break anyway
@@ -569,12 +690,13 @@ namespace bg3se::lua::dbg
 			return false;
 		}
 
-		int line;
-		if (LuaIsUserFunction(L)) {
-			line = LuaCurrentLine(L->ci);
-			if (line == -1) {
-				return false;
-			}
+		if (!LuaIsUserFunction(L)) {
+			return false;
+		}
+
+		int line = LuaCurrentLine(L->ci);
+		if (line == -1) {
+			return false;
 		}
 
 		if (requestPause_) {
@@ -591,32 +713,12 @@ namespace bg3se::lua::dbg
 		}
 
 		if (breakpoints_) {
-			auto lineIt = breakpoints_->lines.find(line);
-			if (lineIt == breakpoints_->lines.end()) {
-				return false;
-			}
-
-			if (lua_getinfo(L, "fnSl", ar) == 0) {
-				return false;
-			}
-
-			ExtensionStateBase* state{ nullptr };
-			if (context_ == DbgContext::SERVER) {
-				state = &gExtender->GetServer().GetExtensionState();
-			} else {
-				state = &gExtender->GetClient().GetExtensionState();
-			}
-
-			auto pathIt = state->GetLoadedFileFullPaths().find(ar->source);
-			if (pathIt != state->GetLoadedFileFullPaths().end()) {
-				auto fileIt = breakpoints_->breakpoints.find(pathIt->second);
-				if (fileIt != breakpoints_->breakpoints.end()) {
-					auto lineIt = fileIt->second.find(line);
-					if (lineIt != fileIt->second.end()) {
-						reason = BkBreakpointTriggered::BREAKPOINT;
-						return true;
-					}
-				}
+			auto const& bps = GetProtoBreakpoints(clLvalue(L->ci->func)->p);
+			if (bps.Armed
+				&& (unsigned)(line >> 6) < bps.Lines->size()
+				&& ((*bps.Lines)[line >> 6] & (1ull << (line & 63)))) {
+				reason = BkBreakpointTriggered::BREAKPOINT;
+				return true;
 			}
 		}
 
@@ -645,16 +747,43 @@ namespace bg3se::lua::dbg
 			breakpointCv_.wait(lk, [this]() { this->ExecuteQueuedActions(); return !this->isPaused_; });
 		}
 
+		// Stepping mode or breakpoints may have changed while paused
+		UpdateAllHookMasks(L);
 		DBGMSG("Continuing from breakpoint.");
 	}
 
 	void ContextDebugger::OnLuaHook(lua_State* L, lua_Debug* ar)
 	{
-		ExecuteQueuedActions();
-		
-		BkBreakpointTriggered::Reason reason = BkBreakpointTriggered::BREAKPOINT;
-		if (IsBreakpoint(L, ar, reason)) {
-			TriggerBreakpoint(L, reason, nullptr);
+		switch (ar->event) {
+		case LUA_HOOKCALL:
+		case LUA_HOOKTAILCALL:
+			if (!requestPause_) {
+				UpdateHookMask(L);
+			}
+			break;
+
+		case LUA_HOOKRET:
+			// The return hook is called before the returning frame is popped;
+			// arm the line hook based on the function we're returning to
+			if (!requestPause_) {
+				auto ci = L->ci;
+				L->ci = ci->previous;
+				UpdateHookMask(L);
+				L->ci = ci;
+			}
+			break;
+
+		case LUA_HOOKLINE:
+		{
+			BkBreakpointTriggered::Reason reason = BkBreakpointTriggered::BREAKPOINT;
+			if (IsBreakpoint(L, ar, reason)) {
+				TriggerBreakpoint(L, reason, nullptr);
+			} else if (!requestPause_ && !breakpoints_) {
+				// Hooks left over from a pause request or removed breakpoints
+				UpdateHookMask(L);
+			}
+			break;
+		}
 		}
 	}
 
@@ -694,7 +823,11 @@ namespace bg3se::lua::dbg
 
 	void ContextDebugger::OnContextDestroyed()
 	{
+		std::unique_lock<std::mutex> lk(breakpointMutex_);
 		evalContextRef_ = -1;
+		hookedState_ = nullptr;
+		// Prototypes and loaded file paths of the destroyed state are no longer valid
+		ClearBreakpointCaches();
 	}
 
 	void ContextDebugger::SetupLuaBindings(lua_State* L)
@@ -702,17 +835,30 @@ namespace bg3se::lua::dbg
 		if (evalContextRef_ != -1) return;
 
 		StackCheck _(L);
-		lua_sethook(L, LuaHook, LUA_MASKLINE, 0);
+		ClearBreakpointCaches();
+		// Hooks are only installed while breakpoints are set or a pause/step was requested
+		UpdateAllHookMasks(L);
 		lua_newtable(L);
 		evalContextRef_ = luaL_ref(L, LUA_REGISTRYINDEX);
+
+		std::unique_lock<std::mutex> lk(breakpointMutex_);
+		hookedState_ = L;
 	}
 
 	void ContextDebugger::CleanupLuaBindings(lua_State* L)
 	{
 		if (evalContextRef_ == -1) return;
 
+		{
+			std::unique_lock<std::mutex> lk(breakpointMutex_);
+			hookedState_ = nullptr;
+		}
+
 		StackCheck _(L);
-		lua_sethook(L, nullptr, 0, 0);
+		LuaForEachThread(L, [](lua_State* thread) {
+			lua_sethook(thread, nullptr, 0, 0);
+		});
+		ClearBreakpointCaches();
 		luaL_unref(L, LUA_REGISTRYINDEX, evalContextRef_);
 		evalContextRef_ = -1;
 	}
@@ -771,8 +917,6 @@ namespace bg3se::lua::dbg
 		} else {
 			fileIt->second.insert(line);
 		}
-
-		newBreakpoints_->lines.insert(line);
 	}
 
 	void ContextDebugger::FinishUpdatingBreakpoints()
@@ -784,7 +928,7 @@ namespace bg3se::lua::dbg
 		auto bps = newBreakpoints_.release();
 
 		pendingActions_.push([=]() {
-			breakpoints_.reset(bps);
+			SetBreakpoints(bps);
 		});
 		breakpointCv_.notify_one();
 	}
@@ -809,6 +953,10 @@ namespace bg3se::lua::dbg
 			// Forcibly break on the next call
 			requestPause_ = true;
 			pauseMaxStackDepth_ = 0x7fffffff;
+			// The line hook may not be installed at this point; lua_sethook() is safe to call asynchronously
+			if (hookedState_ != nullptr) {
+				lua_sethook(hookedState_, LuaHook, LUA_MASKLINE, 0);
+			}
 			// This is not a "continue" message, it just sets the breakpoint flags,
 			// so we don't go through the continue code here
 			return ResultCode::Success;
@@ -9,6 +9,7 @@
 #include <Lua/Debugger/LuaDebugMessages.h>
 
 struct lua_Debug;
+struct Proto;
 
 namespace bg3se
 {
@@ -93,12 +94,30 @@ namespace bg3se::lua::dbg
 	private:
 		friend class DebugEvalGuard;
 
+		// Breakpoint lines of a chunk, indexed by line number
+		using LineBitmap = Vector<uint64_t>;
+
+		// Breakpoint state of a function prototype, cached on first call
+		struct ProtoBreakpoints
+		{
+			// Used for detecting prototypes that were collected and reallocated at the same address
+			void const* Source{ nullptr };
+			int LineDefined{ 0 };
+			int LastLineDefined{ 0 };
+			// Breakpoint lines of the chunk the function was defined in (null if the chunk has no breakpoints)
+			LineBitmap const* Lines{ nullptr };
+			// Are there any breakpoints inside the function body?
+			bool Armed{ false };
+		};
+
 		struct BreakpointSet
 		{
 			// Currently active breakpoints
 			std::unordered_map<STDString, std::unordered_set<int>> breakpoints;
-			// Line-only map to avoid string-based file lookup if a specific line has no breakpoints globally
-			std::unordered_set<int> lines;
+			// Line bitmaps of chunks, keyed by chunk name (built lazily)
+			std::unordered_map<STDString, std::optional<LineBitmap>> chunkLines;
+			// Breakpoint state of each function prototype seen while breakpoints were active
+			std::unordered_map<Proto const*, ProtoBreakpoints> protos;
 		};
 
 		DebugMessageHandler& messageHandler_;
@@ -127,6 +146,8 @@ namespace bg3se::lua::dbg
 		int32_t evaluatingExpression_{ 0 };
 		// Lua registry index of global evaluation results
 		int evalContextRef_{ -1 };
+		// Lua state the debug hooks are installed on; guarded by breakpointMutex_
+		lua_State* hookedState_{ nullptr };
 
 		// Breakpoint set currently in use by the debugger
 		std::unique_ptr<BreakpointSet> breakpoints_;
@@ -138,6 +159,12 @@ namespace bg3se::lua::dbg
 		void CleanupLuaBindings(lua_State* L);
 		void EnableDebugging(bool enabled);
 		void ExecuteQueuedActions();
+		void SetBreakpoints(BreakpointSet* breakpoints);
+		void UpdateHookMask(lua_State* L);
+		void UpdateAllHookMasks(lua_State* L);
+		void ClearBreakpointCaches();
+		ProtoBreakpoints const& GetProtoBreakpoints(Proto const* proto);
+		LineBitmap const* GetChunkBreakpoints(char const* chunkName);
 		bool IsBreakpoint(lua_State* L, lua_Debug* ar, BkBreakpointTriggered::Reason& reason);
 		void TriggerBreakpoint(lua_State* L, BkBreakpointTriggered_Reason reason, char const* msg);
 
@@ -12,30 +12,32 @@ void DebugDumpLifetimes(lua_State* L)
 	unsigned l3free{ 0 }, l3partial{ 0 }, l3full{ 0 };
 	unsigned totalObjs{ 0 };
 
-	for (auto i = 0; i < std::size(pool.l1_); i++) {
-		if (pool.l1_[i] == 0) l1full++;
-		else if (pool.l1_[i] == 0xffffffffffffffffull) l1free++;
+	for (std::size_t seg = 0; seg < pool.NumSegments(); seg++) {
+		auto const& segment = pool.GetSegment(seg);
+		if (segment.l1_ == 0) l1full++;
+		else if (_mm_popcnt_u64(segment.l1_) == std::size(segment.l2_)) l1free++;
 		else l1partial++;
-	}
 
-	for (auto i = 0; i < std::size(pool.l2_); i++) {
-		if (pool.l2_[i] == 0) l2full++;
-		else if (pool.l2_[i] == 0xffffffffffffffffull) l2free++;
-		else l2partial++;
-	}
+		for (auto i = 0; i < std::size(segment.l2_); i++) {
+			if (segment.l2_[i] == 0) l2full++;
+			else if (segment.l2_[i] == 0xffffffffffffffffull) l2free++;
+			else l2partial++;
+		}
 
-	for (auto i = 0; i < std::size(pool.l3_); i++) {
-		if (pool.l3_[i] == 0) l3full++;
-		else if (pool.l3_[i] == 0xffffffffffffffffull) l3free++;
-		else l3partial++;
-		totalObjs += (unsigned)_mm_popcnt_u64(pool.l3_[i]);
+		for (auto i = 0; i < std::size(segment.l3_); i++) {
+			if (segment.l3_[i] == 0) l3full++;
+			else if (segment.l3_[i] == 0xffffffffffffffffull) l3free++;
+			else l3partial++;
+			totalObjs += (unsigned)_mm_popcnt_u64(segment.l3_[i]);
+		}
 	}
 
 	std::cout << " === LIFETIME STATS === " << std::endl;
+	std::cout << "Segments: " << pool.NumSegments() << " allocated" << std::endl;
 	std::cout << "L1: " << l1free << " free pages, " << l1partial << " partially saturated pages, " << l1full << " full pages" << std::endl;
 	std::cout << "L2: " << l2free << " free pages, " << l2partial << " partially saturated pages, " << l2full << " full pages" << std::endl;
 	std::cout << "L3: " << l3free << " free pages, " << l3partial << " partially saturated pages, " << l3full << " full pages" << std::endl;
-	std::cout << "Objects: " << 262144 << " in pool, " << totalObjs << " free" << std::endl;
+	std::cout << "Objects: " << pool.Capacity() << " in pool, " << totalObjs << " free" << std::endl;
 }
 
 void DumpStack(lua_State* L)
@@ -270,6 +272,72 @@ void SetEntityRuntimeCheckLevel(int level)
 	}
 }
 
+void SetEntityIntegrityCheckBudget(uint32_t budgetUs, std::optional<uint32_t> poolsPerTick)
+{
+	ecs::EntitySystemHelpersBase::IntegrityCheckBudgetUs = budgetUs;
+	if (poolsPerTick) {
+		ecs::EntitySystemHelpersBase::IntegrityCheckPoolsPerTick = *poolsPerTick;
+	}
+}
+
+UserReturn GetEntityIntegrityCheckCoverage(lua_State* L)
+{
+	auto helpers = State::FromLua(L)->GetEntitySystemHelpers();
+	push(L, helpers->GetIntegrityCheckCoverage());
+	push(L, helpers->GetIntegrityCheckCompletedPasses());
+	return 2;
+}
+
+void RunEntityIntegrityCheck(lua_State* L)
+{
+	State::FromLua(L)->GetEntitySystemHelpers()->RunFullIntegrityCheck();
+}
+
+// Discards cached user and mod variables the same way as a level transition.
+// Test hook; only available in developer mode.
+void ResetVariableCaches(lua_State* L)
+{
+	if (!gExtender->GetConfig().DeveloperMode) {
+		luaL_error(L, "ResetVariableCaches() only supported in developer mode");
+	}
+
+	State::FromLua(L)->OnLevelLoading();
+}
+
+// Writes persistent user and mod variables to a packed blob and loads them back, the same way as a save/reload.
+// Non-persistent variables are discarded and clients are resynced, so this is a test hook that is only
+// available in developer mode, on the server.
+void RoundTripPersistentVariables(lua_State* L)
+{
+	if (!gExtender->GetConfig().DeveloperMode) {
+		luaL_error(L, "RoundTripPersistentVariables() only supported in developer mode");
+	}
+
+	if (!gExtender->GetServer().IsInServerThread()) {
+		luaL_error(L, "RoundTripPersistentVariables() can only be called from the server");
+	}
+
+	auto state = State::FromLua(L);
+	state->OnLevelLoading();
+
+	auto& vars = state->GetVariableManager().GetGlobal();
+	PackedUserVariableWriter writer;
+	vars.Pack(writer);
+	Vector<uint8_t> blob;
+	writer.Write(blob);
+	if (!vars.LoadPacked(blob.data(), blob.size())) {
+		LuaError("Failed to load packed user variables");
+	}
+
+	auto& modVars = state->GetModVariableManager().GetGlobal();
+	PackedUserVariableWriter modWriter;
+	modVars.Pack(modWriter);
+	modWriter.Write(blob);
+	if (!modVars.LoadPacked(blob.data(), blob.size())) {
+		LuaError("Failed to load packed mod variables");
+	}
+}
+
 void RegisterDebugLib()
 {
 	DECLARE_MODULE(Debug, Both)
@@ -280,6 +348,11 @@ void RegisterDebugLib()
 	MODULE_NAMED_FUNCTION("DebugBreak", LuaDebugBreak)
 	MODULE_FUNCTION(IsDeveloperMode)
 	MODULE_FUNCTION(SetEntityRuntimeCheckLevel)
+	MODULE_FUNCTION(SetEntityIntegrityCheckBudget)
+	MODULE_FUNCTION(GetEntityIntegrityCheckCoverage)
+	MODULE_FUNCTION(RunEntityIntegrityCheck)
+	MODULE_FUNCTION(ResetVariableCaches)
+	MODULE_FUNCTION(RoundTripPersistentVariables)
 	MODULE_FUNCTION(Crash)
 	END_MODULE()
 }
@@ -15,9 +15,58 @@ std::optional<StringView> TranslatedStringRepository::GetTranslatedString(Runtim
 
 void TranslatedStringRepository::UpdateTranslatedString(RuntimeStringHandle const& handle, StringView translated)
 {
-	auto text = GameAlloc<STDString>(translated);
-	TranslatedStrings[0]->Strings.push_back(text);
-	TranslatedStrings[0]->Texts.set(handle, LSStringView(text->data(), text->size()));
+	std::lock_guard _(gTranslatedStringStore.Lock);
+	DoUpdateTranslatedString(handle, translated);
+}
+
+void TranslatedStringRepository::UpdateTranslatedStrings(std::span<std::pair<FixedString, StringView> const> translated)
+{
+	std::lock_guard _(gTranslatedStringStore.Lock);
+	for (auto const& text : translated) {
+		DoUpdateTranslatedString(RuntimeStringHandle(text.first, 0), text.second);
+	}
+}
+
+void TranslatedStringRepository::DoUpdateTranslatedString(RuntimeStringHandle const& handle, StringView translated)
+{
+	auto text = gTranslatedStringStore.Set(translated);
+	TranslatedStrings[0]->Texts.set(handle, LSStringView(text.data(), (uint32_t)text.size()));
+}
+
+
+TranslatedStringStore gTranslatedStringStore;
+
+StringView TranslatedStringStore::Set(StringView text)
+{
+	auto existing = texts_.find(text);
+	if (existing != texts_.end()) {
+		return *existing;
+	}
+
+	auto data = Allocate(text.size() + 1);
+	std::copy(text.begin(), text.end(), data);
+	data[text.size()] = 0;
+
+	StringView stored(data, text.size());
+	texts_.insert(stored);
+	return stored;
+}
+
+char* TranslatedStringStore::Allocate(std::size_t size)
+{
+	if (size > ArenaChunkSize / 4) {
+		largeTexts_.push_back(std::make_unique<char[]>(size));
+		return largeTexts_.back().get();
+	}
+
+	if (chunkUsed_ + size > ArenaChunkSize) {
+		chunks_.push_back(std::make_unique<char[]>(ArenaChunkSize));
+		chunkUsed_ = 0;
+	}
+
+	auto data = chunks_.back().get() + chunkUsed_;
+	chunkUsed_ += size;
+	return data;
 }
 
 END_SE()
@@ -49,12 +98,65 @@ bool UpdateTranslatedString(FixedString handle, char const* value)
 	return true;
 }
 
+UserReturn GetTranslatedStrings(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	lua_newtable(L);
+	auto result = lua_absindex(L, -1);
+
+	auto repo = GetStaticSymbols().GetTranslatedStringRepository();
+	if (!repo) return 1;
+
+	lua_pushnil(L);
+	while (lua_next(L, 1) != 0) {
+		auto handle = get<FixedString>(L, -1);
+		auto text = repo->GetTranslatedString(RuntimeStringHandle(handle, 0));
+		if (text) {
+			push(L, handle);
+			push(L, *text);
+			lua_rawset(L, result);
+		}
+
+		lua_pop(L, 1);
+	}
+
+	return 1;
+}
+
+UserReturn UpdateTranslatedStrings(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	auto repo = GetStaticSymbols().GetTranslatedStringRepository();
+	if (!repo) {
+		push(L, false);
+		return 1;
+	}
+
+	// Lua strings stay alive while the table is on the stack, so the texts don't need to be copied
+	Vector<std::pair<FixedString, StringView>> texts;
+	lua_pushnil(L);
+	while (lua_next(L, 1) != 0) {
+		auto handle = get<FixedString>(L, -2);
+		std::size_t length;
+		auto text = luaL_checklstring(L, -1, &length);
+		texts.push_back(std::make_pair(handle, StringView(text, length)));
+		lua_pop(L, 1);
+	}
+
+	repo->UpdateTranslatedStrings(texts);
+	push(L, true);
+	return 1;
+}
+
 void RegisterLocalizationLib()
 {
 	DECLARE_MODULE(Loca, Both)
 	BEGIN_MODULE()
 	MODULE_FUNCTION(GetTranslatedString)
+	MODULE_FUNCTION(GetTranslatedStrings)
 	MODULE_FUNCTION(UpdateTranslatedString)
+	MODULE_FUNCTION(UpdateTranslatedStrings)
 	END_MODULE()
 }
 
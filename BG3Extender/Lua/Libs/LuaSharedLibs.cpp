@@ -66,6 +66,7 @@ void RegisterSharedMetatables(lua_State* L)
 	stats::StatsExtraDataProxy::RegisterMetatable(L);
 	stats::StatsProxy::RegisterMetatable(L);
 	stats::SpellPrototypeProxy::RegisterMetatable(L);
+	types::PropertySelector::RegisterMetatable(L);
 	types::RegisterEnumerations(L);
 }
 
@@ -91,6 +91,218 @@ GameObjectTemplate* GetTemplate(FixedString const& templateId)
 	return tmpl;
 }
 
+// Lookup tables over the templates of a template manager, keyed by template type, stats ID and name.
+// Only keys and IDs are copied, so a stale index never references freed templates.
+// The index is rebuilt lazily on the first lookup after the template map was replaced or resized.
+// Changing the stats ID or name of an existing template doesn't trigger a rebuild; candidates are
+// checked against the live template, so stale matches are dropped, but a template won't be found by
+// its new stats ID or name until the index is rebuilt.
+// Templates have no tag list, so tags are not indexed.
+class TemplateIndex
+{
+public:
+	struct Query
+	{
+		FixedString Type;
+		FixedString Stats;
+		std::optional<STDString> Name;
+	};
+
+	template <class TMap>
+	void Update(TMap const* templates)
+	{
+		auto size = templates ? templates->size() : 0;
+		if (templates == source_ && size == size_) return;
+
+		Clear();
+		source_ = templates;
+		size_ = size;
+		if (!templates) return;
+
+		for (auto it = templates->begin(); it != templates->end(); ++it) {
+			if (it.Value()) {
+				Add(it.Key(), it.Value());
+			}
+		}
+	}
+
+	template <class TMap>
+	void Find(TMap* templates, Query const& query, std::unordered_set<FixedString>& seen, Vector<FixedString>& results) const
+	{
+		if (!templates || templates != source_) return;
+
+		// Scan the shortest list matching one of the keys, and check the remaining keys on each entry
+		Vector<uint32_t> const* candidates{ nullptr };
+		auto narrow = [&](auto const& index, auto const& key) {
+			auto it = index.find(key);
+			if (it == index.end()) return false;
+			if (!candidates || it->second.size() < candidates->size()) {
+				candidates = &it->second;
+			}
+			return true;
+		};
+
+		if (query.Type && !narrow(byType_, query.Type)) return;
+		if (query.Stats && !narrow(byStats_, query.Stats)) return;
+		if (query.Name && !narrow(byName_, *query.Name)) return;
+
+		auto check = [&](Entry const& entry) {
+			if ((query.Type && entry.Type != query.Type)
+				|| (query.Stats && entry.Stats != query.Stats)
+				|| (query.Name && entry.Name != *query.Name)) {
+				return;
+			}
+
+			// The template may have been modified since the index was built
+			auto tmpl = GetLiveTemplate(templates->try_get(entry.Id));
+			if (!tmpl
+				|| (query.Stats && GetStatsId(tmpl) != query.Stats)
+				|| (query.Name && tmpl->Name != *query.Name)) {
+				return;
+			}
+
+			if (seen.insert(entry.Id).second) {
+				results.push_back(entry.Id);
+			}
+		};
+
+		if (candidates) {
+			for (auto index : *candidates) {
+				check(entries_[index]);
+			}
+		} else {
+			for (auto const& entry : entries_) {
+				check(entry);
+			}
+		}
+	}
+
+private:
+	struct Entry
+	{
+		FixedString Id;
+		FixedString Type;
+		FixedString Stats;
+		STDString Name;
+	};
+
+	void const* source_{ nullptr };
+	uint32_t size_{ 0 };
+	Vector<Entry> entries_;
+	std::unordered_map<FixedString, Vector<uint32_t>> byType_;
+	std::unordered_map<FixedString, Vector<uint32_t>> byStats_;
+	std::unordered_map<STDString, Vector<uint32_t>> byName_;
+
+	void Clear()
+	{
+		entries_.clear();
+		byType_.clear();
+		byStats_.clear();
+		byName_.clear();
+	}
+
+	static GameObjectTemplate* GetLiveTemplate(GameObjectTemplate* tmpl)
+	{
+		return tmpl;
+	}
+
+	static GameObjectTemplate* GetLiveTemplate(GameObjectTemplate** tmpl)
+	{
+		return tmpl ? *tmpl : nullptr;
+	}
+
+	static FixedString GetStatsId(GameObjectTemplate* tmpl)
+	{
+		auto type = tmpl->GetTemplateType();
+		if (type == GFS.strcharacter) {
+			return static_cast<CharacterTemplate*>(tmpl)->Stats.Value;
+		} else if (type == GFS.stritem) {
+			return static_cast<ItemTemplate*>(tmpl)->Stats.Value;
+		} else {
+			return FixedString{};
+		}
+	}
+
+	void Add(FixedString const& id, GameObjectTemplate* tmpl)
+	{
+		auto index = (uint32_t)entries_.size();
+		auto type = tmpl->GetTemplateType();
+		auto stats = GetStatsId(tmpl);
+
+		entries_.push_back(Entry{ id, type, stats, tmpl->Name });
+		byType_[type].push_back(index);
+		if (stats) {
+			byStats_[stats].push_back(index);
+		}
+		byName_[tmpl->Name].push_back(index);
+	}
+};
+
+// Indexes of the template sources, in the same lookup order as GetTemplate()
+TemplateIndex gRootTemplateIndex;
+TemplateIndex gLocalTemplateIndex;
+TemplateIndex gCacheTemplateIndex;
+TemplateIndex gLocalCacheTemplateIndex;
+
+std::optional<STDString> GetQueryField(lua_State* L, char const* key)
+{
+	std::optional<STDString> value;
+	lua_getfield(L, 1, key);
+	if (lua_type(L, -1) != LUA_TNIL) {
+		value = luaL_checkstring(L, -1);
+	}
+
+	lua_pop(L, 1);
+	return value;
+}
+
+/// <summary>
+/// Returns the IDs of all root, local and cache templates matching the query.
+/// Supported query fields are `Type` (eg. "character", "item"), `Stats` and `Name`; omitted fields match any template.
+/// Templates whose stats ID or name was changed at runtime are only found by their new values
+/// after the template list changes (eg. on level load). Tags can't be queried.
+/// 
+/// Example:
+/// ```lua
+/// local ids = Ext.Template.Find({Type = "item", Stats = "WPN_Longsword"})
+/// ```
+/// </summary>
+UserReturn Find(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	TemplateIndex::Query query;
+	auto type = GetQueryField(L, "Type");
+	if (type) query.Type = FixedString(*type);
+	auto stats = GetQueryField(L, "Stats");
+	if (stats) query.Stats = FixedString(*stats);
+	query.Name = GetQueryField(L, "Name");
+
+	auto rootTemplates = GetAllRootTemplates();
+	auto localTemplates = GetAllLocalTemplates();
+	auto cacheTemplates = GetAllCacheTemplates();
+	auto localCacheTemplates = GetAllLocalCacheTemplates();
+	gRootTemplateIndex.Update(rootTemplates);
+	gLocalTemplateIndex.Update(localTemplates);
+	gCacheTemplateIndex.Update(cacheTemplates);
+	gLocalCacheTemplateIndex.Update(localCacheTemplates);
+
+	std::unordered_set<FixedString> seen;
+	Vector<FixedString> results;
+	gRootTemplateIndex.Find(rootTemplates, query, seen, results);
+	gLocalTemplateIndex.Find(localTemplates, query, seen, results);
+	gCacheTemplateIndex.Find(cacheTemplates, query, seen, results);
+	gLocalCacheTemplateIndex.Find(localCacheTemplates, query, seen, results);
+
+	lua_createtable(L, (int)results.size(), 0);
+	for (std::size_t i = 0; i < results.size(); i++) {
+		push(L, results[i]);
+		lua_rawseti(L, -2, (lua_Integer)i + 1);
+	}
+
+	return 1;
+}
+
 void RegisterTemplateLib()
 {
 	DECLARE_MODULE(Template, Server)
@@ -104,6 +316,7 @@ void RegisterTemplateLib()
 	MODULE_FUNCTION(GetCacheTemplate)
 	MODULE_FUNCTION(GetAllLocalCacheTemplates)
 	MODULE_FUNCTION(GetLocalCacheTemplate)
+	MODULE_FUNCTION(Find)
 	END_MODULE()
 }
 
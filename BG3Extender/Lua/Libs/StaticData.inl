@@ -109,6 +109,306 @@ Array<Guid> GetAllGuidResources(lua_State* L, ExtResourceManagerType type)
 #undef FOR_RESOURCE_TYPE
 
 
+// Hash index over the values of one property of a GUID resource type.
+// Entries are positions in the resource map, so the index is only usable while the map is unchanged
+// and no property of the resource type was written since the index was built.
+struct GuidResourceFieldIndex
+{
+	void const* Keys{ nullptr };
+	void const* Values{ nullptr };
+	uint32_t Size{ 0 };
+	uint32_t WriteGeneration{ 0 };
+	std::unordered_map<STDString, Vector<uint32_t>> Resources;
+};
+
+// GUID resource banks are shared by the client and the server, so their indexes are too
+std::mutex gGuidResourceIndexLock;
+std::unordered_map<ExtResourceManagerType, std::unordered_map<FixedString, GuidResourceFieldIndex>> gGuidResourceIndexes;
+
+// Converts a primitive value (or enum label) to the key used by field indexes.
+// Returns false for values that can't be indexed.
+bool GetFieldIndexKey(lua_State* L, int index, STDString& key)
+{
+	index = lua_absindex(L, index);
+	switch (lua_type(L, index)) {
+	case LUA_TBOOLEAN:
+		key = lua_toboolean(L, index) ? "b1" : "b0";
+		return true;
+
+	case LUA_TNUMBER:
+	{
+		// Floats with an integral value match the equivalent integer, like in Lua comparisons
+		int isInteger{ 0 };
+		auto value = lua_tointegerx(L, index, &isInteger);
+		char buf[32];
+		if (isInteger) {
+			snprintf(buf, sizeof(buf), "i%lld", (long long)value);
+		} else {
+			snprintf(buf, sizeof(buf), "f%.17g", (double)lua_tonumber(L, index));
+		}
+
+		key = buf;
+		return true;
+	}
+
+	case LUA_TSTRING:
+	{
+		std::size_t length;
+		auto str = lua_tolstring(L, index, &length);
+		key = "s";
+		key.append(str, length);
+		return true;
+	}
+
+	case LUA_TUSERDATA:
+	case LUA_TLIGHTCPPOBJECT:
+	case LUA_TCPPOBJECT:
+	{
+		CppValueMetadata meta;
+		if (lua_try_get_cppvalue(L, index, EnumValueMetatable::MetaTag, meta)) {
+			key = "s";
+			key += EnumValueMetatable::GetLabel(meta).GetString();
+			return true;
+		}
+
+		return false;
+	}
+
+	default:
+		return false;
+	}
+}
+
+// Returns the index of the specified property; the index is (re)built if the resource map changed
+// or a property of the resource type was written since the last call.
+// Must be called with gGuidResourceIndexLock held.
+template <class T>
+GuidResourceFieldIndex const& GetGuidResourceFieldIndex(lua_State* L, MultiHashMap<Guid, T>& resources, RawPropertyAccessors const& prop)
+{
+	auto const& pm = StaticLuaPropertyMap<T>::PropertyMap;
+	auto& index = gGuidResourceIndexes[T::ResourceManagerType][prop.Name];
+	void const* values = resources.size() > 0 ? &resources.values()[0] : nullptr;
+	auto writeGeneration = pm.WriteGeneration.load(std::memory_order_relaxed);
+	if (index.Keys == resources.keys().raw_buf() && index.Values == values && index.Size == resources.size()
+		&& index.WriteGeneration == writeGeneration) {
+		return index;
+	}
+
+	index.Keys = resources.keys().raw_buf();
+	index.Values = values;
+	index.Size = resources.size();
+	index.WriteGeneration = writeGeneration;
+	index.Resources.clear();
+
+	StackCheck _(L);
+	auto lifetime = GetCurrentLifetime(L);
+	STDString key;
+	for (uint32_t i = 0; i < resources.size(); i++) {
+		if (pm.GetRawProperty(L, lifetime, &resources.values()[i], prop) == PropertyOperationResult::Success) {
+			if (GetFieldIndexKey(L, -1, key)) {
+				index.Resources[key].push_back(i);
+			}
+
+			lua_pop(L, 1);
+		}
+	}
+
+	return index;
+}
+
+template <class T>
+UserReturn FindGuidResourcesTyped(lua_State* L)
+{
+	auto& helpers = gExtender->GetServer().GetEntityHelpers();
+	auto resourceMgr = helpers.GetResourceManager<T>();
+	if (!resourceMgr) {
+		LuaError("Resource manager not available for this resource type");
+		push(L, nullptr);
+		return 1;
+	}
+
+	auto const& pm = StaticLuaPropertyMap<T>::PropertyMap;
+	Vector<std::pair<RawPropertyAccessors const*, STDString>> filters;
+	lua_pushnil(L);
+	while (lua_next(L, 2) != 0) {
+		// Filter keys are property names; other key types (eg. array-style filter tables) would be
+		// converted to strings and fail with a misleading "no property named '1'" error
+		if (lua_type(L, -2) != LUA_TSTRING) {
+			return luaL_error(L, "Filter keys must be property names, got %s", lua_typename(L, lua_type(L, -2)));
+		}
+
+		auto field = get<FixedString>(L, -2);
+		auto prop = pm.Properties.try_get(field);
+		if (!prop) {
+			return luaL_error(L, "Resource type '%s' has no property named '%s'", pm.Name.GetString(), field.GetString());
+		}
+
+		STDString key;
+		if (!GetFieldIndexKey(L, -1, key)) {
+			return luaL_error(L, "Filter value of property '%s' must be a string, number, boolean or enum value", field.GetString());
+		}
+
+		filters.push_back(std::make_pair(prop, std::move(key)));
+		lua_pop(L, 1);
+	}
+
+	auto& resources = (*resourceMgr)->Resources;
+	Vector<uint32_t> matches;
+	if (filters.empty()) {
+		for (uint32_t i = 0; i < resources.size(); i++) {
+			matches.push_back(i);
+		}
+	} else {
+		std::lock_guard _(gGuidResourceIndexLock);
+
+		// Resources are returned in the order of the shortest list; the other lists only count hits
+		Vector<Vector<uint32_t> const*> lists;
+		Vector<uint32_t> const* shortest{ nullptr };
+		for (auto const& filter : filters) {
+			auto const& index = GetGuidResourceFieldIndex(L, resources, *filter.first);
+			auto it = index.Resources.find(filter.second);
+			if (it == index.Resources.end()) {
+				lists.clear();
+				break;
+			}
+
+			lists.push_back(&it->second);
+			if (!shortest || it->second.size() < shortest->size()) {
+				shortest = &it->second;
+			}
+		}
+
+		if (lists.size() == 1) {
+			matches = *shortest;
+		} else if (!lists.empty()) {
+			Vector<uint32_t> hits(resources.size(), 0);
+			for (auto list : lists) {
+				for (auto i : *list) {
+					hits[i]++;
+				}
+			}
+
+			for (auto i : *shortest) {
+				if (hits[i] == lists.size()) {
+					matches.push_back(i);
+				}
+			}
+		}
+	}
+
+	lua_createtable(L, (int)matches.size(), 0);
+	for (std::size_t i = 0; i < matches.size(); i++) {
+		push(L, resources.keys()[matches[i]]);
+		lua_rawseti(L, -2, (lua_Integer)i + 1);
+	}
+
+	return 1;
+}
+
+template <class T>
+UserReturn GetAllGuidResourceFieldsTyped(lua_State* L)
+{
+	auto& helpers = gExtender->GetServer().GetEntityHelpers();
+	auto resourceMgr = helpers.GetResourceManager<T>();
+	if (!resourceMgr) {
+		LuaError("Resource manager not available for this resource type");
+		push(L, nullptr);
+		return 1;
+	}
+
+	auto const& pm = StaticLuaPropertyMap<T>::PropertyMap;
+	Vector<RawPropertyAccessors const*> fields;
+	auto numFields = lua_rawlen(L, 2);
+	for (lua_Integer i = 1; i <= (lua_Integer)numFields; i++) {
+		lua_rawgeti(L, 2, i);
+		auto field = get<FixedString>(L, -1);
+		lua_pop(L, 1);
+
+		auto prop = pm.Properties.try_get(field);
+		if (!prop) {
+			return luaL_error(L, "Resource type '%s' has no property named '%s'", pm.Name.GetString(), field.GetString());
+		}
+
+		fields.push_back(prop);
+	}
+
+	auto& resources = (*resourceMgr)->Resources;
+	auto lifetime = GetCurrentLifetime(L);
+	lua_createtable(L, 0, (int)resources.size());
+	for (uint32_t i = 0; i < resources.size(); i++) {
+		push(L, resources.keys()[i]);
+		lua_createtable(L, 0, (int)fields.size());
+		for (auto field : fields) {
+			push(L, field->Name);
+			if (pm.GetRawProperty(L, lifetime, &resources.values()[i], *field) == PropertyOperationResult::Success) {
+				lua_rawset(L, -3);
+			} else {
+				lua_pop(L, 1);
+			}
+		}
+
+		lua_rawset(L, -3);
+	}
+
+	return 1;
+}
+
+#define FOR_RESOURCE_TYPE(ty) case ty::ResourceManagerType: return FindGuidResourcesTyped<ty>(L);
+
+/// <summary>
+/// Returns the UUIDs of all static data resources of the specified type whose properties match the filter.
+/// Filter values can be strings, numbers, booleans or enum labels; an empty filter matches all resources.
+/// Property values are indexed on first use. The indexes of a resource type are rebuilt on the next call
+/// when resources were added or removed, or when any property of that resource type was written.
+/// 
+/// Example:
+/// ```lua
+/// local subclasses = Ext.StaticData.Find("ClassDescription", {ParentGuid = "a865965f-501b-46e9-9eaa-7748e8c04d09"})
+/// ```
+/// </summary>
+UserReturn FindGuidResources(lua_State* L, ExtResourceManagerType type)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	switch (type) {
+	FOR_EACH_GUID_RESOURCE_TYPE()
+
+	default:
+		LuaError("Resource type not supported: " << type);
+		push(L, nullptr);
+		return 1;
+	}
+}
+
+#undef FOR_RESOURCE_TYPE
+
+#define FOR_RESOURCE_TYPE(ty) case ty::ResourceManagerType: return GetAllGuidResourceFieldsTyped<ty>(L);
+
+/// <summary>
+/// Returns the specified properties of all static data resources of a type, in a table keyed by resource UUID.
+/// 
+/// Example:
+/// ```lua
+/// for uuid, progression in pairs(Ext.StaticData.GetAllFields("Progression", {"Name", "TableUUID", "Level"})) do
+///     ...
+/// end
+/// ```
+/// </summary>
+UserReturn GetAllGuidResourceFields(lua_State* L, ExtResourceManagerType type)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	switch (type) {
+	FOR_EACH_GUID_RESOURCE_TYPE()
+
+	default:
+		LuaError("Resource type not supported: " << type);
+		push(L, nullptr);
+		return 1;
+	}
+}
+
+#undef FOR_RESOURCE_TYPE
+
+
 ResourceBank* GetCurrentResourceBank()
 {
 	auto resMgr = GetStaticSymbols().ls__gGlobalResourceManager;
@@ -171,6 +471,8 @@ void RegisterStaticDataLib()
 	BEGIN_MODULE()
 	MODULE_NAMED_FUNCTION("Get", GetGuidResource)
 	MODULE_NAMED_FUNCTION("GetAll", GetAllGuidResources)
+	MODULE_NAMED_FUNCTION("Find", FindGuidResources)
+	MODULE_NAMED_FUNCTION("GetAllFields", GetAllGuidResourceFields)
 	END_MODULE()
 
 	DECLARE_MODULE(Resource, Both)
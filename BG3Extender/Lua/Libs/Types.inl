@@ -279,6 +279,794 @@ void Unserialize(lua_State* L)
 	luaL_error(L, "Don't know how to unserialize objects of this type");
 }
 
+void CheckSetPropertyResult(lua_State* L, GenericPropertyMap const& pm, FixedString const& prop, PropertyOperationResult result)
+{
+	switch (result) {
+	case PropertyOperationResult::Success:
+		break;
+
+	case PropertyOperationResult::NoSuchProperty:
+		luaL_error(L, "Cannot set property %s::%s - property does not exist", pm.Name.GetString(), prop.GetString());
+		break;
+
+	case PropertyOperationResult::ReadOnly:
+		luaL_error(L, "Cannot set property %s::%s - property is read-only", pm.Name.GetString(), prop.GetString());
+		break;
+
+	case PropertyOperationResult::UnsupportedType:
+		luaL_error(L, "Cannot set property %s::%s - cannot write properties of this type", pm.Name.GetString(), prop.GetString());
+		break;
+
+	default:
+		luaL_error(L, "Cannot set property %s::%s - unknown error", pm.Name.GetString(), prop.GetString());
+		break;
+	}
+}
+
+// Compact binary encoding of the values produced by property serializers.
+// Used by SerializeBinary/UnserializeBinary to avoid building a Lua table for the whole object
+// and running it through JSON when the serialized form is only stored or transmitted.
+class BinaryValueWriter
+{
+public:
+	static constexpr uint32_t MaxDepth = 64;
+
+	enum class Tag : uint8_t
+	{
+		Nil = 0,
+		False = 1,
+		True = 2,
+		Integer = 3,
+		Number = 4,
+		String = 5,
+		Array = 6,
+		Table = 7
+	};
+
+	std::string Buf;
+
+	void WriteVarint(uint64_t value)
+	{
+		while (value >= 0x80) {
+			Buf.push_back((char)((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+
+		Buf.push_back((char)value);
+	}
+
+	void WriteRaw(void const* data, std::size_t size)
+	{
+		Buf.append(reinterpret_cast<char const*>(data), size);
+	}
+
+	void WriteInteger(int64_t value)
+	{
+		Buf.push_back((char)Tag::Integer);
+		WriteVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+	}
+
+	void WriteValue(lua_State* L, int index, uint32_t depth = 0)
+	{
+		if (depth > MaxDepth) {
+			luaL_error(L, "Recursion depth exceeded while serializing object");
+		}
+
+		index = lua_absindex(L, index);
+		switch (lua_type(L, index)) {
+		case LUA_TNIL:
+			Buf.push_back((char)Tag::Nil);
+			break;
+
+		case LUA_TBOOLEAN:
+			Buf.push_back((char)(lua_toboolean(L, index) ? Tag::True : Tag::False));
+			break;
+
+		case LUA_TNUMBER:
+			if (lua_isinteger(L, index)) {
+				WriteInteger(lua_tointeger(L, index));
+			} else {
+				auto value = lua_tonumber(L, index);
+				Buf.push_back((char)Tag::Number);
+				WriteRaw(&value, sizeof(value));
+			}
+			break;
+
+		case LUA_TSTRING:
+		{
+			std::size_t len;
+			auto str = lua_tolstring(L, index, &len);
+			Buf.push_back((char)Tag::String);
+			WriteVarint(len);
+			WriteRaw(str, len);
+			break;
+		}
+
+		case LUA_TTABLE:
+			WriteTable(L, index, depth);
+			break;
+
+		case LUA_TLIGHTCPPOBJECT:
+		case LUA_TCPPOBJECT:
+		{
+			CppValueMetadata meta;
+			if (lua_try_get_cppvalue(L, index, EnumValueMetatable::MetaTag, meta)) {
+				WriteInteger((int64_t)EnumValueMetatable::GetValue(meta));
+			} else if (lua_try_get_cppvalue(L, index, BitfieldValueMetatable::MetaTag, meta)) {
+				WriteInteger((int64_t)BitfieldValueMetatable::GetValue(meta));
+			} else {
+				luaL_error(L, "Cannot serialize values of type '%s'", luaL_typename(L, index));
+			}
+			break;
+		}
+
+		default:
+			luaL_error(L, "Cannot serialize values of type '%s'", luaL_typename(L, index));
+			break;
+		}
+	}
+
+private:
+	void WriteTable(lua_State* L, int index, uint32_t depth)
+	{
+		auto arraySize = lua_rawlen(L, index);
+		std::size_t numPairs{ 0 };
+		lua_pushnil(L);
+		while (lua_next(L, index) != 0) {
+			numPairs++;
+			lua_pop(L, 1);
+		}
+
+		// Only tables whose keys are exactly 1..n can be encoded as arrays;
+		// a matching pair count alone doesn't rule out holes with extra non-integer keys
+		bool isArray = (numPairs == arraySize);
+		if (isArray) {
+			lua_pushnil(L);
+			while (lua_next(L, index) != 0) {
+				lua_pop(L, 1);
+				if (!lua_isinteger(L, -1)) {
+					isArray = false;
+				} else {
+					auto key = lua_tointeger(L, -1);
+					isArray = (key >= 1 && (std::size_t)key <= arraySize);
+				}
+
+				if (!isArray) {
+					lua_pop(L, 1);
+					break;
+				}
+			}
+		}
+
+		if (isArray) {
+			Buf.push_back((char)Tag::Array);
+			WriteVarint(arraySize);
+			for (lua_Integer i = 1; i <= (lua_Integer)arraySize; i++) {
+				lua_rawgeti(L, index, i);
+				WriteValue(L, -1, depth + 1);
+				lua_pop(L, 1);
+			}
+		} else {
+			Buf.push_back((char)Tag::Table);
+			WriteVarint(numPairs);
+			lua_pushnil(L);
+			while (lua_next(L, index) != 0) {
+				WriteValue(L, -2, depth + 1);
+				WriteValue(L, -1, depth + 1);
+				lua_pop(L, 1);
+			}
+		}
+	}
+};
+
+class BinaryValueReader
+{
+public:
+	using Tag = BinaryValueWriter::Tag;
+
+	BinaryValueReader(lua_State* L, std::string_view buf)
+		: L_(L), buf_(buf)
+	{}
+
+	bool AtEnd() const
+	{
+		return pos_ == buf_.size();
+	}
+
+	uint64_t ReadVarint()
+	{
+		uint64_t value{ 0 };
+		for (unsigned shift = 0; shift < 64; shift += 7) {
+			auto byte = (uint8_t)ReadBytes(1)[0];
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				return value;
+			}
+		}
+
+		Fail();
+		return 0;
+	}
+
+	char const* ReadBytes(std::size_t size)
+	{
+		if (buf_.size() - pos_ < size) {
+			Fail();
+		}
+
+		auto ptr = buf_.data() + pos_;
+		pos_ += size;
+		return ptr;
+	}
+
+	// Pushes the next value onto the Lua stack
+	void ReadValue(uint32_t depth = 0)
+	{
+		if (depth > BinaryValueWriter::MaxDepth) {
+			Fail();
+		}
+
+		luaL_checkstack(L_, 3, "Out of stack space while unserializing");
+		switch ((Tag)*ReadBytes(1)) {
+		case Tag::Nil:
+			lua_pushnil(L_);
+			break;
+
+		case Tag::False:
+			lua_pushboolean(L_, 0);
+			break;
+
+		case Tag::True:
+			lua_pushboolean(L_, 1);
+			break;
+
+		case Tag::Integer:
+		{
+			auto value = ReadVarint();
+			lua_pushinteger(L_, (lua_Integer)((value >> 1) ^ (~(value & 1) + 1)));
+			break;
+		}
+
+		case Tag::Number:
+		{
+			double value;
+			memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+			lua_pushnumber(L_, value);
+			break;
+		}
+
+		case Tag::String:
+		{
+			auto len = ReadVarint();
+			auto str = ReadBytes(len);
+			lua_pushlstring(L_, str, len);
+			break;
+		}
+
+		case Tag::Array:
+		{
+			auto size = ReadVarint();
+			lua_createtable(L_, (int)std::min<uint64_t>(size, buf_.size() - pos_), 0);
+			for (lua_Integer i = 1; i <= (lua_Integer)size; i++) {
+				ReadValue(depth + 1);
+				lua_rawseti(L_, -2, i);
+			}
+			break;
+		}
+
+		case Tag::Table:
+		{
+			auto size = ReadVarint();
+			lua_createtable(L_, 0, (int)std::min<uint64_t>(size, buf_.size() - pos_));
+			for (uint64_t i = 0; i < size; i++) {
+				ReadValue(depth + 1);
+				ReadValue(depth + 1);
+				if (lua_isnil(L_, -2)) {
+					Fail();
+				}
+				lua_rawset(L_, -3);
+			}
+			break;
+		}
+
+		default:
+			Fail();
+		}
+	}
+
+	[[noreturn]] void Fail()
+	{
+		luaL_error(L_, "Malformed binary data at offset %d", (int)pos_);
+		std::abort();
+	}
+
+private:
+	lua_State* L_;
+	std::string_view buf_;
+	std::size_t pos_{ 0 };
+};
+
+static constexpr char BinarySerializationMagic[4] = { 'S', 'E', 'B', 1 };
+
+// Hash of the layout of a type; data is only accepted by UnserializeBinary if the
+// property indices it was written with still refer to the same properties
+uint64_t GetBinarySchemaHash(GenericPropertyMap const& pm)
+{
+	STDString schema{ pm.Name.GetStringView() };
+	for (auto it : pm.IterableProperties) {
+		schema += ";";
+		schema += it.Key().GetStringView();
+		schema += "=";
+		schema += std::to_string(it.Value()).c_str();
+	}
+
+	uint64_t hash[2];
+	MurmurHash3_x64_128(schema.data(), (int)schema.size(), 0, hash);
+	return hash[0] ^ hash[1];
+}
+
+uint64_t GetBinarySchemaHash(TypeInformation const& containerType)
+{
+	auto name = containerType.TypeName.GetStringView();
+	uint64_t hash[2];
+	MurmurHash3_x64_128(name.data(), (int)name.size(), 0, hash);
+	return hash[0] ^ hash[1];
+}
+
+/// <summary>
+/// Serializes an object or container into a binary string.
+/// The result can only be unserialized into objects of the same type using `UnserializeBinary`.
+/// </summary>
+/// <param name="object">Object to serialize</param>
+UserReturn SerializeBinary(lua_State* L)
+{
+	CppObjectMetadata meta;
+	if (lua_type(L, 1) != LUA_TLIGHTCPPOBJECT) {
+		return luaL_error(L, "Don't know how to serialize objects of this type");
+	}
+
+	lua_get_cppobject(L, 1, meta);
+	if (!meta.Lifetime.IsAlive(L)) {
+		return luaL_error(L, "Attempted to serialize an object whose lifetime has expired");
+	}
+
+	BinaryValueWriter writer;
+	writer.WriteRaw(BinarySerializationMagic, sizeof(BinarySerializationMagic));
+
+	switch (meta.MetatableTag) {
+		case MetatableTag::ObjectProxyByRef:
+		{
+			auto& pm = LightObjectProxyByRefMetatable::GetPropertyMap(meta);
+			auto schemaHash = GetBinarySchemaHash(pm);
+			writer.WriteRaw(&schemaHash, sizeof(schemaHash));
+
+			// Fields are written as (property index, value) pairs; the value of each property is
+			// encoded and popped before the next one is serialized
+			for (auto it : pm.IterableProperties) {
+				auto const& prop = pm.Properties.values()[it.Value()];
+				if (prop.Serialize != nullptr) {
+					if (prop.Serialize(L, meta.Ptr, prop) == PropertyOperationResult::Success) {
+						writer.WriteVarint(it.Value());
+						writer.WriteValue(L, -1);
+						lua_pop(L, 1);
+					}
+				}
+			}
+			break;
+		}
+
+		case MetatableTag::ArrayProxy:
+		{
+			auto impl = ArrayProxyMetatable::GetImpl(meta);
+			auto schemaHash = GetBinarySchemaHash(impl->GetContainerType());
+			writer.WriteRaw(&schemaHash, sizeof(schemaHash));
+			impl->Serialize(L, meta);
+			writer.WriteValue(L, -1);
+			lua_pop(L, 1);
+			break;
+		}
+
+		case MetatableTag::MapProxy:
+		{
+			auto impl = MapProxyMetatable::GetImpl(meta);
+			auto schemaHash = GetBinarySchemaHash(impl->GetContainerType());
+			writer.WriteRaw(&schemaHash, sizeof(schemaHash));
+			impl->Serialize(L, meta);
+			writer.WriteValue(L, -1);
+			lua_pop(L, 1);
+			break;
+		}
+
+		case MetatableTag::SetProxy:
+		{
+			auto impl = SetProxyMetatable::GetImpl(meta);
+			auto schemaHash = GetBinarySchemaHash(impl->GetContainerType());
+			writer.WriteRaw(&schemaHash, sizeof(schemaHash));
+			impl->Serialize(L, meta);
+			writer.WriteValue(L, -1);
+			lua_pop(L, 1);
+			break;
+		}
+
+		default:
+			return luaL_error(L, "Don't know how to serialize objects of this type");
+	}
+
+	lua_pushlstring(L, writer.Buf.data(), writer.Buf.size());
+	return 1;
+}
+
+/// <summary>
+/// Updates an object or container from a binary string created using `SerializeBinary`.
+/// </summary>
+/// <param name="object">Object to update</param>
+/// <param name="data">Serialized data</param>
+void UnserializeBinary(lua_State* L)
+{
+	std::size_t len;
+	auto data = luaL_checklstring(L, 2, &len);
+	if (lua_type(L, 1) != LUA_TLIGHTCPPOBJECT) {
+		luaL_error(L, "Don't know how to unserialize objects of this type");
+	}
+
+	CppObjectMetadata meta;
+	lua_get_cppobject(L, 1, meta);
+	if (!meta.Lifetime.IsAlive(L)) {
+		luaL_error(L, "Attempted to unserialize into an object whose lifetime has expired");
+	}
+
+	BinaryValueReader reader(L, std::string_view(data, len));
+	if (memcmp(reader.ReadBytes(sizeof(BinarySerializationMagic)), BinarySerializationMagic, sizeof(BinarySerializationMagic)) != 0) {
+		luaL_error(L, "Data was not created by SerializeBinary or was created by an incompatible version");
+	}
+
+	uint64_t schemaHash;
+	memcpy(&schemaHash, reader.ReadBytes(sizeof(schemaHash)), sizeof(schemaHash));
+
+	auto checkSchema = [L](uint64_t expected, uint64_t actual, FixedString const& typeName) {
+		if (expected != actual) {
+			luaL_error(L, "Serialized data does not match the layout of type '%s'", typeName.GetString());
+		}
+	};
+
+	switch (meta.MetatableTag) {
+		case MetatableTag::ObjectProxyByRef:
+		{
+			auto& pm = LightObjectProxyByRefMetatable::GetPropertyMap(meta);
+			checkSchema(GetBinarySchemaHash(pm), schemaHash, pm.Name);
+			while (!reader.AtEnd()) {
+				auto propIndex = reader.ReadVarint();
+				if (propIndex >= pm.Properties.size()) {
+					reader.Fail();
+				}
+
+				auto const& prop = pm.Properties.values()[(uint32_t)propIndex];
+				reader.ReadValue();
+				if (lua_type(L, -1) != LUA_TNIL) {
+					// Read-only properties are serialized too; they're skipped the same way as in Unserialize
+					auto result = prop.Set(L, meta.Ptr, lua_absindex(L, -1), prop);
+					if (result != PropertyOperationResult::ReadOnly) {
+						CheckSetPropertyResult(L, pm, prop.Name, result);
+					}
+				}
+				lua_pop(L, 1);
+			}
+			break;
+		}
+
+		case MetatableTag::ArrayProxy:
+		{
+			auto impl = ArrayProxyMetatable::GetImpl(meta);
+			checkSchema(GetBinarySchemaHash(impl->GetContainerType()), schemaHash, impl->GetContainerType().TypeName);
+			reader.ReadValue();
+			impl->Unserialize(L, meta, lua_absindex(L, -1));
+			lua_pop(L, 1);
+			break;
+		}
+
+		case MetatableTag::MapProxy:
+		{
+			auto impl = MapProxyMetatable::GetImpl(meta);
+			checkSchema(GetBinarySchemaHash(impl->GetContainerType()), schemaHash, impl->GetContainerType().TypeName);
+			reader.ReadValue();
+			impl->Unserialize(L, meta, lua_absindex(L, -1));
+			lua_pop(L, 1);
+			break;
+		}
+
+		case MetatableTag::SetProxy:
+		{
+			auto impl = SetProxyMetatable::GetImpl(meta);
+			checkSchema(GetBinarySchemaHash(impl->GetContainerType()), schemaHash, impl->GetContainerType().TypeName);
+			reader.ReadValue();
+			impl->Unserialize(L, meta, lua_absindex(L, -1));
+			lua_pop(L, 1);
+			break;
+		}
+
+		default:
+			luaL_error(L, "Don't know how to unserialize objects of this type");
+	}
+}
+
+// Precompiled list of property accessors of a type.
+// Used for reading or writing multiple properties of an object without a name lookup for each property.
+class PropertySelector : public Userdata<PropertySelector>
+{
+public:
+	static char const* const MetatableName;
+
+	PropertySelector(GenericPropertyMap const& pm)
+		: PropertyMap(pm)
+	{}
+
+	GenericPropertyMap const& PropertyMap;
+	Vector<RawPropertyAccessors const*> Properties;
+	// Names not in the property map; these are resolved by the fallback getter/setter of the type on each access
+	Vector<FixedString> FallbackProperties;
+};
+
+char const* const PropertySelector::MetatableName = "bg3se::PropertySelector";
+
+// Returns the property map of the object if it can be accessed in bulk,
+// or null if the object should be accessed through its metatable one property at a time.
+GenericPropertyMap const* GetBulkPropertyTarget(lua_State* L, int index, CppObjectMetadata& meta)
+{
+	if (lua_type(L, index) != LUA_TLIGHTCPPOBJECT) {
+		return nullptr;
+	}
+
+	lua_get_cppobject(L, index, meta);
+	if (meta.MetatableTag != MetatableTag::ObjectProxyByRef) {
+		return nullptr;
+	}
+
+	auto const& pm = LightObjectProxyByRefMetatable::GetPropertyMap(meta);
+	if (!meta.Lifetime.IsAlive(L)) {
+		luaL_error(L, "Attempted to access '%s' whose lifetime has expired", pm.Name.GetString());
+	}
+
+	return &pm;
+}
+
+void CheckGetPropertyResult(lua_State* L, GenericPropertyMap const& pm, FixedString const& prop, PropertyOperationResult result)
+{
+	switch (result) {
+	case PropertyOperationResult::Success:
+		break;
+
+	case PropertyOperationResult::NoSuchProperty:
+		luaL_error(L, "Cannot get property %s::%s - property does not exist", pm.Name.GetString(), prop.GetString());
+		break;
+
+	default:
+		luaL_error(L, "Cannot get property %s::%s - unknown error", pm.Name.GetString(), prop.GetString());
+		break;
+	}
+}
+
+void CheckSelectorTarget(lua_State* L, PropertySelector const& selector, GenericPropertyMap const& pm)
+{
+	if (!pm.IsA(selector.PropertyMap.RegistryIndex)) {
+		luaL_error(L, "Selector for type '%s' cannot be used with objects of type '%s'",
+			selector.PropertyMap.Name.GetString(), pm.Name.GetString());
+	}
+}
+
+FixedString GetPropertyNameKey(lua_State* L, int index)
+{
+	// Keys are property names; other key types (eg. array-style tables) would be converted to strings
+	// and fail with a misleading "property does not exist" error, so they're rejected up front
+	if (lua_type(L, index) != LUA_TSTRING) {
+		luaL_error(L, "Property names must be strings, got %s", lua_typename(L, lua_type(L, index)));
+	}
+
+	return get<FixedString>(L, index);
+}
+
+/// <summary>
+/// Creates a selector that can be passed to `GetProperties` and `SetProperties` to read or write
+/// the specified properties of objects of type `typeName`.
+/// Property names are resolved once when the selector is created instead of on each access.
+/// </summary>
+/// <param name="typeName">Name of the object type the selector applies to</param>
+/// <param name="properties">Names of properties to select</param>
+UserReturn CreatePropertySelector(lua_State* L, FixedString const& typeName)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	auto const& type = TypeInformationRepository::GetInstance().GetType(typeName);
+	if (type.Kind != LuaTypeId::Object || type.PropertyMap == nullptr) {
+		return luaL_error(L, "Type '%s' is not an object type", typeName.GetString());
+	}
+
+	auto const& pm = *type.PropertyMap;
+	auto selector = PropertySelector::New(L, pm);
+	auto numProps = (int)lua_rawlen(L, 2);
+	selector->Properties.reserve(numProps);
+	for (int i = 1; i <= numProps; i++) {
+		lua_rawgeti(L, 2, i);
+		auto name = get<FixedString>(L, -1);
+		lua_pop(L, 1);
+
+		auto prop = pm.Properties.try_get(name);
+		if (prop != nullptr) {
+			selector->Properties.push_back(prop);
+		} else if (pm.FallbackGetter != nullptr || pm.FallbackSetter != nullptr) {
+			selector->FallbackProperties.push_back(name);
+		} else {
+			return luaL_error(L, "Type '%s' has no property named '%s'", typeName.GetString(), name.GetString());
+		}
+	}
+
+	return 1;
+}
+
+/// <summary>
+/// Reads multiple properties of an object in a single call.
+/// Properties are either specified by a list of property names, or by a selector created using `CreatePropertySelector`.
+/// The values are written to `output` if specified; otherwise a new table is returned.
+/// </summary>
+/// <param name="object">Object to read</param>
+/// <param name="properties">List of property names or property selector</param>
+/// <param name="output">Table to write values to (optional)</param>
+UserReturn GetProperties(lua_State* L)
+{
+	auto selector = PropertySelector::AsUserData(L, 2);
+	if (selector == nullptr) {
+		luaL_checktype(L, 2, LUA_TTABLE);
+	}
+
+	int numProps = selector 
+		? (int)(selector->Properties.size() + selector->FallbackProperties.size()) 
+		: (int)lua_rawlen(L, 2);
+	if (lua_type(L, 3) == LUA_TTABLE) {
+		lua_settop(L, 3);
+	} else {
+		lua_settop(L, 2);
+		lua_createtable(L, 0, numProps);
+	}
+
+	CppObjectMetadata meta;
+	auto pm = GetBulkPropertyTarget(L, 1, meta);
+
+	if (pm == nullptr) {
+		// Objects without a property map (eg. stats entries, containers) are read through their metatables
+		auto getByName = [L](FixedString const& name) {
+			push(L, name);
+			lua_pushvalue(L, -1);
+			lua_gettable(L, 1);
+			lua_rawset(L, 3);
+		};
+
+		if (selector) {
+			for (auto prop : selector->Properties) {
+				getByName(prop->Name);
+			}
+
+			for (auto const& name : selector->FallbackProperties) {
+				getByName(name);
+			}
+		} else {
+			for (int i = 1; i <= numProps; i++) {
+				lua_rawgeti(L, 2, i);
+				lua_pushvalue(L, -1);
+				lua_gettable(L, 1);
+				lua_rawset(L, 3);
+			}
+		}
+
+		return 1;
+	}
+
+	if (selector) {
+		CheckSelectorTarget(L, *selector, *pm);
+
+		for (auto prop : selector->Properties) {
+			push(L, prop->Name);
+			CheckGetPropertyResult(L, *pm, prop->Name, pm->GetRawProperty(L, meta.Lifetime, meta.Ptr, *prop));
+			lua_rawset(L, 3);
+		}
+
+		for (auto const& name : selector->FallbackProperties) {
+			push(L, name);
+			CheckGetPropertyResult(L, *pm, name, pm->GetRawProperty(L, meta.Lifetime, meta.Ptr, name));
+			lua_rawset(L, 3);
+		}
+	} else {
+		for (int i = 1; i <= numProps; i++) {
+			lua_rawgeti(L, 2, i);
+			auto name = get<FixedString>(L, -1);
+			CheckGetPropertyResult(L, *pm, name, pm->GetRawProperty(L, meta.Lifetime, meta.Ptr, name));
+			lua_rawset(L, 3);
+		}
+	}
+
+	return 1;
+}
+
+/// <summary>
+/// Writes multiple properties of an object in a single call.
+/// If a selector is specified, only the selected properties are read from `values`; properties missing from `values` are left unchanged.
+/// Properties that aren't in the property map of the type are written using the fallback setter of the type, if it has one.
+/// </summary>
+/// <param name="object">Object to update</param>
+/// <param name="values">Table of property name - value pairs</param>
+/// <param name="selector">Property selector created using `CreatePropertySelector` (optional)</param>
+void SetProperties(lua_State* L)
+{
+	luaL_checktype(L, 2, LUA_TTABLE);
+	auto selector = PropertySelector::AsUserData(L, 3);
+	lua_settop(L, 2);
+
+	CppObjectMetadata meta;
+	auto pm = GetBulkPropertyTarget(L, 1, meta);
+
+	if (pm == nullptr) {
+		// Objects without a property map (eg. stats entries, containers) are written through their metatables
+		auto setByName = [L](FixedString const& name) {
+			push(L, name);
+			lua_pushvalue(L, -1);
+			lua_rawget(L, 2);
+			if (!lua_isnil(L, -1)) {
+				lua_settable(L, 1);
+			} else {
+				lua_pop(L, 2);
+			}
+		};
+
+		if (selector) {
+			for (auto prop : selector->Properties) {
+				setByName(prop->Name);
+			}
+
+			for (auto const& name : selector->FallbackProperties) {
+				setByName(name);
+			}
+		} else {
+			lua_pushnil(L);
+			while (lua_next(L, 2) != 0) {
+				lua_pushvalue(L, -2);
+				lua_insert(L, -2);
+				lua_settable(L, 1);
+			}
+		}
+
+		return;
+	}
+
+	if (selector) {
+		CheckSelectorTarget(L, *selector, *pm);
+
+		for (auto prop : selector->Properties) {
+			push(L, prop->Name);
+			lua_rawget(L, 2);
+			if (!lua_isnil(L, -1)) {
+				CheckSetPropertyResult(L, *pm, prop->Name, prop->Set(L, meta.Ptr, lua_absindex(L, -1), *prop));
+			}
+
+			lua_pop(L, 1);
+		}
+
+		for (auto const& name : selector->FallbackProperties) {
+			push(L, name);
+			lua_rawget(L, 2);
+			if (!lua_isnil(L, -1)) {
+				CheckSetPropertyResult(L, *pm, name, pm->SetRawProperty(L, meta.Ptr, name, lua_absindex(L, -1)));
+			}
+
+			lua_pop(L, 1);
+		}
+	} else {
+		// Unknown keys are routed through the fallback setter of the type by SetRawProperty()
+		lua_pushnil(L);
+		while (lua_next(L, 2) != 0) {
+			auto name = GetPropertyNameKey(L, -2);
+			CheckSetPropertyResult(L, *pm, name, pm->SetRawProperty(L, meta.Ptr, name, lua_absindex(L, -1)));
+			lua_pop(L, 1);
+		}
+	}
+}
+
 UserReturn Construct(lua_State* L, FixedString const& typeName)
 {
 	auto const& type = TypeInformationRepository::GetInstance().GetType(typeName);
@@ -308,7 +1096,12 @@ void RegisterTypesLib()
 	MODULE_FUNCTION(Validate)
 	MODULE_FUNCTION(Serialize)
 	MODULE_FUNCTION(Unserialize)
+	MODULE_FUNCTION(SerializeBinary)
+	MODULE_FUNCTION(UnserializeBinary)
 	MODULE_FUNCTION(Construct)
+	MODULE_FUNCTION(CreatePropertySelector)
+	MODULE_FUNCTION(GetProperties)
+	MODULE_FUNCTION(SetProperties)
 	END_MODULE()
 }
 
@@ -67,8 +67,10 @@ void RegisterUserVariable(lua_State* L, FixedString name)
 	vars.RegisterPrototype(name, proto);
 }
 
-void SyncUserVariables()
+void SyncUserVariables(lua_State* L)
 {
+	// Cached values are only written to the global store on demand; they must be written before syncing
+	State::FromLua(L)->GetVariableManager().Flush(L, true);
 	auto& vars = gExtender->GetCurrentExtensionState()->GetUserVariables();
 	vars.Flush(true);
 }
@@ -123,8 +125,9 @@ UserReturn GetModVariables(lua_State* L, Guid moduleUuid)
 	return 1;
 }
 
-void SyncModVariables()
+void SyncModVariables(lua_State* L)
 {
+	State::FromLua(L)->GetModVariableManager().Flush(L, true);
 	auto& vars = gExtender->GetCurrentExtensionState()->GetModVariables();
 	vars.Flush(true);
 }
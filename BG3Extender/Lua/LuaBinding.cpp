@@ -275,6 +275,9 @@ namespace bg3se::lua
 
 	void State::Shutdown()
 	{
+		// Write pending values to the global store, as the cache is discarded with the Lua state
+		variableManager_.Flush(L, true);
+		modVariableManager_.Flush(L, true);
 		variableManager_.Invalidate();
 		modVariableManager_.Invalidate();
 	}
@@ -401,6 +404,9 @@ namespace bg3se::lua
 
 	void State::OnLevelLoading()
 	{
+		// Variables that aren't synced are only written to the global store by forced flushes
+		variableManager_.Flush(L, true);
+		modVariableManager_.Flush(L, true);
 		variableManager_.Invalidate();
 		modVariableManager_.Invalidate();
 	}
@@ -417,8 +423,8 @@ namespace bg3se::lua
 		ThrowEvent("Tick", params, false, 0);
 
 		lua_gc(L, LUA_GCSTEP, 10);
-		variableManager_.Flush();
-		modVariableManager_.Flush();
+		variableManager_.Flush(L, false);
+		modVariableManager_.Flush(L, false);
 	}
 
 	void State::OnStatsStructureLoaded()
@@ -452,6 +458,7 @@ namespace bg3se::lua
 
 		try {
 			Restriction restriction(*this, restrictions);
+			UserVariableSyncScope varSync(*this);
 			evt.Name = FixedString(eventName);
 			evt.CanPreventAction = canPreventAction;
 
@@ -236,6 +236,21 @@ namespace bg3se::lua
 		uint32_t oldFlags_;
 	};
 
+	// Coalesces SyncOnWrite user variable syncs performed while the scope is active,
+	// so variables written multiple times are only sent once
+	class UserVariableSyncScope : Noncopyable<UserVariableSyncScope>
+	{
+	public:
+		inline UserVariableSyncScope(State& state)
+			: vars_(state.GetVariableManager().GetGlobal().GetSyncWriter()),
+			modVars_(state.GetModVariableManager().GetGlobal().GetSyncWriter())
+		{}
+
+	private:
+		UserVariableSyncBatch vars_;
+		UserVariableSyncBatch modVars_;
+	};
+
 	int GetCellInfo(lua_State* L);
 
 	/*int NewDamageList(lua_State* L);
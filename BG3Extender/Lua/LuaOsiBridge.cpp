@@ -87,7 +87,8 @@ namespace bg3se::esv::lua
 		return nullptr;
 	}
 
-	void LuaToOsi(lua_State * L, int i, TypedValue & tv, ValueType osiType, bool allowNil)
+	// Converts a Lua value to an Osiris value where the base type of the Osiris type was already resolved by the caller
+	void LuaToOsiResolved(lua_State * L, int i, TypedValue & tv, ValueType osiType, ValueType baseType, bool allowNil)
 	{
 		tv.VMT = gExtender->GetServer().Osiris().GetGlobals().TypedValueVMT;
 		tv.TypeId = (uint32_t)osiType;
@@ -98,7 +99,7 @@ namespace bg3se::esv::lua
 			return;
 		}
 
-		switch (GetBaseType(osiType)) {
+		switch (baseType) {
 		case ValueType::Integer:
 			tv.Value.Int32 = (int32_t)LuaToInt(L, i, type);
 			break;
@@ -134,6 +135,11 @@ namespace bg3se::esv::lua
 		}
 	}
 
+	void LuaToOsi(lua_State * L, int i, TypedValue & tv, ValueType osiType, bool allowNil)
+	{
+		LuaToOsiResolved(L, i, tv, osiType, GetBaseType(osiType), allowNil);
+	}
+
 	TypedValue * LuaToOsi(lua_State * L, int i, ValueType osiType, bool allowNil)
 	{
 		auto tv = new TypedValue();
@@ -141,7 +147,7 @@ namespace bg3se::esv::lua
 		return tv;
 	}
 
-	void LuaToOsi(lua_State * L, int i, OsiArgumentValue & arg, ValueType osiType, bool allowNil, bool reuseStrings)
+	void LuaToOsiResolved(lua_State * L, int i, OsiArgumentValue & arg, ValueType osiType, ValueType baseType, bool allowNil = false, bool reuseStrings = false)
 	{
 		arg.TypeId = osiType;
 		auto type = lua_type(L, i);
@@ -150,7 +156,7 @@ namespace bg3se::esv::lua
 			return;
 		}
 
-		switch (GetBaseType(osiType)) {
+		switch (baseType) {
 		case ValueType::Integer:
 			arg.Int32 = (int32_t)LuaToInt(L, i, type);
 			break;
@@ -190,6 +196,42 @@ namespace bg3se::esv::lua
 		}
 	}
 
+	void LuaToOsi(lua_State * L, int i, OsiArgumentValue & arg, ValueType osiType, bool allowNil, bool reuseStrings)
+	{
+		LuaToOsiResolved(L, i, arg, osiType, GetBaseType(osiType), allowNil, reuseStrings);
+	}
+
+	void OsiToLuaResolved(lua_State * L, OsiArgumentValue const & arg, ValueType baseType)
+	{
+		if (arg.TypeId == ValueType::None) {
+			lua_pushnil(L);
+			return;
+		}
+
+		switch (baseType) {
+		case ValueType::Integer:
+			push(L, arg.Int32);
+			break;
+
+		case ValueType::Integer64:
+			push(L, arg.Int64);
+			break;
+
+		case ValueType::Real:
+			push(L, arg.Float);
+			break;
+
+		case ValueType::String:
+		case ValueType::GuidString:
+			push(L, arg.String);
+			break;
+
+		default:
+			luaL_error(L, "Unhandled Osi argument type %d", arg.TypeId);
+			break;
+		}
+	}
+
 	void OsiToLua(lua_State * L, OsiArgumentValue const & arg)
 	{
 		switch (GetBaseType(arg.TypeId)) {
@@ -220,6 +262,57 @@ namespace bg3se::esv::lua
 		}
 	}
 
+	// Pushes an Osiris value where the base type of the Osiris type was already resolved by the caller
+	void OsiToLuaResolved(lua_State * L, TypedValue const & tv, ValueType baseType)
+	{
+		if (tv.TypeId == (uint32_t)ValueType::None) {
+			lua_pushnil(L);
+			return;
+		}
+
+		switch (baseType) {
+		case ValueType::Integer:
+			push(L, tv.Value.Int32);
+			break;
+
+		case ValueType::Integer64:
+			push(L, tv.Value.Int64);
+			break;
+
+		case ValueType::Real:
+			push(L, tv.Value.Float);
+			break;
+
+		case ValueType::String:
+		case ValueType::GuidString:
+			push(L, tv.Value.String);
+			break;
+
+		default:
+			luaL_error(L, "Unhandled Osi TypedValue type %d", tv.TypeId);
+			break;
+		}
+	}
+
+	bool IsLuaTypeCompatible(int luaType, ValueType baseType)
+	{
+		switch (baseType) {
+		case ValueType::Integer:
+		case ValueType::Integer64:
+			return luaType == LUA_TNUMBER || luaType == LUA_TLIGHTUSERDATA;
+
+		case ValueType::Real:
+			return luaType == LUA_TNUMBER;
+
+		case ValueType::String:
+		case ValueType::GuidString:
+			return luaType == LUA_TSTRING;
+
+		default:
+			return false;
+		}
+	}
+
 	void OsiToLua(lua_State * L, TypedValue const & tv)
 	{
 		switch (GetBaseType((ValueType)tv.TypeId)) {
@@ -306,6 +399,7 @@ namespace bg3se::esv::lua
 			adapter_.Id = adapter->Id;
 		}
 
+		CompileSignature(func);
 		function_ = func;
 		state_ = &state;
 		return true;
@@ -316,6 +410,35 @@ namespace bg3se::esv::lua
 		function_ = nullptr;
 	}
 
+	void OsiFunction::CompileSignature(Function const * func)
+	{
+		auto sig = func->Signature;
+		auto numParams = (uint32_t)sig->Params->Params.Size;
+
+		signature_.NumParams = numParams;
+		signature_.NumInParams = 0;
+		signature_.Params.clear();
+		signature_.InParams.clear();
+		signature_.OutParams.clear();
+		signature_.Params.reserve(numParams);
+
+		auto argType = sig->Params->Params.Head->Next;
+		for (uint32_t i = 0; i < numParams; i++) {
+			auto type = (ValueType)argType->Item.Type;
+			// Out param flags are only present for queries; other function types have no OUT params
+			auto isOut = i < sig->OutParamList.Count * 8 && sig->OutParamList.isOutParam(i);
+			signature_.Params.push_back(CompiledParam{ type, GetBaseType(type), isOut });
+			if (isOut) {
+				signature_.OutParams.push_back(i);
+			} else {
+				signature_.InParams.push_back(i);
+				signature_.NumInParams++;
+			}
+
+			argType = argType->Next;
+		}
+	}
+
 	int OsiFunction::LuaCall(lua_State * L)
 	{
 		if (function_ == nullptr) {
@@ -412,6 +535,147 @@ namespace bg3se::esv::lua
 		return 1;
 	}
 
+	int OsiFunction::LuaGetAll(lua_State * L)
+	{
+		if (!IsBound()) {
+			return luaL_error(L, "Attempted to read an unbound Osiris database");
+		}
+
+		if (!IsDB()) {
+			return luaL_error(L, "Attempted to read function that's not a database");
+		}
+
+		if (state_->RestrictionFlags & State::RestrictOsiris) {
+			return luaL_error(L, "Attempted to read Osiris database in restricted context");
+		}
+
+		auto db = function_->Node.Get()->Database.Get();
+		auto numColumns = signature_.NumParams;
+		auto numRows = (int)db->Facts.Size;
+
+		lua_checkstack(L, (int)numColumns + 2);
+		lua_createtable(L, (int)numColumns, 0);
+		auto columnsIndex = lua_gettop(L);
+		for (uint32_t col = 0; col < numColumns; col++) {
+			lua_createtable(L, numRows, 0);
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, columnsIndex, col + 1);
+		}
+
+		auto head = db->Facts.Head;
+		auto current = head->Next;
+		int row = 1;
+		while (current != head) {
+			auto const& tuple = current->Item;
+			for (uint32_t col = 0; col < numColumns && col < tuple.Size; col++) {
+				OsiToLuaResolved(L, tuple.Values[col], signature_.Params[col].BaseType);
+				lua_rawseti(L, columnsIndex + 1 + col, row);
+			}
+
+			row++;
+			current = current->Next;
+		}
+
+		// Columns may contain nil values, so the row count is stored explicitly in 'n' (like table.pack())
+		for (uint32_t col = 0; col < numColumns; col++) {
+			push(L, row - 1);
+			lua_setfield(L, columnsIndex + 1 + col, "n");
+		}
+
+		lua_pop(L, (int)numColumns);
+		return 1;
+	}
+
+	void OsiFunction::ValidateRows(lua_State * L, int rowsIndex, uint32_t numRows, bool allowNil)
+	{
+		auto numColumns = signature_.NumParams;
+		for (uint32_t row = 1; row <= numRows; row++) {
+			lua_rawgeti(L, rowsIndex, row);
+			if (lua_type(L, -1) != LUA_TTABLE) {
+				luaL_error(L, "Row %d of '%s' must be a table, got %s",
+					row, function_->Signature->Name, lua_typename(L, lua_type(L, -1)));
+			}
+
+			for (uint32_t col = 0; col < numColumns; col++) {
+				lua_rawgeti(L, -1, col + 1);
+				auto type = lua_type(L, -1);
+				if (!(allowNil && type == LUA_TNIL) && !IsLuaTypeCompatible(type, signature_.Params[col].BaseType)) {
+					luaL_error(L, "Row %d, column %d of '%s' has incompatible type %s",
+						row, col + 1, function_->Signature->Name, lua_typename(L, type));
+				}
+				lua_pop(L, 1);
+			}
+
+			lua_pop(L, 1);
+		}
+	}
+
+	int OsiFunction::LuaInsertMany(lua_State * L, int rowsIndex, bool deleteTuples)
+	{
+		if (!IsBound()) {
+			return luaL_error(L, "Attempted to write an unbound Osiris database");
+		}
+
+		if (!IsDB()) {
+			return luaL_error(L, "Attempted to write function that's not a database");
+		}
+
+		if (state_->RestrictionFlags & State::RestrictOsiris) {
+			return luaL_error(L, "Attempted to write Osiris database in restricted context");
+		}
+
+		luaL_checktype(L, rowsIndex, LUA_TTABLE);
+		auto numRows = (uint32_t)lua_rawlen(L, rowsIndex);
+		if (numRows == 0) {
+			push(L, 0);
+			return 1;
+		}
+
+		auto node = function_->Node.Get();
+		if (node == nullptr) {
+			return luaL_error(L, "Function has no node");
+		}
+
+		// All rows are type checked once per batch, so a bad row won't leave the database partially updated
+		auto numColumns = signature_.NumParams;
+		ValidateRows(L, rowsIndex, numRows, deleteTuples);
+
+		OsiArgumentListPin<TypedValue> tvs(state_->Osiris().GetTypedValuePool(), numColumns);
+		OsiArgumentListPin<ListNode<TypedValue *>> nodes(state_->Osiris().GetTypedValueNodePool(), numColumns + 1);
+
+		for (uint32_t row = 1; row <= numRows; row++) {
+			lua_rawgeti(L, rowsIndex, row);
+
+			TuplePtrLL tuple;
+			auto & args = tuple.Items;
+			args.Init(nodes.Args());
+
+			auto prev = args.Head;
+			for (uint32_t col = 0; col < numColumns; col++) {
+				auto tv = tvs.Args() + col;
+				lua_rawgeti(L, -1, col + 1);
+				auto const& param = signature_.Params[col];
+				LuaToOsiResolved(L, -1, *tv, param.Type, param.BaseType, deleteTuples);
+				lua_pop(L, 1);
+
+				auto listNode = nodes.Args() + col + 1;
+				args.Insert(tv, listNode, prev);
+				prev = listNode;
+			}
+
+			lua_pop(L, 1);
+
+			if (deleteTuples) {
+				node->DeleteTuple(&tuple);
+			} else {
+				node->InsertTuple(&tuple);
+			}
+		}
+
+		push(L, numRows);
+		return 1;
+	}
+
 	int OsiFunction::LuaDelete(lua_State * L)
 	{
 		if (!IsBound()) {
@@ -526,22 +790,22 @@ namespace bg3se::esv::lua
 
 	void OsiFunction::OsiCall(lua_State * L)
 	{
-		auto funcArgs = function_->Signature->Params->Params.Size;
+		auto funcArgs = signature_.NumParams;
 		int numArgs = lua_gettop(L);
 		if (numArgs - 1 != funcArgs) {
 			luaL_error(L, "Incorrect number of arguments for '%s'; expected %d, got %d",
 				function_->Signature->Name, funcArgs, numArgs - 1);
 		}
 
-		OsiArgumentListPin<OsiArgumentDesc> args(state_->Osiris().GetArgumentDescPool(), (uint32_t)funcArgs);
-		auto argType = function_->Signature->Params->Params.Head->Next;
+		OsiArgumentListPin<OsiArgumentDesc> args(state_->Osiris().GetArgumentDescPool(), funcArgs);
 		for (uint32_t i = 0; i < funcArgs; i++) {
 			auto arg = args.Args() + i;
 			if (i > 0) {
 				args.Args()[i - 1].NextParam = arg;
 			}
-			LuaToOsi(L, i + 2, arg->Value, (ValueType)argType->Item.Type);
-			argType = argType->Next;
+
+			auto const& param = signature_.Params[i];
+			LuaToOsiResolved(L, i + 2, arg->Value, param.Type, param.BaseType);
 		}
 
 		gExtender->GetServer().Osiris().GetWrappers().Call.CallWithHooks(function_->GetHandle(), funcArgs == 0 ? nullptr : args.Args());
@@ -587,7 +851,7 @@ namespace bg3se::esv::lua
 
 	void OsiFunction::OsiInsert(lua_State * L, bool deleteTuple)
 	{
-		auto funcArgs = function_->Signature->Params->Params.Size;
+		auto funcArgs = signature_.NumParams;
 		int numArgs = lua_gettop(L);
 		if (numArgs - 1 != funcArgs) {
 			luaL_error(L, "Incorrect number of arguments for '%s'; expected %d, got %d",
@@ -598,22 +862,21 @@ namespace bg3se::esv::lua
 			luaL_error(L, "Function has no node");
 		}
 
-		OsiArgumentListPin<TypedValue> tvs(state_->Osiris().GetTypedValuePool(), (uint32_t)funcArgs);
-		OsiArgumentListPin<ListNode<TypedValue *>> nodes(state_->Osiris().GetTypedValueNodePool(), (uint32_t)funcArgs + 1);
+		OsiArgumentListPin<TypedValue> tvs(state_->Osiris().GetTypedValuePool(), funcArgs);
+		OsiArgumentListPin<ListNode<TypedValue *>> nodes(state_->Osiris().GetTypedValueNodePool(), funcArgs + 1);
 
 		TuplePtrLL tuple;
 		auto & args = tuple.Items;
-		auto argType = function_->Signature->Params->Params.Head->Next;
 		args.Init(nodes.Args());
 
 		auto prev = args.Head;
 		for (uint32_t i = 0; i < funcArgs; i++) {
 			auto tv = tvs.Args() + i;
-			LuaToOsi(L, i + 2, *tv, (ValueType)argType->Item.Type, deleteTuple);
+			auto const& param = signature_.Params[i];
+			LuaToOsiResolved(L, i + 2, *tv, param.Type, param.BaseType, deleteTuple);
 			auto node = nodes.Args() + i + 1;
 			args.Insert(tv, node, prev);
 			prev = node;
-			argType = argType->Next;
 		}
 
 		auto node = function_->Node.Get();
@@ -624,11 +887,32 @@ namespace bg3se::esv::lua
 		}
 	}
 
+	template <class Fun>
+	int OsiFunction::PushQueryResults(lua_State * L, bool succeeded, Fun const& pushOutParam)
+	{
+		auto outParams = signature_.NumParams - signature_.NumInParams;
+		if (outParams == 0) {
+			push(L, succeeded);
+			return 1;
+		}
+
+		if (succeeded) {
+			for (auto paramIndex : signature_.OutParams) {
+				pushOutParam(paramIndex);
+			}
+		} else {
+			for (uint32_t i = 0; i < outParams; i++) {
+				lua_pushnil(L);
+			}
+		}
+
+		return (int)outParams;
+	}
+
 	int OsiFunction::OsiQuery(lua_State * L)
 	{
-		auto outParams = function_->Signature->OutParamList.numOutParams();
-		auto numParams = function_->Signature->Params->Params.Size;
-		auto inParams = numParams - outParams;
+		auto numParams = signature_.NumParams;
+		auto inParams = signature_.NumInParams;
 
 		int numArgs = lua_gettop(L);
 		if (numArgs - 1 != inParams) {
@@ -636,50 +920,35 @@ namespace bg3se::esv::lua
 				function_->Signature->Name, inParams, numArgs - 1);
 		}
 
-		OsiArgumentListPin<OsiArgumentDesc> args(state_->Osiris().GetArgumentDescPool(), (uint32_t)numParams);
-		auto argType = function_->Signature->Params->Params.Head->Next;
-		uint32_t inputArg = 2;
+		OsiArgumentListPin<OsiArgumentDesc> args(state_->Osiris().GetArgumentDescPool(), numParams);
 		for (uint32_t i = 0; i < numParams; i++) {
 			auto arg = args.Args() + i;
 			if (i > 0) {
 				args.Args()[i - 1].NextParam = arg;
 			}
 
-			if (function_->Signature->OutParamList.isOutParam(i)) {
-				arg->Value.TypeId = (ValueType)argType->Item.Type;
-			} else {
-				LuaToOsi(L, inputArg++, arg->Value, (ValueType)argType->Item.Type);
+			auto const& param = signature_.Params[i];
+			if (param.IsOut) {
+				arg->Value.TypeId = param.Type;
 			}
+		}
 
-			argType = argType->Next;
+		for (uint32_t i = 0; i < inParams; i++) {
+			auto paramIndex = signature_.InParams[i];
+			auto const& param = signature_.Params[paramIndex];
+			LuaToOsiResolved(L, i + 2, args.Args()[paramIndex].Value, param.Type, param.BaseType);
 		}
 
 		bool handled = gExtender->GetServer().Osiris().GetWrappers().Query.CallWithHooks(function_->GetHandle(), numParams == 0 ? nullptr : args.Args());
-		if (outParams == 0) {
-			push(L, handled);
-			return 1;
-		} else {
-			if (handled) {
-				for (uint32_t i = 0; i < numParams; i++) {
-					if (function_->Signature->OutParamList.isOutParam(i)) {
-						OsiToLua(L, args.Args()[i].Value);
-					}
-				}
-			} else {
-				for (uint32_t i = 0; i < outParams; i++) {
-					lua_pushnil(L);
-				}
-			}
-
-			return outParams;
-		}
+		return PushQueryResults(L, handled, [&](uint32_t paramIndex) {
+			OsiToLuaResolved(L, args.Args()[paramIndex].Value, signature_.Params[paramIndex].BaseType);
+		});
 	}
 
 	int OsiFunction::OsiUserQuery(lua_State * L)
 	{
-		auto outParams = function_->Signature->OutParamList.numOutParams();
-		auto numParams = function_->Signature->Params->Params.Size;
-		auto inParams = numParams - outParams;
+		auto numParams = signature_.NumParams;
+		auto inParams = signature_.NumInParams;
 
 		int numArgs = lua_gettop(L);
 		if (numArgs - 1 != inParams) {
@@ -687,65 +956,37 @@ namespace bg3se::esv::lua
 				function_->Signature->Name, inParams, numArgs - 1);
 		}
 
-		OsiArgumentListPin<ListNode<TupleLL::Item>> nodes(state_->Osiris().GetTupleNodePool(), (uint32_t)numParams + 1);
+		OsiArgumentListPin<ListNode<TupleLL::Item>> nodes(state_->Osiris().GetTupleNodePool(), numParams + 1);
 
 		VirtTupleLL tuple;
-		
 		auto & args = tuple.Data.Items;
-		auto argType = function_->Signature->Params->Params.Head->Next;
 		args.Init(nodes.Args());
 
+		auto typedValueVMT = gExtender->GetServer().Osiris().GetGlobals().TypedValueVMT;
 		auto prev = args.Head;
-		uint32_t inputArgIndex = 0;
 		for (uint32_t i = 0; i < numParams; i++) {
 			auto node = nodes.Args() + i + 1;
 			args.Insert(node, prev);
 			node->Item.Index = i;
-			if (!function_->Signature->OutParamList.isOutParam(i)) {
-				LuaToOsi(L, inputArgIndex + 2, node->Item.Value, (ValueType)argType->Item.Type);
-				inputArgIndex++;
-			} else {
-				node->Item.Value.VMT = gExtender->GetServer().Osiris().GetGlobals().TypedValueVMT;
-				node->Item.Value.TypeId = (uint32_t)ValueType::None;
-			}
-
+			node->Item.Value.VMT = typedValueVMT;
+			node->Item.Value.TypeId = (uint32_t)ValueType::None;
 			prev = node;
-			argType = argType->Next;
+		}
+
+		for (uint32_t i = 0; i < inParams; i++) {
+			auto paramIndex = signature_.InParams[i];
+			auto const& param = signature_.Params[paramIndex];
+			LuaToOsiResolved(L, i + 2, nodes.Args()[paramIndex + 1].Item.Value, param.Type, param.BaseType, false);
 		}
 
 		auto node = (*gExtender->GetServer().Osiris().GetGlobals().Nodes)->Db.Elements[function_->Node.Id - 1];
 		bool valid = node->IsValid(&tuple, adapter_.Id);
-		if (valid) {
-			if (outParams > 0) {
-				auto retType = function_->Signature->Params->Params.Head->Next;
-				auto ret = args.Head->Next;
-				for (uint32_t i = 0; i < numParams; i++) {
-					if (function_->Signature->OutParamList.isOutParam(i)) {
-						OsiToLua(L, ret->Item.Value);
-					}
+		return PushQueryResults(L, valid, [&](uint32_t paramIndex) {
+			OsiToLuaResolved(L, nodes.Args()[paramIndex + 1].Item.Value, signature_.Params[paramIndex].BaseType);
+		});
+	}
 
-					ret = ret->Next;
-					retType = retType->Next;
-				}
 
-				return outParams;
-			} else {
-				push(L, true);
-				return 1;
-			}
-		} else {
-			if (outParams > 0) {
-				for (uint32_t i = 0; i < outParams; i++) {
-					lua_pushnil(L);
-				}
-
-				return outParams;
-			} else {
-				push(L, false);
-				return 1;
-			}
-		}
-	}
 
 
 
@@ -764,6 +1005,15 @@ namespace bg3se::esv::lua
 		lua_pushcfunction(L, &LuaDeferredNotification);
 		lua_setfield(L, -2, "Defer");
 
+		lua_pushcfunction(L, &LuaGetAll);
+		lua_setfield(L, -2, "GetAll");
+
+		lua_pushcfunction(L, &LuaInsertMany);
+		lua_setfield(L, -2, "InsertMany");
+
+		lua_pushcfunction(L, &LuaDeleteMany);
+		lua_setfield(L, -2, "DeleteMany");
+
 		lua_setfield(L, -2, "__index");
 	}
 
@@ -774,6 +1024,7 @@ namespace bg3se::esv::lua
 	void OsiFunctionNameProxy::UnbindAll()
 	{
 		functions_.clear();
+		dbArity_ = 0;
 	}
 
 	bool OsiFunctionNameProxy::BeforeCall(lua_State * L)
@@ -861,6 +1112,74 @@ namespace bg3se::esv::lua
 		return func->LuaDeferredNotification(L);
 	}
 
+	int OsiFunctionNameProxy::LuaGetAll(lua_State * L)
+	{
+		auto self = OsiFunctionNameProxy::CheckUserData(L, 1);
+		if (!self->BeforeCall(L)) return 1;
+
+		auto func = self->GetDatabase(L, 2);
+		return func->LuaGetAll(L);
+	}
+
+	int OsiFunctionNameProxy::LuaInsertMany(lua_State * L)
+	{
+		auto self = OsiFunctionNameProxy::CheckUserData(L, 1);
+		if (!self->BeforeCall(L)) return 1;
+
+		auto func = self->GetDatabase(L, 3);
+		return func->LuaInsertMany(L, 2, false);
+	}
+
+	int OsiFunctionNameProxy::LuaDeleteMany(lua_State * L)
+	{
+		auto self = OsiFunctionNameProxy::CheckUserData(L, 1);
+		if (!self->BeforeCall(L)) return 1;
+
+		auto func = self->GetDatabase(L, 3);
+		return func->LuaInsertMany(L, 2, true);
+	}
+
+	OsiFunction * OsiFunctionNameProxy::GetDatabase(lua_State * L, int arityIndex)
+	{
+		if (!lua_isnoneornil(L, arityIndex)) {
+			auto arity = (uint32_t)luaL_checkinteger(L, arityIndex);
+			auto func = TryGetFunction(arity);
+			if (func == nullptr || !func->IsDB()) {
+				luaL_error(L, "No database named '%s(%d)' exists", name_.c_str(), arity);
+			}
+
+			return func;
+		}
+
+		if (dbArity_ != 0) {
+			auto func = TryGetFunction(dbArity_);
+			if (func != nullptr && func->IsDB()) {
+				return func;
+			}
+		}
+
+		// No arity specified; the name must resolve to exactly one database
+		uint32_t foundArity{ 0 };
+		for (uint32_t arity = 1; arity <= MaxDatabaseColumns; arity++) {
+			auto func = TryGetFunction(arity);
+			if (func != nullptr && func->IsDB()) {
+				if (foundArity != 0) {
+					luaL_error(L, "Database name '%s' is ambiguous (found %d and %d columns); pass the number of columns explicitly",
+						name_.c_str(), foundArity, arity);
+				}
+
+				foundArity = arity;
+			}
+		}
+
+		if (foundArity == 0) {
+			luaL_error(L, "No database named '%s' exists", name_.c_str());
+		}
+
+		dbArity_ = foundArity;
+		return &functions_[foundArity];
+	}
+
 	OsiFunction * OsiFunctionNameProxy::TryGetFunction(uint32_t arity)
 	{
 		if (functions_.size() > arity
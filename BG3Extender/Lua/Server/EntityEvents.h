@@ -2,6 +2,8 @@
 
 BEGIN_NS(lua)
 
+class ProtectedCallBatch;
+
 class EntityReplicationEventHooks
 {
 public:
@@ -37,8 +39,8 @@ private:
 	Array<ReplicationHooks> hookedReplicationComponents_;
 	SaltedPool<ReplicationHook> subscriptions_;
 
-	void OnEntityReplication(ecs::EntityWorld& world, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type);
-	void CallHandler(EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type, ReplicationHook const& hook);
+	void OnEntityReplication(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type);
+	void CallHandler(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type, ReplicationHook const& hook);
 	ReplicationHooks& AddComponentType(ecs::ReplicationTypeIndex type);
 };
 
@@ -82,17 +82,19 @@ void EntityReplicationEventHooks::OnEntityReplication(ecs::EntityWorld& world)
 {
 	if (!world.Replication || !world.Replication->Dirty) return;
 
+	// All replication events of this pass are dispatched in one batch
+	std::optional<ProtectedCallBatch> batch;
 	for (unsigned i = 0; i < world.Replication->ComponentPools.size(); i++) {
 		auto const& pool = world.Replication->ComponentPools[i];
 		if (hookedReplicationComponentMask_[i] && pool.size() > 0) {
 			for (auto const& entity : pool) {
-				OnEntityReplication(world, entity.Key(), entity.Value(), i);
+				OnEntityReplication(batch, entity.Key(), entity.Value(), i);
 			}
 		}
 	}
 }
 
-void EntityReplicationEventHooks::OnEntityReplication(ecs::EntityWorld& world, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type)
+void EntityReplicationEventHooks::OnEntityReplication(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type)
 {
 	auto& hooks = hookedReplicationComponents_[type.Value()];
 	auto word1 = *flags.GetBuf();
@@ -101,7 +103,7 @@ void EntityReplicationEventHooks::OnEntityReplication(ecs::EntityWorld& world, E
 	for (auto index : hooks.GlobalHooks) {
 		auto hook = subscriptions_.Find(index);
 		if (hook != nullptr && (hook->InvalidationFlags & word1) != 0) {
-			CallHandler(entity, flags, type, *hook);
+			CallHandler(batch, entity, flags, type, *hook);
 		}
 	}
 
@@ -110,23 +112,21 @@ void EntityReplicationEventHooks::OnEntityReplication(ecs::EntityWorld& world, E
 		for (auto index : *entityHooks) {
 			auto hook = subscriptions_.Find(index);
 			if (hook != nullptr && (hook->InvalidationFlags & word1) != 0) {
-				CallHandler(entity, flags, type, *hook);
+				CallHandler(batch, entity, flags, type, *hook);
 			}
 		}
 	}
 }
 
-void EntityReplicationEventHooks::CallHandler(EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type, ReplicationHook const& hook)
+void EntityReplicationEventHooks::CallHandler(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, BitSet<> const& flags, ecs::ReplicationTypeIndex type, ReplicationHook const& hook)
 {
-	auto L = state_.GetState();
+	if (!batch) {
+		batch.emplace(state_.GetState(), "Entity replication event dispatch");
+	}
+
 	auto componentType = state_.GetEntitySystemHelpers()->GetComponentType(type);
 	auto word1 = *flags.GetBuf();
-	hook.Hook.Push();
-	Ref func(L, lua_absindex(L, -1));
-
-	ProtectedFunctionCaller<std::tuple<EntityHandle, ExtComponentType, uint64_t>, void> caller{ func, std::tuple(entity, *componentType, word1) };
-	caller.Call(L, "Entity replication event dispatch");
-	lua_pop(L, 1);
+	batch->Call(hook.Hook, entity, *componentType, word1);
 }
 
 END_NS()
@@ -1,38 +1,82 @@
 #include <stdafx.h>
 #include <Lua/Server/LuaOsirisBinding.h>
 #include <Extender/ScriptExtender.h>
+#include <Lua/Shared/LuaMethodCallHelpers.h>
 
 BEGIN_NS(esv::lua)
 
-PendingCallbackManager::~PendingCallbackManager()
+OsirisSubscriberTable::SubscriberList OsirisSubscriberTable::Get(uint32_t id) const
 {
-	for (auto entry : cache_) {
-		GameDelete(entry);
+	auto it = subscribers_.find(id);
+	if (it != subscribers_.end()) {
+		return it->second;
+	} else {
+		return {};
+	}
+}
+
+void OsirisSubscriberTable::Add(uint32_t id, uint32_t subscriber)
+{
+	auto list = std::make_shared<Vector<uint32_t>>();
+	auto it = subscribers_.find(id);
+	if (it != subscribers_.end()) {
+		list->reserve(it->second->size() + 1);
+		list->insert(list->end(), it->second->begin(), it->second->end());
 	}
+
+	list->push_back(subscriber);
+	subscribers_[id] = std::move(list);
+	SetBit(id, true);
 }
 
-Array<uint32_t>* PendingCallbackManager::Enter(std::unordered_multimap<uint64_t, uint32_t>::iterator& begin,
-	std::unordered_multimap<uint64_t, uint32_t>::iterator& end)
+bool OsirisSubscriberTable::Remove(uint32_t id, uint32_t subscriber)
 {
-	if (depth_ >= cache_.size()) {
-		cache_.push_back(GameAlloc<Array<uint32_t>>());
+	auto it = subscribers_.find(id);
+	if (it == subscribers_.end()) {
+		return false;
 	}
 
-	auto entry = cache_[depth_];
-	entry->clear();
-	depth_++;
+	auto const& current = *it->second;
+	auto pos = std::find(current.begin(), current.end(), subscriber);
+	if (pos == current.end()) {
+		return false;
+	}
 
-	for (auto it = begin; it != end; it++) {
-		entry->Add(it->second);
+	if (current.size() == 1) {
+		subscribers_.erase(it);
+		SetBit(id, false);
+	} else {
+		auto list = std::make_shared<Vector<uint32_t>>();
+		list->reserve(current.size() - 1);
+		list->insert(list->end(), current.begin(), pos);
+		list->insert(list->end(), pos + 1, current.end());
+		it->second = std::move(list);
 	}
 
-	return entry;
+	return true;
 }
 
-void PendingCallbackManager::Exit(Array<uint32_t>* v)
+void OsirisSubscriberTable::Clear()
 {
-	assert(depth_ > 0 && cache_[depth_ - 1] == v);
-	depth_--;
+	bits_.clear();
+	subscribers_.clear();
+}
+
+void OsirisSubscriberTable::SetBit(uint32_t id, bool set)
+{
+	if (id >= MaxDenseId) return;
+
+	auto word = id >> 6;
+	if (word >= bits_.size()) {
+		if (!set) return;
+		bits_.resize(word + 1, 0);
+	}
+
+	if (set) {
+		bits_[word] |= (1ull << (id & 63));
+	} else {
+		bits_[word] &= ~(1ull << (id & 63));
+	}
 }
 
 
@@ -71,22 +115,16 @@ bool OsirisCallbackManager::Unsubscribe(SubscriptionId id)
 	auto sub = subscriptions_.Find(id);
 	if (!sub) return false;
 
-	auto nameIt = nameSubscriberRefs_.find(sub->Signature);
-	while (nameIt != nameSubscriberRefs_.end() && nameIt->first == sub->Signature) {
-		if (nameIt->second == id) {
-			nameSubscriberRefs_.erase(nameIt);
+	auto nameIt = nameSubscriberRefs_.equal_range(sub->Signature);
+	for (auto it = nameIt.first; it != nameIt.second; it++) {
+		if (it->second == id) {
+			nameSubscriberRefs_.erase(it);
 			break;
 		}
 	}
 
 	if (sub->Node) {
-		auto it = nodeSubscriberRefs_.find(*sub->Node);
-		while (it != nodeSubscriberRefs_.end() && it->first == *sub->Node) {
-			if (it->second == id) {
-				nodeSubscriberRefs_.erase(it);
-				break;
-			}
-		}
+		nodeSubscribers_[(unsigned)sub->Node->Phase].Remove(sub->Node->Id, id);
 	}
 
 	sub->Callback.Reset();
@@ -94,37 +132,38 @@ bool OsirisCallbackManager::Unsubscribe(SubscriptionId id)
 	return true;
 }
 
-void OsirisCallbackManager::RunHandlers(uint64_t nodeRef, TuplePtrLL* tuple)
+void OsirisCallbackManager::RunHandlers(OsirisHookPhase phase, uint32_t id, TuplePtrLL* tuple)
 {
 	if (merging_) {
 		return;
 	}
 
-	auto it = nodeSubscriberRefs_.equal_range(nodeRef);
-	if (it.first == nodeSubscriberRefs_.end()) {
+	auto const& table = nodeSubscribers_[(unsigned)phase];
+	if (!table.HasSubscribers(id)) {
 		return;
 	}
 
 	LuaServerPin lua(state_);
 	if (lua) {
-		// Make a copy of the subscriber indices to as the subscriber map iterator can be invalidated
-		// if the Lua handler function registers a new subscriber
-		auto indices = pendingCallbacks_.Enter(it.first, it.second);
-		for (auto index : *indices) {
+		auto L = lua->GetState();
+		StackCheck _(L, 0);
+		UserVariableSyncScope varSync(*lua);
+		ProtectedCallBatch batch(L, "Osiris event handler", true);
+
+		// Hold a reference to the current subscriber list, as the Lua handler may (un)subscribe
+		// and publish a new list for this node
+		auto subscribers = table.Get(id);
+		for (auto index : *subscribers) {
 			auto sub = subscriptions_.Find(index);
 			if (sub) {
-				RunHandler(lua.Get(), sub->Callback, tuple);
+				RunHandler(batch, L, sub->Callback, tuple);
 			}
 		}
-		pendingCallbacks_.Exit(indices);
 	}
 }
 
-void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& func, TuplePtrLL* tuple)
+void OsirisCallbackManager::RunHandler(ProtectedCallBatch& batch, lua_State* L, RegistryEntry const& func, TuplePtrLL* tuple)
 {
-	auto L = lua.GetState();
-	StackCheck _(L, 0);
-	LifetimeStackPin p_(lua.GetStack());
 	int32_t stackArgs = 1;
 	if (tuple != nullptr) {
 		auto node = tuple->Items.Head->Next;
@@ -135,11 +174,8 @@ void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& fu
 	}
 
 	lua_checkstack(L, stackArgs);
-	auto stackSize = lua_gettop(L);
-
-	try {
-		func.Push();
 
+	batch.CallWithPusher(func, [=]() {
 		int32_t numArgs = 0;
 		if (tuple != nullptr) {
 			auto node = tuple->Items.Head->Next;
@@ -150,49 +186,38 @@ void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& fu
 			}
 		}
 
-		if (CallWithTraceback(L, numArgs, 0) != 0) {
-			LuaError("Osiris event handler failed: " << lua_tostring(L, -1));
-			lua_pop(L, 1);
-		}
-	}
-	catch (Exception& e) {
-		auto stackRemaining = lua_gettop(L) - stackSize;
-		if (stackRemaining > 0) {
-			LuaError("Osiris event callback failed: " << lua_tostring(L, -1));
-			lua_pop(L, stackRemaining);
-		} else {
-			LuaError("Internal error during call Osiris event callback: " << e.what());
-		}
-	}
+		return numArgs;
+	});
 }
 
-void OsirisCallbackManager::RunHandlers(uint64_t nodeRef, OsiArgumentDesc* args)
+void OsirisCallbackManager::RunHandlers(OsirisHookPhase phase, uint32_t id, OsiArgumentDesc* args)
 {
-	auto it = nodeSubscriberRefs_.equal_range(nodeRef);
-	if (it.first == nodeSubscriberRefs_.end()) {
+	auto const& table = nodeSubscribers_[(unsigned)phase];
+	if (!table.HasSubscribers(id)) {
 		return;
 	}
 
 	LuaServerPin lua(state_);
 	if (lua) {
-		// Make a copy of the subscriber indices to as the subscriber map iterator can be invalidated
-		// if the Lua handler function registers a new subscriber
-		auto indices = pendingCallbacks_.Enter(it.first, it.second);
-		for (auto index : *indices) {
+		auto L = lua->GetState();
+		StackCheck _(L, 0);
+		UserVariableSyncScope varSync(*lua);
+		ProtectedCallBatch batch(L, "Osiris event handler", true);
+
+		// Hold a reference to the current subscriber list, as the Lua handler may (un)subscribe
+		// and publish a new list for this node
+		auto subscribers = table.Get(id);
+		for (auto index : *subscribers) {
 			auto sub = subscriptions_.Find(index);
 			if (sub) {
-				RunHandler(lua.Get(), sub->Callback, args);
+				RunHandler(batch, L, sub->Callback, args);
 			}
 		}
-		pendingCallbacks_.Exit(indices);
 	}
 }
 
-void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& func, OsiArgumentDesc* args)
+void OsirisCallbackManager::RunHandler(ProtectedCallBatch& batch, lua_State* L, RegistryEntry const& func, OsiArgumentDesc* args)
 {
-	auto L = lua.GetState();
-	StackCheck _(L, 0);
-	LifetimeStackPin _p(lua.GetStack());
 	int32_t stackArgs = 1;
 	auto node = args;
 	while (node) {
@@ -201,11 +226,8 @@ void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& fu
 	}
 
 	lua_checkstack(L, stackArgs);
-	auto stackSize = lua_gettop(L);
-
-	try {
-		func.Push();
 
+	batch.CallWithPusher(func, [=]() {
 		int32_t numArgs = 0;
 		auto node = args;
 		while (node) {
@@ -214,28 +236,18 @@ void OsirisCallbackManager::RunHandler(ServerState& lua, RegistryEntry const& fu
 			numArgs++;
 		}
 
-		if (CallWithTraceback(L, numArgs, 0) != 0) {
-			LuaError("Osiris event handler failed: " << lua_tostring(L, -1));
-			lua_pop(L, 1);
-		}
-	}
-	catch (Exception& e) {
-		auto stackRemaining = lua_gettop(L) - stackSize;
-		if (stackRemaining > 0) {
-			LuaError("Osiris event callback failed: " << lua_tostring(L, -1));
-			lua_pop(L, stackRemaining);
-		}
-		else {
-			LuaError("Internal error during call Osiris event callback: " << e.what());
-		}
-	}
+		return numArgs;
+	});
 }
 
 void OsirisCallbackManager::StoryLoaded()
 {
 	HookOsiris();
 	storyLoaded_ = true;
-	nodeSubscriberRefs_.clear();
+	for (auto& table : nodeSubscribers_) {
+		table.Clear();
+	}
+
 	for (auto const& it : nameSubscriberRefs_) {
 		RegisterNodeHandler(it.first, it.second);
 	}
@@ -277,29 +289,29 @@ void OsirisCallbackManager::RegisterNodeHandler(OsirisHookSignature const& sig,
 		return;
 	}
 
-	uint64_t nodeRef;
+	SubscribedNode nodeRef;
 
 	if (func->Type == FunctionType::Event || func->Type == FunctionType::Call) {
-		nodeRef = func->OsiFunctionId;
+		nodeRef.Id = func->OsiFunctionId;
 		if (sig.type == OsirisHookSignature::BeforeTrigger) {
-			nodeRef |= BeforeFunctionRef;
+			nodeRef.Phase = OsirisHookPhase::FunctionBefore;
 		} else if (sig.type == OsirisHookSignature::AfterTrigger) {
-			nodeRef |= AfterFunctionRef;
+			nodeRef.Phase = OsirisHookPhase::FunctionAfter;
 		} else {
 			OsiWarn("Couldn't register Osiris subscriber for " << sig.name << "/" << sig.arity << ": Delete triggers not supported on events.");
 			return;
 		}
 	} else {
-		nodeRef = func->Node.Id;
-		if (sig.type == OsirisHookSignature::AfterTrigger || sig.type == OsirisHookSignature::AfterDeleteTrigger) {
-			nodeRef |= AfterTriggerNodeRef;
-		}
-		if (sig.type == OsirisHookSignature::BeforeDeleteTrigger || sig.type == OsirisHookSignature::AfterDeleteTrigger) {
-			nodeRef |= DeleteTriggerNodeRef;
+		nodeRef.Id = func->Node.Id;
+		switch (sig.type) {
+		case OsirisHookSignature::BeforeTrigger: nodeRef.Phase = OsirisHookPhase::NodeBefore; break;
+		case OsirisHookSignature::AfterTrigger: nodeRef.Phase = OsirisHookPhase::NodeAfter; break;
+		case OsirisHookSignature::BeforeDeleteTrigger: nodeRef.Phase = OsirisHookPhase::NodeBeforeDelete; break;
+		case OsirisHookSignature::AfterDeleteTrigger: nodeRef.Phase = OsirisHookPhase::NodeAfterDelete; break;
 		}
 	}
 
-	nodeSubscriberRefs_.insert(std::make_pair(nodeRef, handlerId));
+	nodeSubscribers_[(unsigned)nodeRef.Phase].Add(nodeRef.Id, handlerId);
 	auto sub = subscriptions_.Find(handlerId);
 	if (sub) {
 		sub->Node = nodeRef;
@@ -318,57 +330,42 @@ void OsirisCallbackManager::HookOsiris()
 
 void OsirisCallbackManager::InsertPreHook(Node* node, TuplePtrLL* tuple, bool deleted)
 {
-	uint64_t nodeRef = node->Id;
-	if (deleted) {
-		nodeRef |= DeleteTriggerNodeRef;
-	}
-
-	RunHandlers(nodeRef, tuple);
+	RunHandlers(deleted ? OsirisHookPhase::NodeBeforeDelete : OsirisHookPhase::NodeBefore, node->Id, tuple);
 }
 
 void OsirisCallbackManager::InsertPostHook(Node* node, TuplePtrLL* tuple, bool deleted)
 {
-	uint64_t nodeRef = node->Id | AfterTriggerNodeRef;
-	if (deleted) {
-		nodeRef |= DeleteTriggerNodeRef;
-	}
-
-	RunHandlers(nodeRef, tuple);
+	RunHandlers(deleted ? OsirisHookPhase::NodeAfterDelete : OsirisHookPhase::NodeAfter, node->Id, tuple);
 }
 
 void OsirisCallbackManager::CallQueryPreHook(Node* node, OsiArgumentDesc* args)
 {
-	RunHandlers(node->Id, args);
+	RunHandlers(OsirisHookPhase::NodeBefore, node->Id, args);
 }
 
 void OsirisCallbackManager::CallQueryPostHook(Node* node, OsiArgumentDesc* args, bool succeeded)
 {
-	uint64_t nodeRef = node->Id | AfterTriggerNodeRef;
-	RunHandlers(nodeRef, args);
+	RunHandlers(OsirisHookPhase::NodeAfter, node->Id, args);
 }
 
 void OsirisCallbackManager::CallPreHook(uint32_t functionId, OsiArgumentDesc* args)
 {
-	uint64_t nodeRef = functionId | BeforeFunctionRef;
-	RunHandlers(nodeRef, args);
+	RunHandlers(OsirisHookPhase::FunctionBefore, functionId, args);
 }
 
 void OsirisCallbackManager::CallPostHook(uint32_t functionId, OsiArgumentDesc* args, bool succeeded)
 {
-	uint64_t nodeRef = functionId | AfterFunctionRef;
-	RunHandlers(nodeRef, args);
+	RunHandlers(OsirisHookPhase::FunctionAfter, functionId, args);
 }
 
 void OsirisCallbackManager::EventPreHook(Function* node, OsiArgumentDesc* args)
 {
-	uint64_t nodeRef = node->OsiFunctionId | BeforeFunctionRef;
-	RunHandlers(nodeRef, args);
+	RunHandlers(OsirisHookPhase::FunctionBefore, node->OsiFunctionId, args);
 }
 
 void OsirisCallbackManager::EventPostHook(Function* node, OsiArgumentDesc* args)
 {
-	uint64_t nodeRef = node->OsiFunctionId | AfterFunctionRef;
-	RunHandlers(nodeRef, args);
+	RunHandlers(OsirisHookPhase::FunctionAfter, node->OsiFunctionId, args);
 }
 
 
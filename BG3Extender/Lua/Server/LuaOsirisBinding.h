@@ -79,20 +79,48 @@ public:
 	int LuaGet(lua_State * L);
 	int LuaDelete(lua_State * L);
 	int LuaDeferredNotification(lua_State * L);
+	int LuaGetAll(lua_State * L);
+	int LuaInsertMany(lua_State * L, int rowsIndex, bool deleteTuples);
 
 private:
+	struct CompiledParam
+	{
+		ValueType Type;
+		// Alias-resolved type of the parameter
+		ValueType BaseType;
+		bool IsOut;
+	};
+
+	// Flattened function signature that is built once during Bind(),
+	// so calls don't need to walk the Osiris signature list and resolve type aliases
+	struct CompiledSignature
+	{
+		uint32_t NumParams{ 0 };
+		uint32_t NumInParams{ 0 };
+		Vector<CompiledParam> Params;
+		// Indices of IN and OUT params in the parameter list
+		Vector<uint32_t> InParams;
+		Vector<uint32_t> OutParams;
+	};
+
 	Function const * function_{ nullptr };
 	AdapterRef adapter_;
 	ServerState * state_;
+	CompiledSignature signature_;
+
+	void CompileSignature(Function const * func);
 
 	void OsiCall(lua_State * L);
 	void OsiDeferredNotification(lua_State * L);
 	void OsiInsert(lua_State * L, bool deleteTuple);
 	int OsiQuery(lua_State * L);
 	int OsiUserQuery(lua_State * L);
+	template <class Fun>
+	int PushQueryResults(lua_State * L, bool succeeded, Fun const& pushOutParam);
 
 	bool MatchTuple(lua_State * L, int firstIndex, TupleVec const & tuple);
 	void ConstructTuple(lua_State * L, TupleVec const & tuple);
+	void ValidateRows(lua_State * L, int rowsIndex, uint32_t numRows, bool allowNil);
 };
 
 class OsiFunctionNameProxy : public Userdata<OsiFunctionNameProxy>, public Callable
@@ -102,6 +130,9 @@ public:
 	// Maximum number of OUT params that a query can return.
 	// (This setting determines how many function arities we'll check during name lookup)
 	static constexpr uint32_t MaxQueryOutParams = 6;
+	// Maximum number of columns a database can have.
+	// (Used when resolving databases by name only, i.e. without an explicit arity)
+	static constexpr uint32_t MaxDatabaseColumns = 16;
 
 	static void PopulateMetatable(lua_State * L);
 
@@ -115,11 +146,17 @@ private:
 	Vector<OsiFunction> functions_;
 	ServerState & state_;
 	uint32_t generationId_;
+	// Column count of the database resolved by name-only lookups (GetAll, InsertMany, DeleteMany)
+	uint32_t dbArity_{ 0 };
 
 	static int LuaGet(lua_State * L);
 	static int LuaDelete(lua_State * L);
 	static int LuaDeferredNotification(lua_State * L);
+	static int LuaGetAll(lua_State * L);
+	static int LuaInsertMany(lua_State * L);
+	static int LuaDeleteMany(lua_State * L);
 	bool BeforeCall(lua_State * L);
+	OsiFunction * GetDatabase(lua_State * L, int arityIndex);
 	OsiFunction * TryGetFunction(uint32_t arity);
 	OsiFunction * CreateFunctionMapping(uint32_t arity, Function const * func);
 };
@@ -237,19 +274,51 @@ private:
 
 class ServerState;
 
-// Stores an immutable copy of the subscribed handler ID-s during callback evaluation
-// to ensure that changes to the subscriber list don't affect the current list being evaluated
-class PendingCallbackManager
+// Hook phase of an Osiris node or function subscription
+enum class OsirisHookPhase
+{
+	NodeBefore,
+	NodeAfter,
+	NodeBeforeDelete,
+	NodeAfterDelete,
+	FunctionBefore,
+	FunctionAfter,
+	Count
+};
+
+// Subscribers of Osiris nodes (or functions) for a single hook phase.
+// Whether a node has any subscribers is answered by a dense bitset indexed by node ID, so
+// nodes without subscribers cost a single bit test.
+// Subscriber lists are immutable once published; adding or removing a subscriber publishes a new copy,
+// so handlers can (un)subscribe while a list is being evaluated.
+class OsirisSubscriberTable
 {
 public:
-	~PendingCallbackManager();
-	Array<uint32_t>* Enter(std::unordered_multimap<uint64_t, uint32_t>::iterator& begin,
-		std::unordered_multimap<uint64_t, uint32_t>::iterator& end);
-	void Exit(Array<uint32_t>* v);
+	using SubscriberList = std::shared_ptr<Vector<uint32_t> const>;
+
+	// IDs above this limit are only tracked in the subscriber map to keep the bitset small
+	static constexpr uint32_t MaxDenseId = 0x1000000;
+
+	inline bool HasSubscribers(uint32_t id) const
+	{
+		if (id < MaxDenseId) {
+			auto word = id >> 6;
+			return word < bits_.size() && (bits_[word] & (1ull << (id & 63))) != 0;
+		} else {
+			return subscribers_.find(id) != subscribers_.end();
+		}
+	}
+
+	SubscriberList Get(uint32_t id) const;
+	void Add(uint32_t id, uint32_t subscriber);
+	bool Remove(uint32_t id, uint32_t subscriber);
+	void Clear();
 
 private:
-	Array<Array<uint32_t>*> cache_;
-	uint32_t depth_{ 0 };
+	Vector<uint64_t> bits_;
+	std::unordered_map<uint32_t, SubscriberList> subscribers_;
+
+	void SetBit(uint32_t id, bool set);
 };
 
 class OsirisCallbackManager : Noncopyable<OsirisCallbackManager>
@@ -276,23 +345,23 @@ public:
 	void EventPostHook(Function* node, OsiArgumentDesc* args);
 
 private:
-	static constexpr uint64_t AfterTriggerNodeRef = 0x8000000000000000ull;
-	static constexpr uint64_t DeleteTriggerNodeRef = 0x4000000000000000ull;
-	static constexpr uint64_t AfterFunctionRef = 0x2000000000000000ull;
-	static constexpr uint64_t BeforeFunctionRef = 0x1000000000000000ull;
+	struct SubscribedNode
+	{
+		OsirisHookPhase Phase;
+		uint32_t Id;
+	};
 
 	struct Subscription
 	{
 		RegistryEntry Callback;
 		OsirisHookSignature Signature;
-		std::optional<uint64_t> Node;
+		std::optional<SubscribedNode> Node;
 	};
 
 	ExtensionState& state_;
 	SaltedPool<Subscription> subscriptions_;
 	std::unordered_multimap<OsirisHookSignature, SubscriptionId> nameSubscriberRefs_;
-	std::unordered_multimap<uint64_t, SubscriptionId> nodeSubscriberRefs_;
-	PendingCallbackManager pendingCallbacks_;
+	std::array<OsirisSubscriberTable, (size_t)OsirisHookPhase::Count> nodeSubscribers_;
 	bool storyLoaded_{ false };
 	bool osirisHooked_{ false };
 	// Are we currently merging Osiris files (story)?
@@ -303,10 +372,10 @@ private:
 	void RegisterNodeHandler(OsirisHookSignature const& sig, SubscriptionId handlerId);
 	void HookOsiris();
 
-	void RunHandlers(uint64_t nodeRef, TuplePtrLL* tuple);
-	void RunHandler(ServerState& lua, RegistryEntry const& func, TuplePtrLL* tuple);
-	void RunHandlers(uint64_t nodeRef, OsiArgumentDesc* tuple);
-	void RunHandler(ServerState& lua, RegistryEntry const& func, OsiArgumentDesc* tuple);
+	void RunHandlers(OsirisHookPhase phase, uint32_t id, TuplePtrLL* tuple);
+	void RunHandler(ProtectedCallBatch& batch, lua_State* L, RegistryEntry const& func, TuplePtrLL* tuple);
+	void RunHandlers(OsirisHookPhase phase, uint32_t id, OsiArgumentDesc* tuple);
+	void RunHandler(ProtectedCallBatch& batch, lua_State* L, RegistryEntry const& func, OsiArgumentDesc* tuple);
 };
 
 class OsirisBinding : Noncopyable<OsirisBinding>
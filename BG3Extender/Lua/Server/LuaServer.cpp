@@ -287,6 +287,7 @@ namespace bg3se::esv
 		dynamicStats_.clear();
 		persistentStats_.clear();
 		cachedPersistentVars_.clear();
+		statSyncQueue_.Clear();
 		bg3se::ExtensionStateBase::OnGameSessionLoading();
 	}
 
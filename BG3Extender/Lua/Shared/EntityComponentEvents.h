@@ -2,6 +2,8 @@
 
 BEGIN_NS(lua)
 
+class ProtectedCallBatch;
+
 enum class EntityComponentEvent
 {
 	Create = 1 >> 0,
@@ -45,7 +47,7 @@ private:
 	ecs::EntityWorld* world_{ nullptr };
 
 	void OnEntityEvent(ecs::EntityWorld& world, EntityHandle entity, ecs::ComponentTypeIndex type, EntityComponentEvent events, void* component);
-	void CallHandler(EntityHandle entity, ecs::ComponentTypeIndex type, EntityComponentEvent events, void* component, ComponentHook const& hook);
+	void CallHandler(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, ecs::ComponentTypeIndex type, void* component, ComponentHook const& hook);
 	ComponentHooks& AddComponentType(ecs::ComponentTypeIndex type);
 
 	static void OnComponentCreated(void* object, ecs::ComponentCallbackParams const& params, void* component);
@@ -120,10 +120,12 @@ void EntityComponentEventHooks::OnEntityEvent(ecs::EntityWorld& world, EntityHan
 	auto& hooks = hookedComponents_[type.Value()];
 	if ((unsigned)(hooks.Events & events) == 0) return;
 
+	// Created on the first matching hook, so events without subscribers don't touch the Lua stack
+	std::optional<ProtectedCallBatch> batch;
 	for (auto index : hooks.GlobalHooks) {
 		auto hook = subscriptions_.Find(index);
 		if (hook != nullptr && (unsigned)(hook->Events & events) != 0) {
-			CallHandler(entity, type, events, component, *hook);
+			CallHandler(batch, entity, type, component, *hook);
 		}
 	}
 
@@ -132,23 +134,21 @@ void EntityComponentEventHooks::OnEntityEvent(ecs::EntityWorld& world, EntityHan
 		for (auto index : *entityHooks) {
 			auto hook = subscriptions_.Find(index);
 			if (hook != nullptr && (unsigned)(hook->Events & events) != 0) {
-				CallHandler(entity, type, events, component, *hook);
+				CallHandler(batch, entity, type, component, *hook);
 			}
 		}
 	}
 }
 
-void EntityComponentEventHooks::CallHandler(EntityHandle entity, ecs::ComponentTypeIndex type, EntityComponentEvent events, void* component, ComponentHook const& hook)
+void EntityComponentEventHooks::CallHandler(std::optional<ProtectedCallBatch>& batch, EntityHandle entity, ecs::ComponentTypeIndex type, void* component, ComponentHook const& hook)
 {
-	auto L = state_.GetState();
-	auto componentType = state_.GetEntitySystemHelpers()->GetComponentType(type);
-	hook.Hook.Push();
-	Ref func(L, lua_absindex(L, -1));
+	if (!batch) {
+		batch.emplace(state_.GetState(), "Component event dispatch");
+	}
 
+	auto componentType = state_.GetEntitySystemHelpers()->GetComponentType(type);
 	RawComponentRef componentRef{ component, type };
-	ProtectedFunctionCaller<std::tuple<EntityHandle, ExtComponentType, RawComponentRef>, void> caller{ func, std::tuple(entity, *componentType, componentRef) };
-	caller.Call(L, "Component event dispatch");
-	lua_pop(L, 1);
+	batch->Call(hook.Hook, entity, *componentType, componentRef);
 }
 
 END_NS()
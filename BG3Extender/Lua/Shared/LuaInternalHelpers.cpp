@@ -133,6 +133,39 @@ int ProtectedFunctionCallerBase::CallUserFunctionWithTraceback(lua_State* L, lua
 
 int TracebackHandler(lua_State* L);
 
+ProtectedCallBatch::ProtectedCallBatch(lua_State* L, char const* funcDescription, bool reportAsLuaError)
+	: L_(L),
+	stack_(State::FromLua(L)->GetStack()),
+	funcDescription_(funcDescription),
+	reportAsLuaError_(reportAsLuaError)
+{
+	lua_pushcfunction(L, &TracebackHandler);
+	tracebackHandlerIdx_ = lua_gettop(L);
+}
+
+ProtectedCallBatch::~ProtectedCallBatch()
+{
+	assert(lua_gettop(L_) == tracebackHandlerIdx_);
+	lua_remove(L_, tracebackHandlerIdx_);
+}
+
+bool ProtectedCallBatch::Dispatch(int numArgs)
+{
+	if (lua_pcall(L_, numArgs, 0, tracebackHandlerIdx_) != LUA_OK) {
+		if (reportAsLuaError_) {
+			LuaError("Call to " << (funcDescription_ ? funcDescription_ : "user function") << " failed: " << lua_tostring(L_, -1));
+		} else if (funcDescription_) {
+			ERR("Error while dispatching user function call for %s: %s", funcDescription_, lua_tostring(L_, -1));
+		} else {
+			ERR("Error while dispatching user function call: %s", lua_tostring(L_, -1));
+		}
+		lua_pop(L_, 1);
+		return false;
+	}
+
+	return true;
+}
+
 bool ProtectedCallC(lua_State* L, lua_CFunction fun, void* context, void* context2, char const* funcDescription, char const*& error)
 {
 	StackCheck _(L);
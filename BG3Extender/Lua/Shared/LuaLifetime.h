@@ -5,113 +5,187 @@
 
 BEGIN_NS(lua)
 
-template <class T, std::size_t Size>
-class HierarchicalPoolAllocator
+// Object pool that grows in fixed size segments.
+// Segments are allocated on demand and are never moved or freed while the pool is alive,
+// so object indices (and pointers) stay valid when the pool grows.
+// Free slots are tracked using a 3-level bitmap in each segment and a mask of segments that have free slots.
+template <class T, std::size_t SegmentSize, std::size_t MaxSegments>
+class SegmentedPoolAllocator : Noncopyable<SegmentedPoolAllocator<T, SegmentSize, MaxSegments>>
 {
 public:
 	static constexpr unsigned PageBits = 64;
 	static constexpr unsigned PageShift = 6;
+	static constexpr std::size_t MaxSize = SegmentSize * MaxSegments;
 
-	HierarchicalPoolAllocator()
+	static_assert((SegmentSize % 4096) == 0 && SegmentSize <= 262144, "Segment size must be a multiple of 4096 and at most 262144");
+	static_assert(MaxSegments <= 64, "At most 64 segments are supported");
+
+	struct Segment
 	{
-		pool_ = new T[Size];
-		memset(pool_, 0, sizeof(T) * Size);
-		memset(l1_, 0xff, sizeof(l1_));
-		memset(l2_, 0xff, sizeof(l2_));
-		memset(l3_, 0xff, sizeof(l3_));
+		uint64_t l1_;
+		uint64_t l2_[SegmentSize / 4096];
+		uint64_t l3_[SegmentSize / 64];
+		T pool_[SegmentSize];
+	};
 
-		auto l1buckets = Size / (PageBits * PageBits);
-		if (l1buckets % PageBits) {
-			l1_[std::size(l1_) - 1] = 0xffffffffffffffffull << (PageBits - (l1buckets & (PageBits - 1)));
+	SegmentedPoolAllocator()
+	{
+		Grow();
+	}
+
+	~SegmentedPoolAllocator()
+	{
+		for (std::size_t i = 0; i < numSegments_; i++) {
+			delete segments_[i];
 		}
+	}
 
-		for (std::size_t i = 0; i < Size; i++) {
-			pool_[i].SetIndex(i);
+	T* Allocate()
+	{
+		T* ptr;
+		if (AllocateSlots(&ptr, 1) == 0) {
+			return nullptr;
 		}
+
+		ptr->Acquire();
+		return ptr;
 	}
 
-	~HierarchicalPoolAllocator()
+	void Free(T* ptr)
 	{
-		delete [] pool_;
+		FreeSlots(&ptr, 1);
+		ptr->Release();
 	}
 
-	T* Allocate()
+	// Reserves up to count slots without acquiring them.
+	// Slots are taken a whole L3 page at a time, so each bitmap level is only updated once per 64 slots.
+	std::size_t AllocateSlots(T** slots, std::size_t count)
 	{
-		for (auto i = 0; i < std::size(l1_); i++) {
-			unsigned long l1;
-			if (_BitScanForward64(&l1, l1_[i])) {
-				auto l2off = (i << PageShift) + l1;
-				unsigned long l2;
-				_BitScanForward64(&l2, l2_[l2off]);
-				assert(l2 < PageBits);
-				auto l3off = (i << (2 * PageShift)) + (l1 << PageShift) + l2;
-				unsigned long l3;
-				_BitScanForward64(&l3, l3_[l3off]);
-				assert(l3 < PageBits);
-				l3_[l3off] &= ~(1ull << l3);
-				if (l3_[l3off] == 0) {
-					l2_[l2off] &= ~(1ull << l2);
-					if (l2_[l2off] == 0) {
-						l1_[i] &= ~(1ull << l1);
-					}
+		std::size_t allocated{ 0 };
+		while (allocated < count) {
+			unsigned long seg;
+			if (!_BitScanForward64(&seg, freeSegments_)) {
+				if (!Grow()) {
+					OsiErrorS("Couldn't allocate Lua lifetime - pool is full! This is very, very bad.");
+					break;
 				}
 
-				auto off = (i << (3 * PageShift)) + (l1 << (2 * PageShift)) + (l2 << PageShift) + l3;
+				seg = (unsigned long)(numSegments_ - 1);
+			}
+
+			auto& segment = *segments_[seg];
+			unsigned long l1, l2;
+			_BitScanForward64(&l1, segment.l1_);
+			assert(l1 < std::size(segment.l2_));
+			_BitScanForward64(&l2, segment.l2_[l1]);
+			assert(l2 < PageBits);
+			auto l3off = (l1 << PageShift) + l2;
+			auto& page = segment.l3_[l3off];
+
+			while (page != 0 && allocated < count) {
+				unsigned long l3;
+				_BitScanForward64(&l3, page);
+				page &= page - 1;
+				slots[allocated++] = segment.pool_ + (l3off << PageShift) + l3;
 #if defined(TRACE_LIFETIMES)
-				INFO("ACQ: off=%d, root=%d, l1=%d, l2=%d, l3=%d, l2off=%d, l3off=%d", off, i, l1, l2, l3, l2off, l3off);
+				INFO("ACQ: seg=%d, l1=%d, l2=%d, l3=%d", seg, l1, l2, l3);
 #endif
+			}
 
-				auto lifetime = pool_ + off;
-				lifetime->Acquire();
-				return lifetime;
+			if (page == 0) {
+				segment.l2_[l1] &= ~(1ull << l2);
+				if (segment.l2_[l1] == 0) {
+					segment.l1_ &= ~(1ull << l1);
+					if (segment.l1_ == 0) {
+						freeSegments_ &= ~(1ull << seg);
+					}
+				}
 			}
 		}
 
-		OsiErrorS("Couldn't allocate Lua lifetime - pool is full! This is very, very bad.");
-		return nullptr;
+		return allocated;
+	}
+
+	// Returns slots reserved by AllocateSlots() to the pool without releasing them
+	void FreeSlots(T* const* slots, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; i++) {
+			std::size_t index = slots[i]->Index();
+			auto seg = index / SegmentSize;
+			assert(seg < numSegments_ && segments_[seg]->pool_ + (index % SegmentSize) == slots[i]);
+			auto& segment = *segments_[seg];
+			index %= SegmentSize;
+			auto l3 = index & (PageBits - 1);
+			auto l3off = index >> PageShift;
+			auto l2 = l3off & (PageBits - 1);
+			auto l1 = l3off >> PageShift;
+
+			bool l3set = (segment.l3_[l3off] == 0);
+			segment.l3_[l3off] |= 1ull << l3;
+			if (l3set) {
+				bool l2set = (segment.l2_[l1] == 0);
+				segment.l2_[l1] |= 1ull << l2;
+				if (l2set) {
+					segment.l1_ |= 1ull << l1;
+					freeSegments_ |= 1ull << seg;
+				}
+			}
+		}
 	}
 
-	void Free(T* ptr)
+	T* Get(std::size_t index) const
 	{
-		assert(ptr >= pool_ && ptr < pool_ + Size);
-		auto index = ptr - pool_;
-		auto off = index;
-		auto l3 = index & (PageBits - 1);
-		index >>= PageShift;
-		auto l3off = index;
-		auto l2 = index & (PageBits - 1);
-		index >>= PageShift;
-		auto l2off = index;
-		auto l1 = index & (PageBits - 1);
-		index >>= PageShift;
-		auto l1off = index;
-
-		bool l3set = (l3_[l3off] == 0);
-		l3_[l3off] |= 1ull << l3;
-		if (l3set) {
-			bool l2set = (l2_[l2off] == 0);
-			l2_[l2off] |= 1ull << l2;
-			if (l2set) {
-				l1_[l1off] |= 1ull << l1;
-			}
+		auto seg = index / SegmentSize;
+		if (seg >= numSegments_) {
+			return nullptr;
 		}
 
-		ptr->Release();
+		return segments_[seg]->pool_ + (index % SegmentSize);
 	}
 
-	T* Get(std::size_t index) const
+	inline std::size_t NumSegments() const
 	{
-		assert(index < Size);
-		return pool_ + index;
+		return numSegments_;
 	}
 
-public:
-	static_assert((Size % 4096) == 0, "Size must be a multiple of 4096");
+	inline Segment const& GetSegment(std::size_t index) const
+	{
+		assert(index < numSegments_);
+		return *segments_[index];
+	}
+
+	inline std::size_t Capacity() const
+	{
+		return numSegments_ * SegmentSize;
+	}
 
-	uint64_t l1_[Size / 262144 + ((Size % 262144) ? 1 : 0)];
-	uint64_t l2_[Size / 4096];
-	uint64_t l3_[Size / 64];
-	T* pool_;
+private:
+	Segment* segments_[MaxSegments];
+	std::size_t numSegments_{ 0 };
+	// Segments that have at least one free slot
+	uint64_t freeSegments_{ 0 };
+
+	bool Grow()
+	{
+		if (numSegments_ == MaxSegments) {
+			return false;
+		}
+
+		auto segment = new Segment();
+		constexpr auto l1Pages = SegmentSize / 4096;
+		segment->l1_ = (l1Pages == PageBits) ? 0xffffffffffffffffull : ((1ull << l1Pages) - 1);
+		memset(segment->l2_, 0xff, sizeof(segment->l2_));
+		memset(segment->l3_, 0xff, sizeof(segment->l3_));
+
+		auto base = numSegments_ * SegmentSize;
+		for (std::size_t i = 0; i < SegmentSize; i++) {
+			segment->pool_[i].SetIndex(base + i);
+		}
+
+		freeSegments_ |= 1ull << numSegments_;
+		segments_[numSegments_++] = segment;
+		return true;
+	}
 };
 
 class LifetimePool;
@@ -119,7 +193,7 @@ class LifetimePool;
 class Lifetime : public Noncopyable<Lifetime>
 {
 public:
-	static constexpr uint32_t SaltMask = (1ull << 30) - 1;
+	static constexpr uint32_t SaltMask = (1ull << 26) - 1;
 
 	inline Lifetime()
 	{}
@@ -189,9 +263,11 @@ private:
 struct LifetimeHandle
 {
 	static constexpr unsigned HandleBits = 48;
-	static constexpr unsigned IndexBits = 18;
+	static constexpr unsigned IndexBits = 22;
 	static constexpr unsigned SaltBits = (HandleBits - IndexBits);
 	static constexpr unsigned MaxPoolSize = 1 << IndexBits;
+	// The pool starts with one segment and grows on demand
+	static constexpr unsigned PoolSegmentSize = 1 << 16;
 	static constexpr uint64_t IndexMask = (1ull << IndexBits) - 1;
 	static constexpr uint64_t SaltMask = (1ull << SaltBits) - 1;
 	static constexpr uint64_t HandleMask = (1ull << HandleBits) - 1;
@@ -289,7 +365,7 @@ public:
 		auto ref = pool_.Get(handle.GetIndex());
 		if (ref == nullptr) {
 #if defined(DEBUG_LIFETIMES)
-			ERR("[%012lx] Attempted to get lifetime with invalid index %d (max is %d).", (uint64_t)handle, handle.GetIndex(), LifetimeHandle::MaxPoolSize);
+			ERR("[%012lx] Attempted to get lifetime with invalid index %d (pool size is %d).", (uint64_t)handle, handle.GetIndex(), pool_.Capacity());
 #endif
 			return nullptr;
 		}
@@ -319,22 +395,47 @@ public:
 		}
 	}
 
+	// Reserves pool slots without making them alive; the caller is responsible for
+	// acquiring and releasing the lifetimes in the reserved slots
+	inline std::size_t Reserve(Lifetime** lifetimes, std::size_t count)
+	{
+		return pool_.AllocateSlots(lifetimes, count);
+	}
+
+	inline void Unreserve(Lifetime* const* lifetimes, std::size_t count)
+	{
+		pool_.FreeSlots(lifetimes, count);
+	}
+
 	inline auto const& GetAllocator() const
 	{
 		return pool_;
 	}
 
 private:
-	HierarchicalPoolAllocator<Lifetime, LifetimeHandle::MaxPoolSize> pool_;
+	SegmentedPoolAllocator<Lifetime, LifetimeHandle::PoolSegmentSize, LifetimeHandle::MaxPoolSize / LifetimeHandle::PoolSegmentSize> pool_;
 };
 
-class LifetimeStack
+// Stack of lifetimes of the currently executing scopes.
+// Lifetimes of stack frames are allocated from a scope-local region of pool slots that is reserved
+// in batches; the region works like a bump allocator, so frame lifetimes are killed without
+// touching the pool bitmaps when the frame is popped.
+class LifetimeStack : Noncopyable<LifetimeStack>
 {
 public:
+	// Number of pool slots reserved for the scope-local region at once
+	static constexpr std::size_t RegionReserveSize = 64;
+
 	inline LifetimeStack(LifetimePool& pool)
 		: pool_(pool)
 	{}
 
+	inline ~LifetimeStack()
+	{
+		assert(regionTop_ == 0);
+		pool_.Unreserve(region_.data(), region_.size());
+	}
+
 	inline LifetimePool& Pool()
 	{
 		return pool_;
@@ -348,49 +449,105 @@ public:
 	inline LifetimeHandle Push()
 	{
 		assert(stack_.size() < 0x1000);
-		auto lifetime = pool_.Allocate();
-		stack_.push_back(lifetime);
+		auto mark = regionTop_;
+		auto lifetime = AllocateFromRegion();
+		stack_.push_back(Frame{ lifetime, mark, false });
 		return lifetime;
 	}
 
 	inline void Push(LifetimeHandle lifetime)
 	{
 		assert(stack_.size() < 0x1000);
-		stack_.push_back(lifetime);
+		stack_.push_back(Frame{ lifetime, regionTop_, true });
 	}
 
 	inline void PopAndKill()
 	{
 		assert(!stack_.empty());
-		auto lifetime = *stack_.rbegin();
-		pool_.Release(lifetime);
+		auto const& frame = *stack_.rbegin();
+		if (frame.External) {
+			pool_.Release(frame.Lifetime);
+		}
+
+		ReleaseRegion(frame.RegionMark);
 		stack_.pop_back();
 	}
 
 	inline void PopAndKill(LifetimeHandle lifetime)
 	{
 		assert(!stack_.empty());
-		assert(*stack_.rbegin() == lifetime);
-		pool_.Release(lifetime);
-		stack_.pop_back();
+		assert(stack_.rbegin()->Lifetime == lifetime);
+		PopAndKill();
 	}
 
 	inline void Pop(LifetimeHandle lifetime)
 	{
 		assert(!stack_.empty());
-		assert(*stack_.rbegin() == lifetime);
+		auto const& frame = *stack_.rbegin();
+		assert(frame.Lifetime == lifetime);
+		ReleaseRegion(frame.RegionMark);
 		stack_.pop_back();
 	}
 
 	inline LifetimeHandle GetCurrent() const
 	{
 		assert(!stack_.empty());
-		return *stack_.rbegin();
+		return stack_.rbegin()->Lifetime;
 	}
 
 private:
+	struct Frame
+	{
+		LifetimeHandle Lifetime;
+		// Top of the scope-local region when the frame was pushed
+		uint32_t RegionMark;
+		// Was the lifetime allocated outside of the region?
+		bool External;
+	};
+
 	LifetimePool& pool_;
-	Vector<LifetimeHandle> stack_;
+	Vector<Frame> stack_;
+	// Pool slots reserved for scope-local lifetimes; slots below regionTop_ are alive
+	Vector<Lifetime*> region_;
+	uint32_t regionTop_{ 0 };
+
+	LifetimeHandle AllocateFromRegion()
+	{
+		if (regionTop_ == region_.size()) {
+			auto size = region_.size();
+			region_.resize(size + RegionReserveSize);
+			auto reserved = pool_.Reserve(region_.data() + size, RegionReserveSize);
+			region_.resize(size + reserved);
+			if (reserved == 0) {
+				return LifetimeHandle();
+			}
+		}
+
+		auto lifetime = region_[regionTop_];
+		if (lifetime->Salt() == Lifetime::SaltMask) {
+			// Region slots are reused very frequently; retire the slot before its salt wraps around
+			// so stale handles can never match it again
+			if (pool_.Reserve(&lifetime, 1) == 0) {
+				return LifetimeHandle();
+			}
+
+			region_[regionTop_] = lifetime;
+		}
+
+		regionTop_++;
+		lifetime->Acquire();
+		return LifetimeHandle(lifetime);
+	}
+
+	void ReleaseRegion(uint32_t mark)
+	{
+		assert(mark <= regionTop_);
+		for (auto i = mark; i < regionTop_; i++) {
+			region_[i]->Release();
+		}
+
+		regionTop_ = mark;
+	}
 };
 
 // RAII lifetime stack guard; 
@@ -300,6 +300,67 @@ struct ProtectedFunctionCaller : public ProtectedFunctionCallerBase
 };
 
 
+// Dispatches a series of native -> Lua callbacks with no return values.
+// The traceback handler is pushed once for the whole batch, and each callback is made with a single lua_pcall().
+// The function and its arguments are pushed from a protected trampoline, so errors raised while pushing
+// are reported like errors in the callback itself.
+class ProtectedCallBatch : Noncopyable<ProtectedCallBatch>
+{
+public:
+	// If reportAsLuaError is set, errors are logged through the Lua error channel instead of the extender log
+	ProtectedCallBatch(lua_State* L, char const* funcDescription = nullptr, bool reportAsLuaError = false);
+	~ProtectedCallBatch();
+
+	template <class ...Args>
+	bool Call(RegistryEntry const& fun, Args const&... args)
+	{
+		return CallWithPusher(fun, [&]() {
+			(PushUserCallArg(L_, args), ...);
+			return (int)sizeof...(Args);
+		});
+	}
+
+	// Calls a function whose arguments are pushed by the specified pusher function.
+	// The pusher must return the number of arguments pushed.
+	template <class Pusher>
+	bool CallWithPusher(RegistryEntry const& fun, Pusher const& pushArgs)
+	{
+		LifetimeStackPin _(stack_);
+		CallContext<Pusher> ctx{ &fun, &pushArgs };
+		lua_pushcfunction(L_, &CallTrampoline<Pusher>);
+		lua_pushlightuserdata(L_, &ctx);
+		return Dispatch(1);
+	}
+
+private:
+	template <class Pusher>
+	struct CallContext
+	{
+		RegistryEntry const* Function;
+		Pusher const* PushArgs;
+	};
+
+	template <class Pusher>
+	static int CallTrampoline(lua_State* L)
+	{
+		auto ctx = reinterpret_cast<CallContext<Pusher>*>(lua_touserdata(L, 1));
+		lua_pop(L, 1);
+		ctx->Function->Push();
+		auto numArgs = (*ctx->PushArgs)();
+		lua_call(L, numArgs, 0);
+		return 0;
+	}
+
+	lua_State* L_;
+	LifetimeStack& stack_;
+	char const* funcDescription_;
+	int tracebackHandlerIdx_;
+	bool reportAsLuaError_;
+
+	bool Dispatch(int numArgs);
+};
+
+
 // No return value, lua_State passed
 template <class T, class ...Args, size_t ...Indices>
 inline int CallMethodHelper(lua_State* L, void (T::* fun)(lua_State*, Args...), std::index_sequence<Indices...>) {
@@ -95,6 +95,8 @@ public:
 	bool Initialized{ false };
 	bool InheritanceUpdated{ false };
 	ValidationState Validated{ ValidationState::Unknown };
+	// Incremented each time a property is written through this map; lets caches built over property values detect changes
+	mutable std::atomic<uint32_t> WriteGeneration{ 0 };
 	int RegistryIndex{ -1 };
 	std::optional<ExtComponentType> ComponentType;
 };
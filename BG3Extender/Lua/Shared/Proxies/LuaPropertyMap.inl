@@ -45,6 +45,7 @@ PropertyOperationResult GenericPropertyMap::SetRawProperty(lua_State* L, void* o
 	auto it = Properties.try_get(prop);
 	if (it == nullptr) {
 		if (FallbackSetter) {
+			WriteGeneration.fetch_add(1, std::memory_order_relaxed);
 			return FallbackSetter(L, object, prop, index);
 		} else {
 			return PropertyOperationResult::NoSuchProperty;
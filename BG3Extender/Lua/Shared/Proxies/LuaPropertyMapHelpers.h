@@ -11,6 +11,11 @@ void ProcessPropertyNotifications(RawPropertyAccessors const& prop, bool isWriti
 void DisablePropertyWarnings();
 void EnablePropertyWarnings();
 
+inline void MarkPropertyWritten(RawPropertyAccessors const& prop)
+{
+	prop.PropertyMap->WriteGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
 template <class T>
 PropertyOperationResult GenericGetOffsetProperty(lua_State* L, LifetimeHandle const& lifetime, void* obj, RawPropertyAccessors const& prop)
 {
@@ -58,6 +63,7 @@ PropertyOperationResult GenericSetOffsetProperty(lua_State* L, void* obj, int in
 		ProcessPropertyNotifications(prop, true);
 	}
 
+	MarkPropertyWritten(prop);
 	if constexpr (IsByVal<T>) {
 		auto* value = (T*)((std::uintptr_t)obj + prop.Offset);
 		*value = get<T>(L, index);
@@ -80,6 +86,7 @@ PropertyOperationResult GenericSetOffsetBitmaskFlag(lua_State* L, void* obj, int
 {
 	auto* value = (UnderlyingType*)((std::uintptr_t)obj + prop.Offset);
 	auto set = get<bool>(L, index);
+	MarkPropertyWritten(prop);
 	if (set) {
 		*value |= (UnderlyingType)prop.Flag;
 	} else {
@@ -110,6 +110,23 @@ function OsiDatabase:Get(...) end
 --- If the parameter is nil, the column is not filtered (equivalent to passing _ in Osiris). If the parameter is not nil, only rows with matching values will be deleted. 
 --- @vararg OsirisValue|nil
 function OsiDatabase:Delete(...) end
+--- Returns every row of the database in columnar form, i.e. one array per column (`rows[column][row]`).  
+--- If the database name exists with multiple column counts, the number of columns must be passed in `arity`.
+--- @param arity integer|nil
+--- @return table<integer,table<integer,OsirisValue>>
+function OsiDatabase:GetAll(arity) end
+--- Inserts every row of `rows` into the database. Each row is an array with one value per column.  
+--- All rows are type checked before any of them is inserted. Returns the number of rows inserted.
+--- @param rows table<integer,table<integer,OsirisValue>>
+--- @param arity integer|nil
+--- @return integer
+function OsiDatabase:InsertMany(rows, arity) end
+--- Deletes every row of `rows` from the database. Each row is an array with one value per column;  
+--- nil values are not filtered, just like in Delete. Returns the number of rows processed.
+--- @param rows table<integer,table<integer,OsirisValue|nil>>
+--- @param arity integer|nil
+--- @return integer
+function OsiDatabase:DeleteMany(rows, arity) end
 
 --- @alias OsiFunction fun(...:OsirisValue):OsirisValue|nil
 --- @alias OsiDynamic table<string, OsiFunction|OsiDatabase>
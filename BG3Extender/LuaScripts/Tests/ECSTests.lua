@@ -51,9 +51,47 @@ function TestECSFunctions()
     -- GetSalt and GetIndex have no deterministic outputs
 end
 
+function TestECSBulkProperties()
+    local ent = Ext.Entity.Get(GUID_LAEZEL)
+    local name = ent.DisplayName
+
+    local props = Ext.Types.GetProperties(name, {"Name"})
+    AssertEquals("Lae'zel", props.Name)
+
+    local selector = Ext.Types.CreatePropertySelector(Ext.Types.GetObjectType(name), {"Name"})
+    local out = {}
+    AssertEquals(Ext.Types.GetProperties(name, selector, out), out)
+    AssertEquals("Lae'zel", out.Name)
+
+    AssertEquals(pcall(Ext.Types.GetProperties, name, {"NonexistentProperty"}), false)
+    AssertEquals(pcall(Ext.Types.CreatePropertySelector, Ext.Types.GetObjectType(name), {"NonexistentProperty"}), false)
+
+    -- Property names must be strings
+    AssertEquals(pcall(Ext.Types.SetProperties, name, {[1] = "Lae'zel"}), false)
+
+    -- Objects that aren't property map backed are accessed through their metatables
+    local components = Ext.Types.GetProperties(ent, {"DisplayName"})
+    AssertEquals("Lae'zel", components.DisplayName.Name)
+end
+
+function TestECSBinarySerialization()
+    local ent = Ext.Entity.Get(GUID_LAEZEL)
+    local transform = ent.Transform
+
+    local data = Ext.Types.SerializeBinary(transform)
+    AssertType(data, "string")
+    Ext.Types.UnserializeBinary(transform, data)
+    AssertEquals(Ext.Types.SerializeBinary(transform), data)
+
+    AssertEquals(pcall(Ext.Types.UnserializeBinary, transform, "garbage"), false)
+    AssertEquals(pcall(Ext.Types.UnserializeBinary, ent.DisplayName, data), false)
+end
+
 RegisterTests("ECS", {
     "TestECSFetch",
     "TestECSComponents",
     "TestECSFunctions",
-    "TestECSReplication"
+    "TestECSReplication",
+    "TestECSBulkProperties",
+    "TestECSBinarySerialization"
 })
@@ -0,0 +1,28 @@
+function TestLocaUpdate()
+    local handle = "h5e0e4d0ag0001g4f2dg9b0cg7d3a1c2e0001"
+    AssertEquals(Ext.Loca.UpdateTranslatedString(handle, "Test text"), true)
+    AssertEquals(Ext.Loca.GetTranslatedString(handle), "Test text")
+    -- Updates store the new text separately; the previous text stays valid for anyone still reading it
+    Ext.Loca.UpdateTranslatedString(handle, "Short")
+    AssertEquals(Ext.Loca.GetTranslatedString(handle), "Short")
+    Ext.Loca.UpdateTranslatedString(handle, "A considerably longer text than the previous one")
+    AssertEquals(Ext.Loca.GetTranslatedString(handle), "A considerably longer text than the previous one")
+end
+
+function TestLocaBulkUpdate()
+    local h1 = "h5e0e4d0ag0001g4f2dg9b0cg7d3a1c2e0002"
+    local h2 = "h5e0e4d0ag0001g4f2dg9b0cg7d3a1c2e0003"
+    local missing = "h5e0e4d0ag0001g4f2dg9b0cg7d3a1c2effff"
+
+    AssertEquals(Ext.Loca.UpdateTranslatedStrings({[h1] = "Shared text", [h2] = "Shared text"}), true)
+    AssertEquals(Ext.Loca.GetTranslatedStrings({h1, h2, missing}), {[h1] = "Shared text", [h2] = "Shared text"})
+
+    -- Updating one of the handles sharing a text must not affect the other
+    Ext.Loca.UpdateTranslatedStrings({[h1] = "Other"})
+    AssertEquals(Ext.Loca.GetTranslatedStrings({h1, h2}), {[h1] = "Other", [h2] = "Shared text"})
+end
+
+RegisterTests("Loca", {
+    "TestLocaUpdate",
+    "TestLocaBulkUpdate"
+})
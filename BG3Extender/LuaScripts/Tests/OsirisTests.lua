@@ -55,8 +55,67 @@ function TestOsirisUserQuerySubscribers()
     AssertEquals(regOk2, true)
 end
 
+function TestOsirisSubscriberChurn()
+    local host = Osi.GetHostCharacter()
+    local calls = 0
+    local subscriptions = {}
+    for i = 1, 200 do
+        subscriptions[i] = Ext.Osiris.RegisterListener("SetCanGossip", 2, "after", function (a, b)
+            calls = calls + 1
+        end)
+    end
+
+    for i = 1, 200, 2 do
+        AssertEquals(Ext.Osiris.UnregisterListener(subscriptions[i]), true)
+    end
+
+    -- Subscribing from within a handler must not affect the list being evaluated
+    local nested
+    local selfSub
+    selfSub = Ext.Osiris.RegisterListener("SetCanGossip", 2, "after", function (a, b)
+        Ext.Osiris.UnregisterListener(selfSub)
+        nested = Ext.Osiris.RegisterListener("SetCanGossip", 2, "after", function (a, b)
+            calls = calls + 1
+        end)
+    end)
+
+    Osi.SetCanGossip(host, 1)
+    AssertEquals(calls, 100)
+
+    calls = 0
+    Osi.SetCanGossip(host, 1)
+    AssertEquals(calls, 101)
+
+    for i = 2, 200, 2 do
+        Ext.Osiris.UnregisterListener(subscriptions[i])
+    end
+    Ext.Osiris.UnregisterListener(nested)
+
+    calls = 0
+    Osi.SetCanGossip(host, 1)
+    AssertEquals(calls, 0)
+end
+
+function TestOsirisDBBulkOperations()
+    local host = Osi.GetHostCharacter()
+    Osi.DB_Players:DeleteMany({{host}})
+    AssertEquals(#Osi.DB_Players:Get(host), 0)
+
+    AssertEquals(Osi.DB_Players:InsertMany({{host}}), 1)
+    local columns = Osi.DB_Players:GetAll()
+    AssertEquals(#columns, 1)
+    AssertEquals(#columns[1], #Osi.DB_Players:Get(nil))
+    AssertEquals(columns[1].n, #Osi.DB_Players:Get(nil))
+    AssertEquals(#Osi.DB_Players:Get(host), 1)
+
+    local ok = pcall(Osi.DB_Players.InsertMany, Osi.DB_Players, {{123}})
+    AssertEquals(ok, false)
+end
+
 RegisterTests("Stats", {
     "TestOsirisCallSubscribers",
     "TestOsirisDBSubscribers",
-    "TestOsirisUserQuerySubscribers"
+    "TestOsirisUserQuerySubscribers",
+    "TestOsirisSubscriberChurn",
+    "TestOsirisDBBulkOperations"
 })
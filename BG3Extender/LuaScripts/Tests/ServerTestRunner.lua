@@ -2,6 +2,9 @@ Ext.Utils.Include(nil, "builtin://Tests/TestHelpers.lua")
 Ext.Utils.Include(nil, "builtin://Tests/ModTests.lua")
 Ext.Utils.Include(nil, "builtin://Tests/StaticDataTests.lua")
 Ext.Utils.Include(nil, "builtin://Tests/StatTests.lua")
+Ext.Utils.Include(nil, "builtin://Tests/LocaTests.lua")
+Ext.Utils.Include(nil, "builtin://Tests/TemplateTests.lua")
+Ext.Utils.Include(nil, "builtin://Tests/VarsTests.lua")
 Ext.Utils.Include(nil, "builtin://Tests/ECSTests.lua")
 --Ext.Utils.Include(nil, "builtin://Tests/ResourceTests.lua")
 --Ext.Utils.Include(nil, "builtin://Tests/CharacterTests.lua")
@@ -9,6 +9,36 @@ function TestGuidResourceFetch()
     AssertEquals(res.Name, "LoreCollege")
 end
 
+function TestGuidResourceFind()
+    local uuid = "d21368ac-c776-465c-9dcf-6123dd52734f"
+    AssertContains(Ext.StaticData.Find("ClassDescription", {Name = "LoreCollege"}), uuid)
+    AssertContains(Ext.StaticData.Find("ClassDescription", {Name = "LoreCollege", SoundClassType = "Bard"}), uuid)
+    AssertEquals(Ext.StaticData.Find("ClassDescription", {Name = "LoreCollege", SoundClassType = "Paladin"}), {})
+    AssertEquals(#Ext.StaticData.Find("ClassDescription", {}), #Ext.StaticData.GetAll("ClassDescription"))
+    AssertEquals(pcall(Ext.StaticData.Find, "ClassDescription", {[1] = "LoreCollege"}), false)
+end
+
+function TestGuidResourceFindAfterUpdate()
+    local uuid = "d21368ac-c776-465c-9dcf-6123dd52734f"
+    AssertContains(Ext.StaticData.Find("ClassDescription", {SoundClassType = "Bard"}), uuid)
+
+    local res = Ext.StaticData.Get(uuid, "ClassDescription")
+    res.SoundClassType = "Paladin"
+    AssertContains(Ext.StaticData.Find("ClassDescription", {SoundClassType = "Paladin"}), uuid)
+    AssertEquals(Ext.StaticData.Find("ClassDescription", {Name = "LoreCollege", SoundClassType = "Bard"}), {})
+
+    res.SoundClassType = "Bard"
+    AssertContains(Ext.StaticData.Find("ClassDescription", {Name = "LoreCollege", SoundClassType = "Bard"}), uuid)
+end
+
+function TestGuidResourceGetAllFields()
+    local fields = Ext.StaticData.GetAllFields("ClassDescription", {"Name", "SoundClassType"})
+    local res = fields["d21368ac-c776-465c-9dcf-6123dd52734f"]
+    AssertEquals(res.Name, "LoreCollege")
+    AssertEquals(res.SoundClassType, "Bard")
+    AssertEquals(res.ParentGuid, nil)
+end
+
 function TestGuidResourceUpdate()
     local res = Ext.StaticData.Get("d21368ac-c776-465c-9dcf-6123dd52734f", "ClassDescription")
     AssertEquals(res.SoundClassType, "Bard")
@@ -68,6 +98,9 @@ end
 RegisterTests("StaticData", {
     "TestGuidResourceEnumeration",
     "TestGuidResourceFetch",
+    "TestGuidResourceFind",
+    "TestGuidResourceFindAfterUpdate",
+    "TestGuidResourceGetAllFields",
     "TestGuidResourceUpdate",
     "TestGuidResourceLayout"
 })
@@ -0,0 +1,41 @@
+function TestTemplateFind()
+    local ids = Ext.Template.Find({Type = "character"})
+    AssertEquals(#ids > 0, true)
+    local tmpl = Ext.Template.GetTemplate(ids[1])
+    AssertEquals(tmpl.TemplateType, "character")
+
+    -- Each key narrows the previous result
+    local byName = Ext.Template.Find({Type = "character", Name = tmpl.Name})
+    local found = false
+    for _, id in ipairs(byName) do
+        AssertEquals(Ext.Template.GetTemplate(id).Name, tmpl.Name)
+        if id == ids[1] then found = true end
+    end
+    AssertEquals(found, true)
+
+    AssertEquals(Ext.Template.Find({Stats = "__NonexistentStatsEntry__"}), {})
+end
+
+function TestTemplateFindAfterRename()
+    local ids = Ext.Template.Find({Type = "character"})
+    local tmpl = Ext.Template.GetTemplate(ids[1])
+    local oldName = tmpl.Name
+    tmpl.Name = "__SE_RenamedTemplate__"
+
+    -- The index still has the old name; the live template no longer matches it
+    for _, id in ipairs(Ext.Template.Find({Type = "character", Name = oldName})) do
+        AssertEquals(id ~= ids[1], true)
+    end
+
+    tmpl.Name = oldName
+    local found = false
+    for _, id in ipairs(Ext.Template.Find({Type = "character", Name = oldName})) do
+        if id == ids[1] then found = true end
+    end
+    AssertEquals(found, true)
+end
+
+RegisterTests("Template", {
+    "TestTemplateFind",
+    "TestTemplateFindAfterRename"
+})
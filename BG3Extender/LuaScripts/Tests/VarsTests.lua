@@ -0,0 +1,59 @@
+local SHARED_MOD = "ed539163-bb70-431b-96a7-f5b2eda5376b"
+local GUID_LAEZEL = "58a69333-40bf-8358-1d17-fff240d7fb12"
+
+function TestModVariableSurvivesCacheReset()
+    -- Default flags: server-only and persistent, so the write is only kept in the cache until a forced flush
+    Ext.Vars.RegisterModVariable(SHARED_MOD, "SE_TestDeferredVar", {})
+    local vars = Ext.Vars.GetModVariables(SHARED_MOD)
+    vars.SE_TestDeferredVar = {Value = 123, Name = "Test"}
+
+    Ext.Debug.ResetVariableCaches()
+
+    vars = Ext.Vars.GetModVariables(SHARED_MOD)
+    AssertEquals(vars.SE_TestDeferredVar.Value, 123)
+    AssertEquals(vars.SE_TestDeferredVar.Name, "Test")
+end
+
+function TestPackedVariablesRoundTrip()
+    Ext.Vars.RegisterUserVariable("SE_TestPackedVar", {})
+    Ext.Vars.RegisterUserVariable("SE_TestPackedTransientVar", {Persistent = false})
+    Ext.Vars.RegisterModVariable(SHARED_MOD, "SE_TestPackedVar", {})
+
+    local values = {
+        Int = 1234567890123,
+        Float = 12.5,
+        String = "PackedString",
+        Table = {Value = 123, Name = "Test", Nested = {1, 2, 3}}
+    }
+
+    local ent = Ext.Entity.Get(GUID_LAEZEL)
+    local modVars = Ext.Vars.GetModVariables(SHARED_MOD)
+    for name,value in pairs(values) do
+        ent.Vars.SE_TestPackedVar = value
+        ent.Vars.SE_TestPackedTransientVar = value
+        modVars.SE_TestPackedVar = value
+        Ext.Debug.RoundTripPersistentVariables()
+
+        ent = Ext.Entity.Get(GUID_LAEZEL)
+        modVars = Ext.Vars.GetModVariables(SHARED_MOD)
+        if type(value) == "table" then
+            AssertEqualsProperties(value, ent.Vars.SE_TestPackedVar)
+            AssertEqualsProperties(value, modVars.SE_TestPackedVar)
+        else
+            AssertEquals(ent.Vars.SE_TestPackedVar, value)
+            AssertEquals(modVars.SE_TestPackedVar, value)
+        end
+        AssertEquals(ent.Vars.SE_TestPackedTransientVar, nil)
+    end
+
+    ent.Vars.SE_TestPackedVar = nil
+    modVars.SE_TestPackedVar = nil
+    Ext.Debug.RoundTripPersistentVariables()
+    AssertEquals(Ext.Entity.Get(GUID_LAEZEL).Vars.SE_TestPackedVar, nil)
+    AssertEquals(Ext.Vars.GetModVariables(SHARED_MOD).SE_TestPackedVar, nil)
+end
+
+RegisterTests("Vars", {
+    "TestModVariableSurvivesCacheReset",
+    "TestPackedVariablesRoundTrip"
+})
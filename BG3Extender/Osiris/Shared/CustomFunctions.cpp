@@ -392,84 +392,11 @@ STDString CustomFunctionManager::GenerateHeaders() const
 	return STDString(ss.str());
 }
 
-void CustomFunctionManager::PreProcessStory(STDString const & original, STDString & postProcessed)
-{
-	STDString ph1;
-	ph1.reserve(original.size());
-	postProcessed.reserve(original.size());
-
-	STDString::size_type pos = 0;
-	while (pos < original.size()) {
-		auto next = original.find("/* [EXTENDER_ONLY]", pos);
-		if (next == STDString::npos) {
-			ph1 += original.substr(pos);
-			break;
-		}
-
-		auto end = original.find("*/", next);
-		if (end == STDString::npos) {
-			ph1 += original.substr(pos);
-			break;
-		}
-
-		ph1 += original.substr(pos, next - pos);
-		ph1 += original.substr(next + 19, end - next - 19);
-		pos = end + 2;
-	}
-
-	pos = 0;
-	while (pos < ph1.size()) {
-		auto next = ph1.find("// [BEGIN_NO_EXTENDER]", pos);
-		if (next == STDString::npos) {
-			postProcessed += ph1.substr(pos);
-			break;
-		}
-
-		auto end = ph1.find("// [END_NO_EXTENDER]", next);
-		if (end == STDString::npos) {
-			postProcessed += ph1.substr(pos);
-			break;
-		}
-
-		postProcessed += ph1.substr(pos, next - pos);
-		pos = end + 21;
-	}
-}
-
 void CustomFunctionManager::PreProcessStory(wchar_t const * path)
 {
-	STDString original;
-	STDString postProcessed;
-
-	{
-		std::ifstream f(path, std::ios::in | std::ios::binary);
-		if (!f.good()) return;
-
-		f.seekg(0, std::ios::end);
-		original.resize((uint32_t)f.tellg());
-		f.seekg(0, std::ios::beg);
-		f.read(original.data(), original.size());
-	}
-
-	// Clear compile trace flags to avoid large compile traces
-	auto debugPos = original.find("option compile_trace\r\n");
-	if (debugPos != STDString::npos) {
-		for (STDString::size_type i = debugPos; i < debugPos + 20; i++) {
-			original[i] = ' ';
-		}
-	}
-
-	if (esv::ExtensionState::Get().HasFeatureFlag("Preprocessor")) {
-		PreProcessStory(original, postProcessed);
-	} else {
-		postProcessed = original;
-	}
-
-	{
-		std::ofstream f(path, std::ios::out | std::ios::binary);
-		if (!f.good()) return;
-
-		f.write(postProcessed.data(), postProcessed.size());
+	auto stripMarkers = esv::ExtensionState::Get().HasFeatureFlag("Preprocessor");
+	if (!preprocessor_.ProcessFile(path, stripMarkers)) {
+		ERR("Failed to preprocess story file '%s'", ToStdUTF8(path).c_str());
 	}
 }
 
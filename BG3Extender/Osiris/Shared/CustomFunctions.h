@@ -8,6 +8,7 @@
 
 #include <Extender/Shared/Utils.h>
 #include <GameDefinitions/Osiris.h>
+#include <Osiris/Shared/StoryPreprocessor.h>
 
 namespace bg3se
 {
@@ -251,7 +252,6 @@ namespace bg3se
 
 		STDString GenerateHeaders() const;
 		void PreProcessStory(wchar_t const * path);
-		void PreProcessStory(STDString const & original, STDString & postProcessed);
 
 	private:
 		struct DynamicFunctionBindingInfo
@@ -272,6 +272,7 @@ namespace bg3se
 		std::size_t numStaticQueries_{ 0 };
 		std::size_t numStaticEvents_{ 0 };
 		bool staticRegistrationDone_{ false };
+		StoryPreprocessor preprocessor_;
 
 		void RegisterSignature(CustomFunction * func);
 		bool RegisterDynamicSignature(CustomFunction * func, uint32_t & index);
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "StoryPreprocessor.h"
+#include <fstream>
+
+namespace bg3se {
+
+static constexpr std::string_view ExtenderOnlyBegin = "/* [EXTENDER_ONLY]";
+static constexpr std::string_view ExtenderOnlyEnd = "*/";
+static constexpr std::string_view NoExtenderBegin = "// [BEGIN_NO_EXTENDER]";
+static constexpr std::string_view NoExtenderEnd = "// [END_NO_EXTENDER]";
+static constexpr std::string_view CompileTraceOption = "option compile_trace\r\n";
+
+void StoryPreprocessor::Transform(std::string_view input, STDString& output)
+{
+	output.clear();
+	output.reserve(input.size());
+
+	// A marker is only processed if its terminator appears somewhere after it
+	auto const lastExtenderOnlyEnd = input.rfind(ExtenderOnlyEnd);
+	auto const lastNoExtenderEnd = input.rfind(NoExtenderEnd);
+
+	bool inExtenderOnly{ false };
+	bool inNoExtender{ false };
+	// Set after an unterminated marker; no further markers of that kind are processed
+	bool extenderOnlyDone{ false };
+	bool noExtenderDone{ false };
+
+	std::size_t copyFrom{ 0 };
+	auto flush = [&](std::size_t to) {
+		if (!inNoExtender && to > copyFrom) {
+			output.append(input.data() + copyFrom, to - copyFrom);
+		}
+	};
+
+	auto pos = input.find_first_of("/*");
+	while (pos != std::string_view::npos) {
+		auto rest = input.substr(pos);
+
+		if (inExtenderOnly && rest.starts_with(ExtenderOnlyEnd)) {
+			flush(pos);
+			inExtenderOnly = false;
+			copyFrom = pos + ExtenderOnlyEnd.size();
+			pos = input.find_first_of("/*", copyFrom);
+			continue;
+		}
+
+		if (!inExtenderOnly && !extenderOnlyDone && rest.starts_with(ExtenderOnlyBegin)) {
+			if (lastExtenderOnlyEnd == std::string_view::npos || lastExtenderOnlyEnd < pos) {
+				extenderOnlyDone = true;
+			} else {
+				flush(pos);
+				inExtenderOnly = true;
+				// Skip the separator after the marker, unless the comment ends right away
+				copyFrom = pos + ExtenderOnlyBegin.size();
+				if (copyFrom < input.size() && !input.substr(copyFrom).starts_with(ExtenderOnlyEnd)) {
+					copyFrom++;
+				}
+
+				pos = input.find_first_of("/*", copyFrom);
+				continue;
+			}
+		}
+
+		if (!inNoExtender && !noExtenderDone && rest.starts_with(NoExtenderBegin)) {
+			if (lastNoExtenderEnd == std::string_view::npos || lastNoExtenderEnd < pos) {
+				noExtenderDone = true;
+			} else {
+				flush(pos);
+				inNoExtender = true;
+				pos = input.find_first_of("/*", pos + NoExtenderBegin.size());
+				continue;
+			}
+		}
+
+		if (inNoExtender && rest.starts_with(NoExtenderEnd)) {
+			inNoExtender = false;
+			// Skip the separator after the marker
+			copyFrom = std::min(pos + NoExtenderEnd.size() + 1, input.size());
+			pos = input.find_first_of("/*", copyFrom);
+			continue;
+		}
+
+		pos = input.find_first_of("/*", pos + 1);
+	}
+
+	flush(input.size());
+}
+
+void StoryPreprocessor::Process(std::string_view input, bool stripMarkers)
+{
+	if (stripMarkers) {
+		Transform(input, output_);
+	} else {
+		output_.assign(input.data(), input.size());
+	}
+
+	// Clear compile trace flags to avoid large compile traces
+	auto debugPos = output_.find(CompileTraceOption.data(), 0, CompileTraceOption.size());
+	if (debugPos != STDString::npos) {
+		std::fill_n(output_.begin() + debugPos, CompileTraceOption.size() - 2, ' ');
+	}
+}
+
+bool StoryPreprocessor::ProcessFile(wchar_t const* path, bool stripMarkers)
+{
+	HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart > 0x7fffffff) {
+		CloseHandle(file);
+		return false;
+	}
+
+	// Empty files can't be mapped; there is nothing to do for them anyway
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	auto view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr) {
+		if (mapping != NULL) CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	std::string_view input(reinterpret_cast<char const*>(view), (std::size_t)size.QuadPart);
+
+	InputKey key;
+	MurmurHash3_x64_128(input.data(), (int)input.size(), 0, key.Hash);
+	key.Size = input.size();
+	key.StripMarkers = stripMarkers;
+
+	if (cachedInput_ && *cachedInput_ == key) {
+		DEBUG("StoryPreprocessor: Story unchanged since last build, using cached output");
+	} else {
+		cachedInput_.reset();
+		Process(input, stripMarkers);
+		cachedInput_ = key;
+	}
+
+	bool unchanged = (output_.size() == input.size() && memcmp(output_.data(), input.data(), input.size()) == 0);
+
+	UnmapViewOfFile(view);
+	CloseHandle(mapping);
+	CloseHandle(file);
+
+	if (unchanged) {
+		return true;
+	}
+
+	std::ofstream f(path, std::ios::out | std::ios::binary);
+	if (!f.good()) {
+		return false;
+	}
+
+	f.write(output_.data(), output_.size());
+	return f.good();
+}
+
+}
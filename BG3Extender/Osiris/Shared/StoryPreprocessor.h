@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <optional>
+
+#include <GameDefinitions/Osiris.h>
+
+namespace bg3se
+{
+	// Strips extender-specific markers from story sources before compilation:
+	//  - "/* [EXTENDER_ONLY] ... */" comments are uncommented
+	//  - "// [BEGIN_NO_EXTENDER] ... // [END_NO_EXTENDER]" blocks are removed
+	// Unterminated markers are left in the output as-is.
+	class StoryPreprocessor
+	{
+	public:
+		// Transforms the input in a single pass; the output buffer is cleared before writing
+		static void Transform(std::string_view input, STDString& output);
+
+		// Preprocesses the story file in-place.
+		// The result of the last preprocessing run is kept; if the file contents didn't change
+		// since then, the cached output is written without transforming the input again.
+		bool ProcessFile(wchar_t const* path, bool stripMarkers);
+
+	private:
+		struct InputKey
+		{
+			uint64_t Hash[2]{ 0, 0 };
+			std::size_t Size{ 0 };
+			bool StripMarkers{ false };
+
+			inline bool operator == (InputKey const& o) const
+			{
+				return Hash[0] == o.Hash[0] && Hash[1] == o.Hash[1] && Size == o.Size && StripMarkers == o.StripMarkers;
+			}
+		};
+
+		// Output of the last run; reused as the output buffer of the next run
+		STDString output_;
+		std::optional<InputKey> cachedInput_;
+
+		void Process(std::string_view input, bool stripMarkers);
+	};
+}
@@ -72,9 +72,13 @@ void SEUpdaterGetLog(char* buf, uint32_t* length)
 		return;
 	}
 
-	*length = (uint32_t)gUpdater->GetLog().size();
+	// The log may grow between the size query and the copy; never write past the caller's buffer
+	auto log = gUpdater->GetLog();
 	if (buf != nullptr) {
-		std::copy(gUpdater->GetLog().begin(), gUpdater->GetLog().end(), buf);
+		*length = std::min(*length, (uint32_t)log.size());
+		std::copy(log.begin(), log.begin() + *length, buf);
+	} else {
+		*length = (uint32_t)log.size();
 	}
 }
 
@@ -97,6 +101,8 @@ bool SEUpdaterGetResourceVersion(int32_t* major, int32_t* minor, int32_t* revisi
 
 void SEUpdaterShutdown()
 {
+	StopUpdaterThread();
+
 	if (gUpdater) {
 		gUpdater.reset();
 	}
@@ -3,6 +3,7 @@
 #include <CoreLib/Crypto.h>
 #include <Shlwapi.h>
 #include <ZipLib/ZipFile.h>
+#include <ZipLib/extlibs/zlib/zlib.h>
 
 BEGIN_SE()
 
@@ -40,7 +41,13 @@ std::wstring CachedResource::TryCreateLocalCacheDirectory()
 	return path;
 }
 
-bool CachedResource::UpdateLocalPackage(std::vector<uint8_t> const& contents, std::string& reason)
+std::wstring CachedResource::TryCreatePackageDownloadPath()
+{
+	TryCreateLocalResourceCacheDirectory();
+	return GetLocalPackagePath() + L".tmp";
+}
+
+bool CachedResource::UpdateLocalPackage(std::wstring const& downloadPath, std::optional<PreviousVersion> const& previous, std::string& reason)
 {
 	TryCreateLocalResourceCacheDirectory();
 	auto packagePath = GetLocalPackagePath();
@@ -50,23 +57,17 @@ bool CachedResource::UpdateLocalPackage(std::vector<uint8_t> const& contents, st
 	// The shell Zip API won't tell us if it failed to overwrite one of the files, so we need to 
 	// check beforehand that the files are writeable.
 	if (!AreDllsWriteable()) {
+		DeleteFileW(downloadPath.c_str());
 		return false;
 	}
 
-	auto tempPath = packagePath + L".tmp";
-	if (!SaveFile(tempPath, contents)) {
-		DEBUG("Unable to write package temp file: %s", ToStdUTF8(tempPath).c_str());
-		reason = "Script Extender update failed:\r\n";
-		reason += std::string("Failed to write file ") + ToStdUTF8(tempPath);
-		return false;
-	}
-
-	if (!CryptoUtils::VerifySignedFile(tempPath, reason)) {
+	if (!CryptoUtils::VerifySignedFile(downloadPath, reason)) {
 		DEBUG("Unable to verify package signature: %s", reason.c_str());
+		DeleteFileW(downloadPath.c_str());
 		return false;
 	}
 
-	if (!MoveFileExW(tempPath.c_str(), packagePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+	if (!MoveFileExW(downloadPath.c_str(), packagePath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
 		DEBUG("Failed to move package file %s", packagePath.c_str());
 		reason = "Script Extender update failed:\r\n";
 		reason += std::string("Failed to move file ") + ToStdUTF8(packagePath);
@@ -77,7 +78,7 @@ bool CachedResource::UpdateLocalPackage(std::vector<uint8_t> const& contents, st
 	std::string unzipReason;
 	auto cachePath = TryCreateLocalCacheDirectory();
 	DEBUG("Unpacking update to %s", ToStdUTF8(cachePath).c_str());
-	if (UnzipPackage(packagePath, cachePath, reason)) {
+	if (UnzipPackage(packagePath, cachePath, previous, reason)) {
 		return true;
 	} else {
 		DEBUG("Unzipping failed: %s", reason.c_str());
@@ -128,7 +129,59 @@ bool CachedResource::AreDllsWriteable()
 	return true;
 }
 
-bool CachedResource::UnzipPackage(std::wstring const& zipPath, std::wstring const& resourcePath, std::string& reason)
+static std::optional<uint32_t> GetFileCrc32(std::wstring const& path)
+{
+	std::ifstream f(path.c_str(), std::ios::in | std::ios::binary);
+	if (!f.good()) {
+		return {};
+	}
+
+	auto crc = crc32(0L, Z_NULL, 0);
+	char buf[0x4000];
+	while (f) {
+		f.read(buf, std::size(buf));
+		auto read = f.gcount();
+		if (read > 0) {
+			crc = crc32(crc, reinterpret_cast<Bytef const*>(buf), (uInt)read);
+		}
+	}
+
+	if (f.bad()) {
+		return {};
+	}
+
+	return (uint32_t)crc;
+}
+
+static bool CopyUnchangedEntry(ZipArchive::Ptr const& previousArchive, std::wstring const& previousPath, 
+	ZipArchiveEntry::Ptr const& entry, std::wstring const& outPath)
+{
+	auto previousEntry = previousArchive->GetEntry(entry->GetFullName());
+	if (!previousEntry
+		|| previousEntry->GetCrc32() != entry->GetCrc32()
+		|| previousEntry->GetSize() != entry->GetSize()) {
+		return false;
+	}
+
+	auto previousFile = previousPath + L"\\" + FromStdUTF8(entry->GetFullName());
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(previousFile.c_str(), GetFileExInfoStandard, &attributes)
+		|| (((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow) != entry->GetSize()) {
+		return false;
+	}
+
+	// The previously extracted file is not covered by the package signature; make sure that it matches
+	// the verified archive entry, otherwise the entry is extracted from the new package instead
+	auto crc = GetFileCrc32(previousFile);
+	if (!crc || *crc != entry->GetCrc32()) {
+		DEBUG("Previously extracted file doesn't match package, not reusing: %s", entry->GetFullName().c_str());
+		return false;
+	}
+
+	return CopyFileW(previousFile.c_str(), outPath.c_str(), FALSE) == TRUE;
+}
+
+bool CachedResource::UnzipPackage(std::wstring const& zipPath, std::wstring const& resourcePath, std::optional<PreviousVersion> const& previous, std::string& reason)
 {
 	auto archive = ZipFile::Open(zipPath);
 	if (!archive) {
@@ -136,16 +189,35 @@ bool CachedResource::UnzipPackage(std::wstring const& zipPath, std::wstring cons
 		return false;
 	}
 
+	ZipArchive::Ptr previousArchive;
+	if (previous) {
+		previousArchive = ZipFile::Open(previous->PackagePath);
+	}
+
 	bool failed{ false };
 
 	auto entries = archive->GetEntriesCount();
 	for (auto i = 0; i < entries; i++) {
 		auto entry = archive->GetEntry(i);
 
-		DEBUG("Extracting: %s", entry->GetFullName().c_str());
-
 		auto outPath = resourcePath + L"\\" + FromStdUTF8(entry->GetFullName());
 		auto tempPath = resourcePath + L"\\extract.tmp";
+
+		if (previousArchive && CopyUnchangedEntry(previousArchive, previous->LocalPath, entry, tempPath)) {
+			DEBUG("Unchanged, copying from previous version: %s", entry->GetFullName().c_str());
+			if (!MoveFileExW(tempPath.c_str(), outPath.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+				DEBUG("Failed to move file %s", entry->GetFullName().c_str());
+				reason = "Script Extender update failed:\r\n";
+				reason += std::string("Failed to update file ") + entry->GetFullName();
+				failed = true;
+				break;
+			}
+
+			continue;
+		}
+
+		DEBUG("Extracting: %s", entry->GetFullName().c_str());
+
 		std::ofstream f(tempPath.c_str(), std::ios::out | std::ios::binary);
 		if (!f.good()) {
 			DEBUG("Failed to open %s for extraction", entry->GetFullName().c_str());
@@ -232,13 +304,15 @@ std::wstring ResourceCacheRepository::GetCachedManifestPath() const
 	return path_ + L"\\Manifest-" + FromStdUTF8(config_.UpdateChannel) + L".json";
 }
 
-Manifest const& ResourceCacheRepository::GetManifest() const
+Manifest ResourceCacheRepository::GetManifest() const
 {
+	std::lock_guard _(mutex_);
 	return manifest_;
 }
 
 bool ResourceCacheRepository::LoadManifest(std::wstring const& path)
 {
+	std::lock_guard _(mutex_);
 	std::string manifestText;
 	DEBUG("Loading cache manifest: %s", ToStdUTF8(path).c_str());
 	if (LoadFile(path, manifestText)) {
@@ -261,6 +335,7 @@ bool ResourceCacheRepository::LoadManifest(std::wstring const& path)
 
 bool ResourceCacheRepository::SaveManifest(std::wstring const& path)
 {
+	std::lock_guard _(mutex_);
 	manifest_.ManifestVersion = Manifest::CurrentVersion;
 	manifest_.ManifestMinorVersion = Manifest::CurrentMinorVersion;
 
@@ -273,6 +348,7 @@ bool ResourceCacheRepository::SaveManifest(std::wstring const& path)
 
 bool ResourceCacheRepository::ResourceExists(std::string const& name, Manifest::ResourceVersion const& version) const
 {
+	std::lock_guard _(mutex_);
 	auto resource = manifest_.Resources.find(name);
 	if (resource == manifest_.Resources.end()) {
 		return false;
@@ -286,11 +362,66 @@ bool ResourceCacheRepository::ResourceExists(std::string const& name, Manifest::
 	return HasLocalCopy(resource->second, found->second);
 }
 
-bool ResourceCacheRepository::UpdateLocalPackage(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::vector<uint8_t> const& contents, std::string& reason)
+std::wstring ResourceCacheRepository::TryCreatePackageDownloadPath(Manifest::Resource const& resource, Manifest::ResourceVersion const& version)
+{
+	CachedResource res(path_, resource, version);
+	return res.TryCreatePackageDownloadPath();
+}
+
+std::vector<std::wstring> ResourceCacheRepository::GetLocalPackagePaths(std::string const& name) const
+{
+	std::lock_guard _(mutex_);
+	std::vector<std::wstring> paths;
+	auto resource = manifest_.Resources.find(name);
+	if (resource == manifest_.Resources.end()) {
+		return paths;
+	}
+
+	for (auto const& ver : resource->second.ResourceVersions) {
+		CachedResource res(path_, resource->second, ver.second);
+		auto packagePath = res.GetLocalPackagePath();
+		if (PathFileExistsW(packagePath.c_str())) {
+			paths.push_back(packagePath);
+		}
+	}
+
+	return paths;
+}
+
+std::optional<CachedResource::PreviousVersion> ResourceCacheRepository::FindPreviousVersion(Manifest::Resource const& resource, Manifest::ResourceVersion const& version) const
+{
+	auto resIt = manifest_.Resources.find(resource.Name);
+	if (resIt == manifest_.Resources.end()) {
+		return {};
+	}
+
+	// Use the most recent cached build, as it's the most likely to share files with the new one
+	Manifest::ResourceVersion const* previous{ nullptr };
+	for (auto const& ver : resIt->second.ResourceVersions) {
+		if (ver.second.Digest != version.Digest
+			&& HasLocalCopy(resIt->second, ver.second)
+			&& (previous == nullptr || ver.second.BuildDate > previous->BuildDate)) {
+			previous = &ver.second;
+		}
+	}
+
+	if (previous == nullptr) {
+		return {};
+	}
+
+	CachedResource res(path_, resIt->second, *previous);
+	return CachedResource::PreviousVersion{
+		.PackagePath = res.GetLocalPackagePath(),
+		.LocalPath = res.GetLocalPath()
+	};
+}
+
+bool ResourceCacheRepository::UpdateLocalPackage(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::wstring const& downloadPath, std::string& reason)
 {
+	std::lock_guard _(mutex_);
 	DEBUG("Updating local copy of resource %s, digest %s", resource.Name.c_str(), version.Digest.c_str());
 	CachedResource res(path_, resource, version);
-	if (res.UpdateLocalPackage(contents, reason)) {
+	if (res.UpdateLocalPackage(downloadPath, FindPreviousVersion(resource, version), reason)) {
 		AddResourceToManifest(resource, version);
 		if (!SaveManifest(GetCachedManifestPath())) {
 			reason = "Script Extender update failed:\r\n";
@@ -306,6 +437,7 @@ bool ResourceCacheRepository::UpdateLocalPackage(Manifest::Resource const& resou
 
 void ResourceCacheRepository::UpdateFromManifest(Manifest const& manifest)
 {
+	std::lock_guard _(mutex_);
 	for (auto const& res : manifest.Resources) {
 		for (auto const& ver : res.second.ResourceVersions) {
 			UpdateFromLatestMetadata(res.second, ver.second);
@@ -337,6 +469,7 @@ void ResourceCacheRepository::UpdateFromManifest(Manifest const& manifest)
 
 bool ResourceCacheRepository::UpdateFromLatestMetadata(Manifest::Resource const& resource, Manifest::ResourceVersion const& version)
 {
+	std::lock_guard _(mutex_);
 	auto resIt = manifest_.Resources.find(resource.Name);
 	if (resIt == manifest_.Resources.end()) {
 		return false;
@@ -358,6 +491,7 @@ bool ResourceCacheRepository::UpdateFromLatestMetadata(Manifest::Resource const&
 
 bool ResourceCacheRepository::RemoveResource(Manifest::Resource const& resource, Manifest::ResourceVersion const& version)
 {
+	std::lock_guard _(mutex_);
 	auto resIt = manifest_.Resources.find(resource.Name);
 	if (resIt == manifest_.Resources.end()) {
 		return false;
@@ -368,6 +502,14 @@ bool ResourceCacheRepository::RemoveResource(Manifest::Resource const& resource,
 		return false;
 	}
 
+	if (version.Digest == inUseDigest_) {
+		// Files of the loaded version can't be deleted; revoke it so it's not launched again
+		// and remove it during the next update check instead
+		DEBUG("Resource %s, digest %s is in use; marking as revoked", resource.Name.c_str(), version.Digest.c_str());
+		verIt->second.Revoked = true;
+		return true;
+	}
+
 	DEBUG("Removing local copy of resource %s, digest %s", resource.Name.c_str(), version.Digest.c_str());
 
 	CachedResource res(path_, resource, version);
@@ -376,8 +518,45 @@ bool ResourceCacheRepository::RemoveResource(Manifest::Resource const& resource,
 	return true;
 }
 
+void ResourceCacheRepository::SupersedeVersions(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, VersionNumber const& gameVersion)
+{
+	std::lock_guard _(mutex_);
+	auto resIt = manifest_.Resources.find(resource.Name);
+	if (resIt == manifest_.Resources.end()) {
+		return;
+	}
+
+	std::vector<Manifest::ResourceVersion> removals;
+	for (auto const& ver : resIt->second.ResourceVersions) {
+		if (ver.second.Digest != version.Digest
+			&& ver.second.BuildDate < version.BuildDate
+			&& !(ver.second.MinGameVersion && *ver.second.MinGameVersion > gameVersion)
+			&& !(ver.second.MaxGameVersion && *ver.second.MaxGameVersion < gameVersion)) {
+			DEBUG("Resource %s, digest %s superseded by mandatory version %s", resource.Name.c_str(), ver.second.Digest.c_str(), version.Digest.c_str());
+			removals.push_back(ver.second);
+		}
+	}
+
+	if (removals.empty()) {
+		return;
+	}
+
+	for (auto const& removal : removals) {
+		RemoveResource(resIt->second, removal);
+	}
+
+	SaveManifest(GetCachedManifestPath());
+}
+
+void ResourceCacheRepository::SetVersionInUse(std::string const& digest)
+{
+	std::lock_guard _(mutex_);
+	inUseDigest_ = digest;
+}
+
 std::optional<Manifest::ResourceVersion> ResourceCacheRepository::FindResourceVersion(std::string const& name, VersionNumber const& gameVersion)
 {
+	std::lock_guard _(mutex_);
 	auto resource = manifest_.Resources.find(name);
 	if (resource == manifest_.Resources.end()) {
 		return {};
@@ -388,6 +567,7 @@ std::optional<Manifest::ResourceVersion> ResourceCacheRepository::FindResourceVe
 
 std::optional<std::wstring> ResourceCacheRepository::FindResourcePath(std::string const& name, VersionNumber const& gameVersion)
 {
+	std::lock_guard _(mutex_);
 	auto resource = manifest_.Resources.find(name);
 	if (resource == manifest_.Resources.end()) {
 		return {};
@@ -408,6 +588,7 @@ std::optional<std::wstring> ResourceCacheRepository::FindResourcePath(std::strin
 
 std::optional<std::wstring> ResourceCacheRepository::FindResourceDllPath(std::string const& name, VersionNumber const& gameVersion)
 {
+	std::lock_guard _(mutex_);
 	auto resource = manifest_.Resources.find(name);
 	if (resource == manifest_.Resources.end()) {
 		return {};
@@ -449,6 +630,8 @@ void ResourceCacheRepository::AddVersionToResource(Manifest::Resource& resource,
 {
 	Manifest::ResourceVersion ver{ version };
 	ver.URL = "";
+	// Chunks of cached packages are always recomputed from the local file
+	ver.Chunks.clear();
 
 	auto it = resource.ResourceVersions.find(version.Digest);
 	if (it == resource.ResourceVersions.end()) {
@@ -1,18 +1,28 @@
 #include "stdafx.h"
 #include "Manifest.h"
+#include <mutex>
 
 BEGIN_SE()
 
 class CachedResource
 {
 public:
+	// Package and extracted files of an older cached version of the resource;
+	// files that are unchanged in the new package are copied from here instead of being extracted
+	struct PreviousVersion
+	{
+		std::wstring PackagePath;
+		std::wstring LocalPath;
+	};
+
 	CachedResource(std::wstring const& cachePath, Manifest::Resource const& resource, Manifest::ResourceVersion const& version);
 	std::wstring GetResourceLocalPath() const;
 	std::wstring TryCreateLocalResourceCacheDirectory();
 	std::wstring GetLocalPath() const;
 	std::wstring GetLocalPackagePath() const;
 	std::wstring TryCreateLocalCacheDirectory();
-	bool UpdateLocalPackage(std::vector<uint8_t> const& contents, std::string& reason);
+	std::wstring TryCreatePackageDownloadPath();
+	bool UpdateLocalPackage(std::wstring const& downloadPath, std::optional<PreviousVersion> const& previous, std::string& reason);
 	bool RemoveLocalPackage();
 	std::wstring GetAppDllPath();
 	bool ExtenderDLLExists();
@@ -23,24 +33,33 @@ private:
 	Manifest::ResourceVersion const& version_;
 
 	bool AreDllsWriteable();
-	bool UnzipPackage(std::wstring const& zipPath, std::wstring const& resourcePath, std::string& reason);
+	bool UnzipPackage(std::wstring const& zipPath, std::wstring const& resourcePath, std::optional<PreviousVersion> const& previous, std::string& reason);
 	bool DeleteLocalCacheFromZip(std::wstring const& zipPath, std::wstring const& resourcePath);
 };
 
 
+// The cache is updated by the background update thread while the game (and the exported API) may be reading it;
+// all public functions lock the repository.
 class ResourceCacheRepository
 {
 public:
 	ResourceCacheRepository(UpdaterConfig const& config, std::wstring const& path);
 	std::wstring GetCachedManifestPath() const;
-	Manifest const& GetManifest() const;
+	Manifest GetManifest() const;
 	bool LoadManifest(std::wstring const& path);
 	bool SaveManifest(std::wstring const& path);
 	bool ResourceExists(std::string const& name, Manifest::ResourceVersion const& version) const;
-	bool UpdateLocalPackage(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::vector<uint8_t> const& contents, std::string& reason);
+	std::wstring TryCreatePackageDownloadPath(Manifest::Resource const& resource, Manifest::ResourceVersion const& version);
+	// Paths of the packages of all locally cached versions of a resource
+	std::vector<std::wstring> GetLocalPackagePaths(std::string const& name) const;
+	bool UpdateLocalPackage(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::wstring const& downloadPath, std::string& reason);
 	void UpdateFromManifest(Manifest const& manifest);
 	bool UpdateFromLatestMetadata(Manifest::Resource const& resource, Manifest::ResourceVersion const& version);
 	bool RemoveResource(Manifest::Resource const& resource, Manifest::ResourceVersion const& version);
+	// Removes cached versions that are older than a mandatory version and are usable on the specified game version
+	void SupersedeVersions(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, VersionNumber const& gameVersion);
+	// Marks the version that is currently loaded by the game; its files are kept if it's removed from the cache
+	void SetVersionInUse(std::string const& digest);
 	std::optional<Manifest::ResourceVersion> FindResourceVersion(std::string const& name, VersionNumber const& gameVersion);
 	std::optional<std::wstring> FindResourcePath(std::string const& name, VersionNumber const& gameVersion);
 	std::optional<std::wstring> FindResourceDllPath(std::string const& name, VersionNumber const& gameVersion);
@@ -49,8 +68,11 @@ private:
 	UpdaterConfig const& config_;
 	std::wstring path_;
 	Manifest manifest_;
+	std::string inUseDigest_;
+	mutable std::recursive_mutex mutex_;
 
 	bool HasLocalCopy(Manifest::Resource const& resource, Manifest::ResourceVersion const& version) const;
+	std::optional<CachedResource::PreviousVersion> FindPreviousVersion(Manifest::Resource const& resource, Manifest::ResourceVersion const& version) const;
 	void AddResourceToManifest(Manifest::Resource const& resource, Manifest::ResourceVersion const& version);
 	void AddVersionToResource(Manifest::Resource& resource, Manifest::ResourceVersion const& version);
 };
@@ -20,6 +20,7 @@ struct UpdaterConfig
 	bool ValidateSignature;
 	bool IPv4Only;
 	bool DisableUpdates;
+	bool BackgroundUpdates;
 };
 
 struct THREADNAME_INFO
@@ -32,6 +32,15 @@ void HttpFetcher::LogError(CURL* curl, CURLcode result)
 }
 
 bool HttpFetcher::Fetch(std::string const& url, std::vector<uint8_t> & response)
+{
+	response.clear();
+	return Fetch(url, [&response](uint8_t const* data, size_t size) {
+		response.insert(response.end(), data, data + size);
+		return true;
+	});
+}
+
+bool HttpFetcher::Fetch(std::string const& url, DataCallback const& onData, std::optional<std::pair<uint64_t, uint64_t>> range)
 {
 	cancelling_ = false;
 	socket_ = NULL;
@@ -45,8 +54,17 @@ bool HttpFetcher::Fetch(std::string const& url, std::vector<uint8_t> & response)
 	curl_easy_setopt(curl_, CURLOPT_HEADER, 0);
 	curl_easy_setopt(curl_, CURLOPT_FAILONERROR, 1);
 	curl_easy_setopt(curl_, CURLOPT_CONNECTTIMEOUT_MS, 10000);
+	curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, (long)TimeoutMs);
 	curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_0);
 
+	std::string rangeStr;
+	if (range) {
+		rangeStr = std::to_string(range->first) + "-" + std::to_string(range->second);
+		curl_easy_setopt(curl_, CURLOPT_RANGE, rangeStr.c_str());
+	} else {
+		curl_easy_setopt(curl_, CURLOPT_RANGE, NULL);
+	}
+
 	if (DebugLogging) {
 		curl_easy_setopt(curl_, CURLOPT_VERBOSE, 1);
 		curl_easy_setopt(curl_, CURLOPT_DEBUGFUNCTION, &DebugFunc);
@@ -62,14 +80,14 @@ bool HttpFetcher::Fetch(std::string const& url, std::vector<uint8_t> & response)
 	curl_easy_setopt(curl_, CURLOPT_OPENSOCKETDATA, &this->socket_);
 	curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, &WriteFunc);
 	curl_easy_setopt(curl_, CURLOPT_WRITEDATA, this);
-	lastResponse_.clear();
+	onData_ = &onData;
 
 	lastResult_ = curl_easy_perform(curl_);
+	onData_ = nullptr;
 	if (lastResult_ != CURLE_OK) {
 		LogError(curl_, lastResult_);
 	}
 
-	response = lastResponse_;
 	return (lastResult_ == CURLE_OK);
 }
 
@@ -102,9 +120,11 @@ curl_socket_t HttpFetcher::OpenSocketFunc(SOCKET* data, curlsocktype purpose, st
 
 size_t HttpFetcher::WriteFunc(char* contents, size_t size, size_t nmemb, HttpFetcher* self)
 {
-	auto pos = self->lastResponse_.size();
-	self->lastResponse_.resize(self->lastResponse_.size() + size * nmemb);
-	memcpy(self->lastResponse_.data() + pos, contents, size * nmemb);
+	if (self->onData_ != nullptr && !(*self->onData_)(reinterpret_cast<uint8_t const*>(contents), size * nmemb)) {
+		// Returning a different size aborts the transfer with CURLE_WRITE_ERROR
+		return 0;
+	}
+
 	return size * nmemb;
 }
 
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <functional>
 #include <curl/curl.h>
 
 BEGIN_SE()
@@ -11,11 +12,19 @@ class HttpFetcher
 public:
 	bool DebugLogging{ false };
 	bool IPv4Only{ false };
+	// Max. duration of a transfer; 0 = no limit
+	uint32_t TimeoutMs{ 0 };
 
 	HttpFetcher();
 	~HttpFetcher();
 
+	// Called with each block of the response as it arrives; returning false aborts the transfer
+	using DataCallback = std::function<bool(uint8_t const* data, size_t size)>;
+
 	bool Fetch(std::string const& url, std::vector<uint8_t> & response);
+	// Streams the response to the callback instead of buffering it.
+	// If a range is specified, only bytes [first, last] of the resource are requested.
+	bool Fetch(std::string const& url, DataCallback const& onData, std::optional<std::pair<uint64_t, uint64_t>> range = {});
 	void Cancel();
 
 	inline CURLcode GetLastResultCode() const
@@ -30,7 +39,7 @@ public:
 
 private:
 	std::string lastError_;
-	std::vector<uint8_t> lastResponse_;
+	DataCallback const* onData_{ nullptr };
 	long lastHttpCode_{ 0 };
 	CURLcode lastResult_{ CURLE_OK };
 	CURL* curl_{ NULL };
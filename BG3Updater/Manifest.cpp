@@ -41,16 +41,7 @@ std::optional<std::string> GetFileDigest(std::wstring const& path)
 
 	uint8_t digest[TC_SHA256_DIGEST_SIZE];
 	CryptoUtils::SHA256(contents.data(), contents.size(), digest);
-
-	static char const* hex = "0123456789abcdef";
-
-	std::string digestStr;
-	for (auto i = 0; i < std::size(digest); i++) {
-		digestStr += hex[digest[i] >> 4];
-		digestStr += hex[digest[i] & 0x0f];
-	}
-
-	return digestStr;
+	return SHA256Stream::ToHex(digest);
 }
 
 bool Manifest::ResourceVersion::UpdatePackageMetadata(std::wstring const& path)
@@ -62,6 +53,10 @@ bool Manifest::ResourceVersion::UpdatePackageMetadata(std::wstring const& path)
 
     Digest = *digest;
 
+	if (!PackageChunker::SplitFile(path, Chunks)) {
+		return false;
+	}
+
     auto hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
     if (hFile == INVALID_HANDLE_VALUE) {
         return false;
@@ -289,8 +284,39 @@ bool ManifestSerializer::ParseVersion(Json::Value const& node, Manifest::Resourc
 	version.Digest = node["Digest"].asString();
 	version.BuildDate = node["BuildDate"].asUInt64();
 	version.Revoked = node["Revoked"].isBool() ? node["Revoked"].asBool() : false;
+	version.Mandatory = node["Mandatory"].isBool() ? node["Mandatory"].asBool() : false;
 	version.Signature = node["Signature"].asString();
 	version.Notice = node["Notice"].asString();
+	return ParseChunks(node["Chunks"], version, parseError);
+}
+
+bool ManifestSerializer::ParseChunks(Json::Value const& node, Manifest::ResourceVersion& version, std::string& parseError)
+{
+	if (node.isNull()) {
+		return true;
+	}
+
+	if (!node.isArray()) {
+		parseError = "Bundle version 'Chunks' is not an array";
+		return false;
+	}
+
+	uint64_t offset{ 0 };
+	for (auto const& chunkNode : node) {
+		PackageChunk chunk;
+		chunk.Offset = chunkNode["Offset"].asUInt64();
+		chunk.Size = chunkNode["Size"].asUInt();
+		chunk.Digest = chunkNode["Digest"].asString();
+
+		if (chunk.Offset != offset || chunk.Size == 0 || chunk.Digest.empty()) {
+			parseError = "Bundle version has malformed chunk list";
+			return false;
+		}
+
+		offset += chunk.Size;
+		version.Chunks.push_back(std::move(chunk));
+	}
+
 	return true;
 }
 
@@ -321,6 +347,10 @@ std::string ManifestSerializer::Stringify(Manifest& manifest)
 				jsonVer["Revoked"] = true;
 			}
 
+			if (ver.second.Mandatory) {
+				jsonVer["Mandatory"] = true;
+			}
+
 			if (!ver.second.Signature.empty()) {
 				jsonVer["Signature"] = ver.second.Signature;
 			}
@@ -329,6 +359,19 @@ std::string ManifestSerializer::Stringify(Manifest& manifest)
 				jsonVer["Notice"] = ver.second.Notice;
 			}
 
+			if (!ver.second.Chunks.empty()) {
+				Json::Value chunks(Json::arrayValue);
+				for (auto const& chunk : ver.second.Chunks) {
+					Json::Value jsonChunk(Json::objectValue);
+					jsonChunk["Offset"] = chunk.Offset;
+					jsonChunk["Size"] = chunk.Size;
+					jsonChunk["Digest"] = chunk.Digest;
+					chunks.append(jsonChunk);
+				}
+
+				jsonVer["Chunks"] = chunks;
+			}
+
 			versions.append(jsonVer);
 		}
 
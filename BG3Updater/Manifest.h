@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <optional>
 #include "json/json.h"
+#include "PackageChunker.h"
 
 BEGIN_SE()
 
@@ -86,7 +87,9 @@ enum class ManifestParseResult
 struct Manifest
 {
 	static constexpr int32_t CurrentVersion = 1;
-	static constexpr int32_t CurrentMinorVersion = 1;
+	// Minor version 2: added package chunk list
+	// Minor version 3: added mandatory flag
+	static constexpr int32_t CurrentMinorVersion = 3;
 
 	struct ResourceVersion
 	{
@@ -96,8 +99,13 @@ struct Manifest
 		std::optional<VersionNumber> MinGameVersion, MaxGameVersion;
 		uint64_t BuildDate{ 0 };
 		bool Revoked{ false };
+		// Older versions must not be launched once this version is available;
+		// clients block game startup until this version is installed
+		bool Mandatory{ false };
 		std::string Signature;
 		std::string Notice;
+		// Content-defined chunks of the package; used for fetching only the changed parts of the package
+		std::vector<PackageChunk> Chunks;
 
 		bool UpdatePackageMetadata(std::wstring const& path);
 		bool UpdateDLLMetadata(std::wstring const& path);
@@ -131,6 +139,7 @@ private:
 	bool Parse(Json::Value const& node, Manifest& manifest, std::string& parseError);
 	bool ParseResource(Json::Value const& node, Manifest::Resource& resource, std::string& parseError);
 	bool ParseVersion(Json::Value const& node, Manifest::ResourceVersion& version, std::string& parseError);
+	bool ParseChunks(Json::Value const& node, Manifest::ResourceVersion& version, std::string& parseError);
 };
 
 
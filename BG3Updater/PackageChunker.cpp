@@ -0,0 +1,109 @@
+#include <stdafx.h>
+#include "PackageChunker.h"
+#include <array>
+
+BEGIN_SE()
+
+SHA256Stream::SHA256Stream()
+{
+	tc_sha256_init(&state_);
+}
+
+void SHA256Stream::Update(uint8_t const* data, size_t size)
+{
+	if (size > 0) {
+		tc_sha256_update(&state_, data, size);
+	}
+}
+
+std::string SHA256Stream::Finalize()
+{
+	uint8_t digest[TC_SHA256_DIGEST_SIZE];
+	tc_sha256_final(digest, &state_);
+	return ToHex(digest);
+}
+
+std::string SHA256Stream::ToHex(uint8_t const* digest)
+{
+	static char const* hex = "0123456789abcdef";
+
+	std::string digestStr;
+	for (auto i = 0; i < TC_SHA256_DIGEST_SIZE; i++) {
+		digestStr += hex[digest[i] >> 4];
+		digestStr += hex[digest[i] & 0x0f];
+	}
+
+	return digestStr;
+}
+
+
+// Random values for each byte of the gear hash; generated with a fixed seed so all builds produce the same chunks
+static std::array<uint64_t, 256> MakeGearTable()
+{
+	std::array<uint64_t, 256> table;
+	uint64_t state = 0x42473353454c5441ull;
+	for (auto& value : table) {
+		// splitmix64
+		state += 0x9e3779b97f4a7c15ull;
+		uint64_t z = state;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		value = z ^ (z >> 31);
+	}
+
+	return table;
+}
+
+static std::array<uint64_t, 256> const GearTable = MakeGearTable();
+
+size_t PackageChunker::FindBoundary(uint8_t const* data, size_t size)
+{
+	if (size <= MinChunkSize) {
+		return size;
+	}
+
+	auto end = std::min<size_t>(size, MaxChunkSize);
+	uint64_t hash{ 0 };
+	for (size_t i = MinChunkSize; i < end; i++) {
+		hash = (hash << 1) + GearTable[data[i]];
+		if ((hash & BoundaryMask) == 0) {
+			return i + 1;
+		}
+	}
+
+	return end;
+}
+
+void PackageChunker::Split(uint8_t const* data, size_t size, std::vector<PackageChunk>& chunks)
+{
+	chunks.clear();
+
+	size_t offset{ 0 };
+	while (offset < size) {
+		auto chunkSize = FindBoundary(data + offset, size - offset);
+
+		PackageChunk chunk;
+		chunk.Offset = offset;
+		chunk.Size = (uint32_t)chunkSize;
+
+		SHA256Stream digest;
+		digest.Update(data + offset, chunkSize);
+		chunk.Digest = digest.Finalize();
+		chunks.push_back(std::move(chunk));
+
+		offset += chunkSize;
+	}
+}
+
+bool PackageChunker::SplitFile(std::wstring const& path, std::vector<PackageChunk>& chunks)
+{
+	std::vector<uint8_t> contents;
+	if (!LoadFile(path, contents)) {
+		return false;
+	}
+
+	Split(contents.data(), contents.size(), chunks);
+	return true;
+}
+
+END_SE()
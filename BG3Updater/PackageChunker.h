@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <tinycrypt/sha256.h>
+
+BEGIN_SE()
+
+// Incrementally computes the SHA-256 digest of a stream, in the hex format used by manifest digests
+class SHA256Stream
+{
+public:
+	SHA256Stream();
+	void Update(uint8_t const* data, size_t size);
+	std::string Finalize();
+
+	static std::string ToHex(uint8_t const* digest);
+
+private:
+	tc_sha256_state_struct state_;
+};
+
+struct PackageChunk
+{
+	uint64_t Offset{ 0 };
+	uint32_t Size{ 0 };
+	std::string Digest;
+};
+
+// Splits update packages into content-defined chunks; boundaries are chosen based on the
+// contents of the preceding bytes, so a change in the package only affects the chunks around it.
+// The chunking parameters must not change, as clients compare their own chunks of cached packages
+// against the chunks listed in the manifest.
+class PackageChunker
+{
+public:
+	static constexpr uint32_t MinChunkSize = 0x4000;
+	static constexpr uint32_t MaxChunkSize = 0x40000;
+	// A boundary is placed where the top bits of the rolling hash are zero (~64k chunks on average)
+	static constexpr uint64_t BoundaryMask = 0xffff000000000000ull;
+
+	static void Split(uint8_t const* data, size_t size, std::vector<PackageChunk>& chunks);
+	static bool SplitFile(std::wstring const& path, std::vector<PackageChunk>& chunks);
+
+private:
+	static size_t FindBoundary(uint8_t const* data, size_t size);
+};
+
+END_SE()
@@ -81,6 +81,10 @@ bool ResourceUpdater::Update(Manifest const& manifest, std::string const& resour
 		return false;
 	}
 
+	if (version->Mandatory) {
+		cache_.SupersedeVersions(resIt->second, *version, gameVersion);
+	}
+
 	if (cache_.ResourceExists(resIt->first, *version)) {
 		DEBUG("Resource already cached locally, skipping update: Version %s, Digest %s", version->Version.ToString().c_str(), version->Digest.c_str());
 		return true;
@@ -101,9 +105,57 @@ bool ResourceUpdater::Update(Manifest::Resource const& resource, Manifest::Resou
 	}
 
 	gUpdater->SetStatusText(std::wstring(L"Downloading update: ") + FromStdUTF8(version.Version.ToString()));
-	DEBUG("Fetching update package: %s", version.URL.c_str());
-	std::vector<uint8_t> response;
-	if (!fetcher_.Fetch(version.URL, response)) {
+	auto downloadPath = cache_.TryCreatePackageDownloadPath(resource, version);
+
+	bool fetched{ false };
+	if (!version.Chunks.empty()) {
+		DEBUG("Fetching changed chunks of update package: %s", version.URL.c_str());
+		DeltaPackageFetcher deltaFetcher(fetcher_, cache_);
+		fetched = deltaFetcher.Fetch(resource, version, downloadPath);
+		if (!fetched && gUpdater->IsCancellingUpdate()) {
+			reason.Category = ErrorCategory::UpdateDownload;
+			reason.Message = "Update cancelled.";
+			return false;
+		}
+	}
+
+	if (!fetched) {
+		DEBUG("Fetching update package: %s", version.URL.c_str());
+		if (!FetchPackage(version, downloadPath, reason)) {
+			return false;
+		}
+	}
+
+	gUpdater->SetStatusText(std::wstring(L"Unpacking update: ") + FromStdUTF8(version.Version.ToString()));
+	if (cache_.UpdateLocalPackage(resource, version, downloadPath, reason.Message)) {
+		return true;
+	} else {
+		reason.Category = ErrorCategory::LocalUpdate;
+		return false;
+	}
+}
+
+bool ResourceUpdater::FetchPackage(Manifest::ResourceVersion const& version, std::wstring const& path, ErrorReason& reason)
+{
+	std::ofstream f(path.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!f.good()) {
+		reason.Category = ErrorCategory::LocalUpdate;
+		reason.Message = "Script Extender update failed:\r\n";
+		reason.Message += std::string("Failed to write file ") + ToStdUTF8(path);
+		return false;
+	}
+
+	// Hash the package while it's being downloaded, so we don't need another pass over the file
+	SHA256Stream digest;
+	HttpFetcher::DataCallback onData = [&](uint8_t const* data, size_t size) {
+		f.write(reinterpret_cast<char const*>(data), size);
+		digest.Update(data, size);
+		return f.good();
+	};
+
+	if (!fetcher_.Fetch(version.URL, onData)) {
+		f.close();
+		DeleteFileW(path.c_str());
 		reason.Category = ErrorCategory::UpdateDownload;
 		reason.Message = "Unable to download package: ";
 		reason.Message += fetcher_.GetLastError();
@@ -111,13 +163,184 @@ bool ResourceUpdater::Update(Manifest::Resource const& resource, Manifest::Resou
 		return false;
 	}
 
-	gUpdater->SetStatusText(std::wstring(L"Unpacking update: ") + FromStdUTF8(version.Version.ToString()));
-	if (cache_.UpdateLocalPackage(resource, version, response, reason.Message)) {
+	f.close();
+	auto packageDigest = digest.Finalize();
+	if (packageDigest != version.Digest) {
+		DEBUG("Package digest mismatch; expected %s, got %s", version.Digest.c_str(), packageDigest.c_str());
+		DeleteFileW(path.c_str());
+		reason.Category = ErrorCategory::UpdateDownload;
+		reason.Message = "Unable to download package: digest mismatch";
+		return false;
+	}
+
+	return true;
+}
+
+
+DeltaPackageFetcher::DeltaPackageFetcher(HttpFetcher& fetcher, ResourceCacheRepository& cache)
+	: fetcher_(fetcher), cache_(cache)
+{}
+
+bool DeltaPackageFetcher::IndexLocalPackages(std::string const& name)
+{
+	for (auto const& path : cache_.GetLocalPackagePaths(name)) {
+		std::vector<uint8_t> contents;
+		if (!LoadFile(path, contents)) {
+			continue;
+		}
+
+		std::vector<PackageChunk> chunks;
+		PackageChunker::Split(contents.data(), contents.size(), chunks);
+
+		auto packageIndex = (uint32_t)packages_.size();
+		for (auto const& chunk : chunks) {
+			localChunks_.insert(std::make_pair(chunk.Digest, LocalChunk{ packageIndex, chunk.Offset, chunk.Size }));
+		}
+
+		packages_.push_back(std::move(contents));
+	}
+
+	return !localChunks_.empty();
+}
+
+bool DeltaPackageFetcher::Fetch(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::wstring const& path)
+{
+	if (!IndexLocalPackages(resource.Name)) {
+		DEBUG("No cached packages available for delta update");
+		return false;
+	}
+
+	auto const& chunks = version.Chunks;
+	size_t reusedChunks{ 0 };
+	uint64_t reusedBytes{ 0 };
+	for (auto const& chunk : chunks) {
+		auto local = localChunks_.find(chunk.Digest);
+		if (local != localChunks_.end() && local->second.Size == chunk.Size) {
+			reusedChunks++;
+			reusedBytes += chunk.Size;
+		}
+	}
+
+	if (reusedChunks == 0) {
+		DEBUG("No chunks of the update package are available locally");
+		return false;
+	}
+
+	DEBUG("Reusing %d of %d chunks (%lld bytes) from cached packages", (int)reusedChunks, (int)chunks.size(), reusedBytes);
+
+	std::ofstream out(path.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!out.good()) {
+		DEBUG("Unable to write package temp file: %s", ToStdUTF8(path).c_str());
+		return false;
+	}
+
+	auto isLocal = [this](PackageChunk const& chunk) {
+		auto local = localChunks_.find(chunk.Digest);
+		return local != localChunks_.end() && local->second.Size == chunk.Size;
+	};
+
+	SHA256Stream digest;
+	size_t i = 0;
+	while (i < chunks.size()) {
+		if (gUpdater->IsCancellingUpdate()) {
+			out.close();
+			DeleteFileW(path.c_str());
+			return false;
+		}
+
+		if (isLocal(chunks[i])) {
+			auto const& local = localChunks_.find(chunks[i].Digest)->second;
+			auto data = packages_[local.Package].data() + local.Offset;
+			out.write(reinterpret_cast<char const*>(data), local.Size);
+			digest.Update(data, local.Size);
+			i++;
+			continue;
+		}
+
+		// Merge adjacent missing chunks into a single range request
+		auto last = i;
+		uint64_t rangeSize = chunks[i].Size;
+		while (last + 1 < chunks.size() 
+			&& !isLocal(chunks[last + 1])
+			&& rangeSize + chunks[last + 1].Size <= MaxRangeSize) {
+			last++;
+			rangeSize += chunks[last].Size;
+		}
+
+		if (!FetchRange(version.URL, chunks, i, last, out, digest)) {
+			out.close();
+			DeleteFileW(path.c_str());
+			return false;
+		}
+
+		i = last + 1;
+	}
+
+	out.close();
+	if (!out.good()) {
+		DEBUG("Unable to write package temp file: %s", ToStdUTF8(path).c_str());
+		DeleteFileW(path.c_str());
+		return false;
+	}
+
+	auto packageDigest = digest.Finalize();
+	if (packageDigest != version.Digest) {
+		DEBUG("Reconstructed package digest mismatch; expected %s, got %s", version.Digest.c_str(), packageDigest.c_str());
+		DeleteFileW(path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool DeltaPackageFetcher::FetchRange(std::string const& url, std::vector<PackageChunk> const& chunks, size_t first, size_t last,
+	std::ofstream& out, SHA256Stream& digest)
+{
+	auto begin = chunks[first].Offset;
+	auto end = chunks[last].Offset + chunks[last].Size;
+	DEBUG("Fetching package range %lld-%lld", begin, end - 1);
+
+	std::vector<uint8_t> response;
+	response.reserve(end - begin);
+	// Servers that don't support range requests reply with the whole package; stop as soon as that happens
+	bool overflow{ false };
+	HttpFetcher::DataCallback onData = [&](uint8_t const* data, size_t size) {
+		if (response.size() + size > end - begin) {
+			overflow = true;
+			return false;
+		}
+
+		response.insert(response.end(), data, data + size);
 		return true;
-	} else {
-		reason.Category = ErrorCategory::LocalUpdate;
+	};
+
+	if (!fetcher_.Fetch(url, onData, std::make_pair(begin, end - 1))) {
+		if (overflow) {
+			DEBUG("Server returned more data than requested; range requests not supported?");
+		} else {
+			DEBUG("Unable to fetch package range: %s", fetcher_.GetLastError().c_str());
+		}
+		return false;
+	}
+
+	if (response.size() != end - begin) {
+		DEBUG("Package range size mismatch; expected %lld bytes, got %lld", end - begin, (uint64_t)response.size());
 		return false;
 	}
+
+	for (auto i = first; i <= last; i++) {
+		auto data = response.data() + (chunks[i].Offset - begin);
+		SHA256Stream chunkDigest;
+		chunkDigest.Update(data, chunks[i].Size);
+		if (chunkDigest.Finalize() != chunks[i].Digest) {
+			DEBUG("Chunk digest mismatch at offset %lld", chunks[i].Offset);
+			return false;
+		}
+	}
+
+	out.write(reinterpret_cast<char const*>(response.data()), response.size());
+	digest.Update(response.data(), response.size());
+	return out.good();
 }
 
 void UpdaterConsole::Print(DebugMessageType type, char const* msg)
@@ -125,8 +348,7 @@ void UpdaterConsole::Print(DebugMessageType type, char const* msg)
 	Console::Print(type, msg);
 
 	if (gUpdater) {
-		gUpdater->GetLog() += msg;
-		gUpdater->GetLog() += "\r\n";
+		gUpdater->AppendLog(msg);
 	}
 }
 
@@ -137,6 +359,8 @@ void ScriptExtenderUpdater::SetGameVersion(int32_t major, int32_t minor, int32_t
 
 void ScriptExtenderUpdater::LoadCaches()
 {
+	// May be called through the exported API while the updater thread is running
+	std::lock_guard _(cacheInitMutex_);
 	if (cache_) return;
 
 	UpdatePaths();
@@ -220,6 +444,99 @@ bool ScriptExtenderUpdater::FetchUpdates()
 	return !showError;
 }
 
+bool ScriptExtenderUpdater::CanUpdateInBackground()
+{
+	if (!config_.BackgroundUpdates || config_.DisableUpdates) {
+		return false;
+	}
+
+	// We can only skip the blocking update if there is a usable cached version.
+	// Versions superseded by a mandatory update are removed from the cache, so they won't be found here.
+	LoadCaches();
+	return (bool)cache_->FindResourceDllPath("ScriptExtender", gameVersion_);
+}
+
+bool ScriptExtenderUpdater::RequiresBlockingUpdate()
+{
+	SetStatusText(L"Fetching manifest");
+	ManifestFetcher manifestFetcher(fetcher_, config_);
+	Manifest manifest;
+	ErrorReason reason;
+
+	auto timeout = fetcher_.TimeoutMs;
+	fetcher_.TimeoutMs = ManifestCheckTimeoutMs;
+	bool fetched = manifestFetcher.Fetch(manifest, reason);
+	fetcher_.TimeoutMs = timeout;
+
+	if (!fetched) {
+		if (reason.IsInternetIssue()) {
+			DEBUG("Manifest check failed (%s); launching cached version", reason.Message.c_str());
+			return false;
+		}
+
+		// Let the blocking update surface the error
+		DEBUG("Manifest check failed; reason category %d, message: %s", reason.Category, reason.Message.c_str());
+		return true;
+	}
+
+	// Removes revoked and superseded versions from the cache
+	cache_->UpdateFromManifest(manifest);
+	updateManifest_ = manifest;
+
+	auto resIt = manifest.Resources.find("ScriptExtender");
+	if (resIt != manifest.Resources.end()) {
+		auto version = resIt->second.FindResourceVersionWithOverrides(gameVersion_, config_);
+		if (version && version->Mandatory && !cache_->ResourceExists(resIt->first, *version)) {
+			DEBUG("Mandatory update available: Version %s, Digest %s", version->Version.ToString().c_str(), version->Digest.c_str());
+			return true;
+		}
+	}
+
+	if (!cache_->FindResourceDllPath("ScriptExtender", gameVersion_)) {
+		DEBUG("Cached version was revoked; update required");
+		return true;
+	}
+
+	return false;
+}
+
+void ScriptExtenderUpdater::RunCached()
+{
+	LoadCaches();
+	launchDllPath_ = cache_->FindResourcePath("ScriptExtender", gameVersion_);
+	auto ver = cache_->FindResourceVersion("ScriptExtender", gameVersion_);
+	if (ver) {
+		DEBUG("Launching cached version: Version %s, Digest %s", ver->Version.ToString().c_str(), ver->Digest.c_str());
+		cache_->SetVersionInUse(ver->Digest);
+		if (!ver->Notice.empty()) {
+			DEBUG("Notice in cached resource data: %s", ver->Notice.c_str());
+			errorMessage_ = ver->Notice;
+		}
+	}
+
+	updated_ = true;
+	LoadExtender();
+	completed_ = true;
+
+	if (!errorMessage_.empty()) {
+		gGameHelpers->ShowError(errorMessage_.c_str());
+	}
+}
+
+void ScriptExtenderUpdater::RunBackgroundUpdate()
+{
+	fetcher_.TimeoutMs = BackgroundFetchTimeoutMs;
+
+	ErrorReason reason;
+	// Reuse the manifest from the startup check if we have one
+	bool succeeded = updateManifest_ ? UpdateFromManifest(*updateManifest_, reason) : TryToUpdate(reason);
+	if (succeeded) {
+		DEBUG("Background update check completed; new versions will be used on next launch");
+	} else {
+		DEBUG("Background update failed; reason category %d, message: %s", reason.Category, reason.Message.c_str());
+	}
+}
+
 bool ScriptExtenderUpdater::LoadExtender()
 {
 	auto dllPath = cache_->FindResourceDllPath("ScriptExtender", gameVersion_);
@@ -276,6 +593,11 @@ bool ScriptExtenderUpdater::TryToUpdate(ErrorReason& reason)
 		return false;
 	}
 
+	return UpdateFromManifest(manifest, reason);
+}
+
+bool ScriptExtenderUpdater::UpdateFromManifest(Manifest const& manifest, ErrorReason& reason)
+{
 	cache_->UpdateFromManifest(manifest);
 
 	updateManifest_ = manifest;
@@ -481,14 +803,24 @@ HRESULT UpdaterUI::UICallback(HWND hwnd, UINT uNotification, WPARAM wParam, LPAR
 	return S_OK;
 }
 
+HANDLE gUpdaterThread{ NULL };
+
 DWORD WINAPI UpdaterThread(LPVOID param)
 {
 	gGameHelpers->SuspendClientThread();
 	gUpdater->InitConsole();
-	gUpdater->InitUI();
-	DEBUG("Launch loader");
-	gUpdater->Run();
-	gGameHelpers->ResumeClientThread();
+	if (gUpdater->CanUpdateInBackground() && !gUpdater->RequiresBlockingUpdate()) {
+		// Launch the cached version right away and stage updates for the next launch
+		DEBUG("Launch cached loader");
+		gUpdater->RunCached();
+		gGameHelpers->ResumeClientThread();
+		gUpdater->RunBackgroundUpdate();
+	} else {
+		gUpdater->InitUI();
+		DEBUG("Launch loader");
+		gUpdater->Run();
+		gGameHelpers->ResumeClientThread();
+	}
 	DEBUG("Extender launcher thread exiting");
 	return 0;
 }
@@ -504,7 +836,22 @@ void StartUpdaterThread()
 
 	gUpdater = std::make_unique<ScriptExtenderUpdater>();
 	gUpdater->Initialize(nullptr);
-	CreateThread(NULL, 0, &UpdaterThread, NULL, 0, NULL);
+	gUpdaterThread = CreateThread(NULL, 0, &UpdaterThread, NULL, 0, NULL);
+}
+
+void StopUpdaterThread()
+{
+	if (gUpdaterThread == NULL) return;
+
+	// The background update may still be running after the game was resumed; cancel it
+	// and wait for the thread to exit before the updater is destroyed
+	if (gUpdater) {
+		gUpdater->RequestCancelUpdate();
+	}
+
+	WaitForSingleObject(gUpdaterThread, INFINITE);
+	CloseHandle(gUpdaterThread);
+	gUpdaterThread = NULL;
 }
 
 
@@ -1,7 +1,10 @@
 #include "stdafx.h"
 #include "Cache.h"
 #include "HttpFetcher.h"
+#include "PackageChunker.h"
 #include <curl/curl.h>
+#include <fstream>
+#include <mutex>
 
 BEGIN_SE()
 
@@ -47,6 +50,36 @@ private:
 };
 
 
+// Reconstructs an update package from the chunks of locally cached packages,
+// and fetches only the missing chunks from the server using range requests.
+class DeltaPackageFetcher
+{
+public:
+	DeltaPackageFetcher(HttpFetcher& fetcher, ResourceCacheRepository& cache);
+	bool Fetch(Manifest::Resource const& resource, Manifest::ResourceVersion const& version, std::wstring const& path);
+
+private:
+	// Max. number of bytes we're allowed to request in a single range request
+	static constexpr uint64_t MaxRangeSize = 0x400000;
+
+	struct LocalChunk
+	{
+		uint32_t Package;
+		uint64_t Offset;
+		uint32_t Size;
+	};
+
+	HttpFetcher& fetcher_;
+	ResourceCacheRepository& cache_;
+	std::vector<std::vector<uint8_t>> packages_;
+	std::unordered_map<std::string, LocalChunk> localChunks_;
+
+	bool IndexLocalPackages(std::string const& name);
+	bool FetchRange(std::string const& url, std::vector<PackageChunk> const& chunks, size_t first, size_t last,
+		std::ofstream& out, SHA256Stream& digest);
+};
+
+
 class ResourceUpdater
 {
 public:
@@ -58,6 +91,8 @@ private:
 	UpdaterConfig const& config_;
 	ResourceCacheRepository& cache_;
 	HttpFetcher& fetcher_;
+
+	bool FetchPackage(Manifest::ResourceVersion const& version, std::wstring const& path, ErrorReason& reason);
 };
 
 class UpdaterConsole : public Console
@@ -105,11 +140,19 @@ public:
 		return errorMessage_;
 	}
 
-	std::string& GetLog()
+	std::string GetLog() const
 	{
+		std::lock_guard<std::mutex> _(logMutex_);
 		return log_;
 	}
 
+	void AppendLog(char const* msg)
+	{
+		std::lock_guard<std::mutex> _(logMutex_);
+		log_ += msg;
+		log_ += "\r\n";
+	}
+
 	ResourceCacheRepository* GetCache() const
 	{
 		return cache_.get();
@@ -127,11 +170,25 @@ public:
 
 	void Initialize(char const* exeDirOverride);
 	void Run();
+	// Checks whether the cached version can be launched without waiting for the update check
+	bool CanUpdateInBackground();
+	// Fetches the manifest with a short timeout and checks whether it requires a blocking update
+	// (i.e. a mandatory version is not cached yet, or the cached version was revoked)
+	bool RequiresBlockingUpdate();
+	// Launches the cached version without checking for updates
+	void RunCached();
+	// Fetches updates without blocking the game; updates are used on the next launch
+	void RunBackgroundUpdate();
 	void LoadCaches();
 	bool FetchUpdates();
 	bool LoadExtender();
 
 private:
+	// Max. duration of each request when updating in the background
+	static constexpr uint32_t BackgroundFetchTimeoutMs = 120000;
+	// Max. duration of the manifest check performed while the game is suspended
+	static constexpr uint32_t ManifestCheckTimeoutMs = 3000;
+
 	VersionNumber gameVersion_;
 	UpdaterConfig config_;
 	HttpFetcher fetcher_;
@@ -145,7 +202,10 @@ private:
 	bool completed_{ false };
 	bool cancellingUpdate_{ false };
 	std::string log_;
+	mutable std::mutex logMutex_;
+	std::mutex cacheInitMutex_;
 
+	bool UpdateFromManifest(Manifest const& manifest, ErrorReason& reason);
 	void UpdatePaths();
 	void UpdateExeDir(char const* exeDirOverride);
 	void LoadConfig();
@@ -153,6 +213,8 @@ private:
 };
 
 void StartUpdaterThread();
+// Cancels the background update (if any) and waits for the updater thread to exit
+void StopUpdaterThread();
 
 extern std::unique_ptr<ScriptExtenderUpdater> gUpdater;
 
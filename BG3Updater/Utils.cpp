@@ -250,6 +250,7 @@ void LoadConfigFile(std::wstring const& configPath, UpdaterConfig& config)
 	config.ValidateSignature = true;
 	config.IPv4Only = false;
 	config.DisableUpdates = false;
+	config.BackgroundUpdates = true;
 
 	std::ifstream f(configPath, std::ios::in);
 	if (!f.good()) {
@@ -279,6 +280,7 @@ void LoadConfigFile(std::wstring const& configPath, UpdaterConfig& config)
 #endif
 	ConfigGetBool(root, "IPv4Only", config.IPv4Only);
 	ConfigGetBool(root, "DisableUpdates", config.DisableUpdates);
+	ConfigGetBool(root, "BackgroundUpdates", config.BackgroundUpdates);
 }
 
 std::string trim(std::string const & s)